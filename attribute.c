@@ -11,9 +11,11 @@
 
 #include <stdlib.h>        /* malloc(), realloc(), free() */
 #include <stdio.h>         /* FILE, fgetc() */
-#include <string.h>        /* strlen(), strcpy() */
+#include <string.h>        /* strlen(), strcpy(), strncmp(), memcpy(), memchr() */
 
 #include "../log.h"     /* logError(), logMem() */
+#include "error.h"      /* logXMLError() */
+#include "name.h"       /* internXMLName(), findXMLName() */
 #include "attribute.h"
 
 
@@ -129,6 +131,9 @@ void initXMLAttribute(XML_Attribute* attr)
    }
    else {
       attr->name = NULL;
+      attr->id = XML_NO_NAME;
+      attr->ns = XML_NO_NAME;
+      attr->local = XML_NO_NAME;
       attr->value = NULL;
       attr->next = NULL;
    }
@@ -198,6 +203,7 @@ void setXMLAttributeName(const char* name, XML_Attribute* attr)
       else {
          printf("   >>> realloc attribute.c:199 <<<\n");
          strcpy(attr->name, name);
+         attr->id = internXMLName(name, strlen(name));
       }
    }
    /* attribute doesn't have a name */
@@ -208,6 +214,7 @@ void setXMLAttributeName(const char* name, XML_Attribute* attr)
       else {
          logMem(LOG_ALLOC, attr->name, "string", "attribute name", __FILE__ , __LINE__ );
          strcpy(attr->name, name);
+         attr->id = internXMLName(name, strlen(name));
       }
    }
 }
@@ -254,55 +261,70 @@ void setXMLAttributeValue(const char* value, XML_Attribute* attr)
 }
 
 
+/**
+ * \brief Check if a character separates attributes.
+ */
+static int isXMLAttributeSpace(int c)
+{
+   return (c == (int)' ') || (c == (int)'\t') || (c == (int)'\n') || (c == (int)'\r');
+}
+
+
 /**
  * \brief Read a tag attribute in a XML file.
+ * Follows readXMLRawAttribute()'s grammar: name="value" or name='value',
+ * around spaces.
  *
  * \param file  Read XML file.
- * \return      Read tag's attribute.
- *
- * \todo Secure this function from buffer overflow with strBuffer.
- * \todo Secure this function from reading even when EOF is reached.
+ * \return      Read tag's attribute, NULL if an error happened.
  */
 XML_Attribute* readXMLAttribute(FILE* file)
 {
    XML_Attribute* attr;
    char strBuffer[XML_BUFFER_LENGTH];
-   int charBuffer, i;
-
-   attr = createXMLAttribute();
-
-   /* read attribute's name */
-   i = 0;
-   charBuffer = fgetc(file);
-   while(charBuffer != (int)'=') {
+   int charBuffer, quote, i;
 
+   /* read attribute's name, up to spaces or '=' */
+   while(isXMLAttributeSpace(charBuffer = fgetc(file)));
+   for(i = 0; (charBuffer != EOF) && (charBuffer != (int)'=') &&
+              !isXMLAttributeSpace(charBuffer) && (i < XML_BUFFER_LENGTH - 1); i++) {
       strBuffer[i] = (char)charBuffer;
-      i++;
       charBuffer = fgetc(file);
    }
    strBuffer[i] = '\0';
+   while(isXMLAttributeSpace(charBuffer)) {
+      charBuffer = fgetc(file);
+   }
 
-   /* check implied following character '"' */
-   if(fgetc(file) != (int)'"') {
-      logError("Badly parsed XML file.",  __FILE__ ,  __LINE__ );
-      freeXMLAttribute(attr);
+   /* check implied '=' and opening quote */
+   if((i == 0) || (charBuffer != (int)'=')) {
+      logXMLError("Badly parsed XML file.", file);
+      return NULL;
+   }
+   while(isXMLAttributeSpace(quote = fgetc(file)));
+   if((quote != (int)'"') && (quote != (int)'\'')) {
+      logXMLError("Badly parsed XML file.", file);
       return NULL;
    }
 
-   /* set attribute's name with read string */
+   attr = createXMLAttribute();
    setXMLAttributeName(strBuffer, attr);
 
-   /* read attribute's value */
+   /* read attribute's value, up to the same quote */
    i = 0;
    charBuffer = fgetc(file);
-   while(charBuffer != (int)'"') {
+   while((charBuffer != quote) && (charBuffer != EOF) && (i < XML_BUFFER_LENGTH - 1)) {
       strBuffer[i] = (char)charBuffer;
       i++;
       charBuffer = fgetc(file);
    }
    strBuffer[i] = '\0';
+   if(charBuffer != quote) {
+      logXMLError("Badly parsed XML file.", file);
+      freeXMLAttribute(attr);
+      return NULL;
+   }
 
-   /* set attribute's value with read string */
    setXMLAttributeValue(strBuffer, attr);
 
    return attr;
@@ -313,4 +335,179 @@ void copyXMLAttribute(XML_Attribute* dst, XML_Attribute* src)
 {
    setXMLAttributeName(src->name, dst);
    setXMLAttributeValue(src->value, dst);
+   dst->ns = src->ns;
+   dst->local = src->local;
+}
+
+
+/**
+ * \brief Create an attribute filter.
+ *
+ * \param[in] names  Attributes decoded while parsing.
+ * \param     count  Number of names.
+ * \param     lazy   1 to keep other attributes undecoded, 0 to drop them.
+ * \return           Created filter, NULL if an error happened.
+ */
+XML_AttributeFilter* createXMLAttributeFilter(const char** names, int count, int lazy)
+{
+   XML_AttributeFilter* filter;
+   int i;
+
+   if((names == NULL) && (count > 0)) {
+      logError("Trying to create an attribute filter from NULL names",  __FILE__ ,  __LINE__ );
+      return NULL;
+   }
+   if((filter = calloc(1, sizeof(XML_AttributeFilter))) == NULL) {
+      logError("Can't allocate memory for XML_AttributeFilter",  __FILE__ ,  __LINE__ );
+      return NULL;
+   }
+   logMem(LOG_ALLOC, filter, "XML_AttributeFilter", "attribute filter",  __FILE__ ,  __LINE__ );
+   filter->lazy = lazy;
+
+   if((count > 0) && ((filter->ids = malloc(count * sizeof(int))) == NULL)) {
+      logError("Can't allocate memory for filtered attributes",  __FILE__ ,  __LINE__ );
+      destroyXMLAttributeFilter(filter);
+      return NULL;
+   }
+   for(i = 0; i < count; i++) {
+      if((filter->ids[i] = internXMLName(names[i], strlen(names[i]))) == XML_NO_NAME) {
+         destroyXMLAttributeFilter(filter);
+         return NULL;
+      }
+      filter->count++;
+   }
+
+   return filter;
+}
+
+
+/**
+ * \brief Destroy an attribute filter.
+ *
+ * \param filter  Destroyed filter.
+ */
+void destroyXMLAttributeFilter(XML_AttributeFilter* filter)
+{
+   if(filter == NULL) {
+      logError("Trying to destroy a NULL XML_AttributeFilter",  __FILE__ ,  __LINE__ );
+   }
+   else {
+      free(filter->ids);
+      logMem(LOG_FREE, filter, "XML_AttributeFilter", "attribute filter",  __FILE__ ,  __LINE__ );
+      free(filter);
+   }
+}
+
+
+/**
+ * \brief Check if an attribute is decoded while parsing.
+ * Namespace declarations always are, since parsing resolves names with them.
+ *
+ * \param     filter  Used filter.
+ * \param[in] name    Attribute's name, not ended by '\\0'.
+ * \param     length  Name's length.
+ * \return            1 if attribute is decoded, 0 otherwise.
+ */
+int isXMLAttributeDecoded(XML_AttributeFilter* filter, const char* name, size_t length)
+{
+   int i, id;
+
+   if(((length == 5) || ((length > 5) && (name[5] == ':'))) &&
+      (strncmp(name, "xmlns", 5) == 0)) {
+      return 1;
+   }
+   if((id = findXMLName(name, length)) == XML_NO_NAME) {
+      return 0;
+   }
+   for(i = 0; i < filter->count; i++) {
+      if(filter->ids[i] == id) {
+         return 1;
+      }
+   }
+
+   return 0;
+}
+
+
+/**
+ * \brief Read an attribute in a tag's undecoded bytes.
+ * Bytes are read as name="value" or name='value', around spaces.
+ *
+ * \param[in]  p            Position in bytes, ended by '\\0'.
+ * \param[out] name         Attribute's name.
+ * \param[out] nameLength   Name's length.
+ * \param[out] value        Attribute's value, without quotes.
+ * \param[out] valueLength  Value's length.
+ * \return                  Position following attribute, NULL if no other
+ *                          attribute can be read.
+ */
+const char* readXMLRawAttribute(const char* p, const char** name, size_t* nameLength,
+                                const char** value, size_t* valueLength)
+{
+   char quote;
+
+   while((*p == ' ') || (*p == '\t') || (*p == '\n') || (*p == '\r')) {
+      p++;
+   }
+   for(*name = p; (*p != '\0') && (*p != '=') && (*p != ' ') && (*p != '\t') &&
+                  (*p != '\n') && (*p != '\r'); p++);
+   *nameLength = p - *name;
+   while((*p == ' ') || (*p == '\t') || (*p == '\n') || (*p == '\r')) {
+      p++;
+   }
+   if((*nameLength == 0) || (*p != '=')) {
+      return NULL;
+   }
+   for(p++; (*p == ' ') || (*p == '\t') || (*p == '\n') || (*p == '\r'); p++);
+   if((*p != '"') && (*p != '\'')) {
+      return NULL;
+   }
+   quote = *p;
+   for(*value = ++p; (*p != '\0') && (*p != quote); p++);
+   if(*p != quote) {
+      return NULL;
+   }
+   *valueLength = p - *value;
+
+   return p + 1;
+}
+
+
+/**
+ * \brief Create an attribute from undecoded bytes.
+ * An unprefixed name is resolved as parsing does, as it has no namespace. A
+ * prefixed one isn't, as its bindings aren't known anymore.
+ *
+ * \return  Created attribute, NULL if an error happened.
+ */
+XML_Attribute* createXMLRawAttribute(const char* name, size_t nameLength,
+                                     const char* value, size_t valueLength)
+{
+   XML_Attribute* attr;
+
+   if((attr = createXMLAttribute()) == NULL) {
+      return NULL;
+   }
+   attr->name = malloc(nameLength + 1);
+   attr->value = malloc(valueLength + 1);
+   if((attr->name == NULL) || (attr->value == NULL)) {
+      logError("Can't allocate memory for attribute's name and value",  __FILE__ ,  __LINE__ );
+      free(attr->name);
+      free(attr->value);
+      attr->name = attr->value = NULL;
+      freeXMLAttribute(attr);
+      return NULL;
+   }
+   logMem(LOG_ALLOC, attr->name, "string", "attribute name",  __FILE__ ,  __LINE__ );
+   logMem(LOG_ALLOC, attr->value, "string", "attribute value",  __FILE__ ,  __LINE__ );
+   memcpy(attr->name, name, nameLength);
+   attr->name[nameLength] = '\0';
+   memcpy(attr->value, value, valueLength);
+   attr->value[valueLength] = '\0';
+   attr->id = internXMLName(attr->name, nameLength);
+   if(memchr(name, ':', nameLength) == NULL) {
+      attr->local = attr->id;
+   }
+
+   return attr;
 }
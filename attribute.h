@@ -14,6 +14,9 @@
 
 
 #include <stdio.h>   /* FILE */
+#include <stddef.h>  /* size_t */
+
+#include "name.h"    /* XML_NO_NAME */
 
 
 #ifndef XML_BUFFER_LENGTH
@@ -28,12 +31,27 @@
 typedef struct XML_Attribute
 {
    char* name;    /**< attribute's name. */
+   int id;        /**< attribute's name identifier. */
+   int ns;        /**< attribute's namespace URI identifier. */
+   int local;     /**< attribute's local name identifier. */
    char* value;   /**< attribute's value. */
    struct XML_Attribute* next;   /**< Next attribute. */
 
 } XML_Attribute;
 
 
+/**
+ * \brief Attributes decoded while parsing.
+ * Other attributes, except namespace declarations, are dropped, or kept
+ * undecoded in their node when lazy, until they are looked up.
+ */
+typedef struct XML_AttributeFilter {
+   int* ids;      /**< Decoded attributes' name identifiers. */
+   int count;     /**< Number of decoded attributes. */
+   int lazy;      /**< 1 to keep other attributes' bytes in their node. */
+} XML_AttributeFilter;
+
+
 XML_Attribute* createXMLAttribute(void);
 void destroyXMLAttribute(XML_Attribute* attr);
 
@@ -50,5 +68,13 @@ XML_Attribute* readXMLAttribute(FILE* file);
 
 void copyXMLAttribute(XML_Attribute* dst, XML_Attribute* src);
 
+XML_AttributeFilter* createXMLAttributeFilter(const char** names, int count, int lazy);
+void destroyXMLAttributeFilter(XML_AttributeFilter* filter);
+int isXMLAttributeDecoded(XML_AttributeFilter* filter, const char* name, size_t length);
+const char* readXMLRawAttribute(const char* p, const char** name, size_t* nameLength,
+                                const char** value, size_t* valueLength);
+XML_Attribute* createXMLRawAttribute(const char* name, size_t nameLength,
+                                     const char* value, size_t valueLength);
+
 
 #endif /* ATTRIBUTE_H_INCLUDED */
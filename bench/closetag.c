@@ -0,0 +1,113 @@
+/**
+ * \file closetag.c
+ * \brief Closing tags' check benchmark
+ *
+ * Times loadXMLFile() on a generated file of nested records. Built twice with
+ * the library's sources, once as is and once with -DXML_CHECK_CLOSING_TAGS=0,
+ * the difference between both runs is the cost of checking closing tags:
+ *
+ *    cc -O2 -o closetag bench/closetag.c *.c -lpthread
+ *    cc -O2 -DXML_CHECK_CLOSING_TAGS=0 -o closetag0 bench/closetag.c *.c -lpthread
+ *
+ * Takes the number of records and of runs as optional arguments, prints the
+ * best run's time.
+ *
+ * \author François-Xavier Balu \<fx.balu@gmail.com\>
+ * \date 17 octobre 2026
+ */
+
+
+/* clock_gettime() and CLOCK_MONOTONIC are POSIX, not C99 */
+#define _POSIX_C_SOURCE  200809L
+
+#include <stdio.h>      /* printf(), fopen(), fprintf(), fclose(), remove() */
+#include <stdlib.h>     /* atoi() */
+#include <time.h>       /* clock_gettime() */
+
+#include "../xml.h"     /* XML_File, loadXMLFile(), destroyXMLFile() */
+
+
+/** \brief Generated file's name. */
+#define XML_BENCH_FILE  "closetag_bench.xml"
+
+
+/**
+ * \brief Write a file of records, each holding a few nested elements.
+ *
+ * \return  1 on success, 0 if the file can't be written.
+ */
+static int writeXMLBenchFile(int records)
+{
+   FILE* file;
+   int i;
+
+   if((file = fopen(XML_BENCH_FILE, "w")) == NULL) {
+      return 0;
+   }
+   fprintf(file, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<catalog>\n");
+   for(i = 0; i < records; i++) {
+      fprintf(file, "<record id=\"%d\">\n"
+                    "   <identification><name>item %d</name>"
+                    "<reference>REF-%08d</reference></identification>\n"
+                    "   <pricing><amount>%d.%02d</amount>"
+                    "<currency>EUR</currency></pricing>\n"
+                    "   <description>Generated record number %d</description>\n"
+                    "</record>\n",
+              i, i, i, i % 1000, i % 100, i);
+   }
+   fprintf(file, "</catalog>\n");
+   fclose(file);
+
+   return 1;
+}
+
+
+/**
+ * \brief Seconds elapsed since start.
+ */
+static double elapsedXMLBench(struct timespec* start)
+{
+   struct timespec end;
+
+   clock_gettime(CLOCK_MONOTONIC, &end);
+
+   return (double)(end.tv_sec - start->tv_sec) +
+          (double)(end.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+
+int main(int argc, char* argv[])
+{
+   struct timespec start;
+   XML_File* xml;
+   double best, seconds;
+   int records, runs, i;
+
+   records = (argc > 1) ? atoi(argv[1]) : 200000;
+   runs = (argc > 2) ? atoi(argv[2]) : 5;
+   if((records <= 0) || (runs <= 0) || !writeXMLBenchFile(records)) {
+      printf("Can't write %s\n", XML_BENCH_FILE);
+      return 1;
+   }
+
+   best = -1.0;
+   for(i = 0; i < runs; i++) {
+      clock_gettime(CLOCK_MONOTONIC, &start);
+      if((xml = loadXMLFile(XML_BENCH_FILE)) == NULL) {
+         printf("Can't load %s\n", XML_BENCH_FILE);
+         remove(XML_BENCH_FILE);
+         return 1;
+      }
+      seconds = elapsedXMLBench(&start);
+      destroyXMLFile(xml);
+      if((best < 0.0) || (seconds < best)) {
+         best = seconds;
+      }
+   }
+   remove(XML_BENCH_FILE);
+
+   printf("closing tags check %s: %d records, best of %d runs %.3f s\n",
+          XML_CHECK_CLOSING_TAGS ? "on" : "off", records, runs, best);
+
+   return 0;
+}
@@ -0,0 +1,837 @@
+/**
+ * \file disk.c
+ * \brief Disk-backed XML trees related functions
+ *
+ * Functions to load and read a XML_Disk.
+ *
+ * File is parsed with the same tag and value readers as parseXMLFile(), but
+ * each element is appended to the temporary file as soon as its start tag is
+ * read, so only the open elements' records are known in memory. Records and
+ * values are copied through the page cache, a copy spanning pages mapping
+ * them one at a time, so a single page is enough for any access.
+ *
+ * \author François-Xavier Balu \<fx.balu@gmail.com\>
+ * \date 17 octobre 2026
+ */
+
+
+/* mmap(), mkstemp() and ftruncate() are POSIX, not C99 */
+#define _POSIX_C_SOURCE  200809L
+
+#include <stddef.h>     /* offsetof() */
+#include <stdio.h>      /* FILE, fopen(), fclose(), fgets(), snprintf() */
+#include <stdlib.h>     /* malloc(), calloc(), realloc(), free(), getenv(), mkstemp() */
+#include <string.h>     /* strlen(), strcmp(), strcspn(), memcpy() */
+#include <unistd.h>     /* close(), unlink(), ftruncate() */
+#include <sys/mman.h>   /* mmap(), munmap() */
+
+#include "../log.h"     /* logError(), logMem() */
+#include "name.h"       /* findXMLName() */
+#include "node.h"       /* initXMLNodeFromXMLTag(), readXMLNodeValue() */
+#include "xml.h"        /* XML_BUFFER_LENGTH */
+#include "disk.h"
+
+
+/**
+ * \brief Unlink a slot from the cache's recency list.
+ */
+static void unlinkXMLDiskSlot(XML_Disk* d, int slot)
+{
+   XML_DiskPage* page;
+
+   page = &d->pages[slot];
+   if(page->previous >= 0) {
+      d->pages[page->previous].next = page->next;
+   }
+   else {
+      d->head = page->next;
+   }
+   if(page->next >= 0) {
+      d->pages[page->next].previous = page->previous;
+   }
+   else {
+      d->tail = page->previous;
+   }
+}
+
+
+/**
+ * \brief Link a slot as the most recently used one.
+ */
+static void linkXMLDiskSlot(XML_Disk* d, int slot)
+{
+   d->pages[slot].previous = -1;
+   d->pages[slot].next = d->head;
+   if(d->head >= 0) {
+      d->pages[d->head].previous = slot;
+   }
+   d->head = slot;
+   if(d->tail < 0) {
+      d->tail = slot;
+   }
+}
+
+
+/**
+ * \brief Get a mapped page of the temporary file, mapping it if needed.
+ * Least recently used page is unmapped when every slot is used.
+ *
+ * \return  Mapped page, NULL if an error happened.
+ */
+static char* getXMLDiskPage(XML_Disk* d, long page)
+{
+   char* data;
+   int slot;
+
+   if((slot = d->slots[page]) >= 0) {
+      if(d->head != slot) {
+         unlinkXMLDiskSlot(d, slot);
+         linkXMLDiskSlot(d, slot);
+      }
+      return d->pages[slot].data;
+   }
+
+   data = mmap(NULL, XML_DISK_PAGE_LENGTH, PROT_READ | PROT_WRITE, MAP_SHARED,
+               d->fd, (off_t)page * XML_DISK_PAGE_LENGTH);
+   if(data == MAP_FAILED) {
+      logError("Can't map a page of disk tree", __FILE__, __LINE__);
+      return NULL;
+   }
+   if(d->used < d->capacity) {
+      slot = d->used;
+      d->used++;
+   }
+   else {
+      slot = d->tail;
+      unlinkXMLDiskSlot(d, slot);
+      munmap(d->pages[slot].data, XML_DISK_PAGE_LENGTH);
+      d->slots[d->pages[slot].page] = -1;
+   }
+   d->pages[slot].data = data;
+   d->pages[slot].page = page;
+   d->slots[page] = slot;
+   linkXMLDiskSlot(d, slot);
+   d->faults++;
+
+   return data;
+}
+
+
+/**
+ * \brief Copy bytes of the temporary file to memory, or the other way.
+ *
+ * \param offset  Offset of the bytes in the file.
+ * \param data    Copied bytes' buffer.
+ * \param length  Number of copied bytes.
+ * \param write   1 to copy data to the file, 0 to copy file to data.
+ * \return        1 on success, 0 if an error happened.
+ */
+static int copyXMLDisk(XML_Disk* d, long long offset, void* data, size_t length,
+                       int write)
+{
+   char *page, *p;
+   size_t chunk, start;
+
+   for(p = data; length > 0; p += chunk, offset += chunk, length -= chunk) {
+      if((page = getXMLDiskPage(d, offset / XML_DISK_PAGE_LENGTH)) == NULL) {
+         return 0;
+      }
+      start = offset % XML_DISK_PAGE_LENGTH;
+      chunk = XML_DISK_PAGE_LENGTH - start;
+      if(chunk > length) {
+         chunk = length;
+      }
+      if(write) {
+         memcpy(page + start, p, chunk);
+      }
+      else {
+         memcpy(p, page + start, chunk);
+      }
+   }
+
+   return 1;
+}
+
+
+/**
+ * \brief Append bytes to the temporary file, growing it if needed.
+ * Appended bytes start on a multiple of 8.
+ *
+ * \return  Offset of appended bytes, -1 if an error happened.
+ */
+static long long appendXMLDisk(XML_Disk* d, const void* data, size_t length)
+{
+   long long offset, fileLength;
+   long pages, i;
+   int* slots;
+
+   offset = (d->size + 7) & ~7LL;
+   if(offset + (long long)length > d->fileLength) {
+      fileLength = (d->fileLength > 0) ? 2 * d->fileLength : XML_DISK_PAGE_LENGTH;
+      while(offset + (long long)length > fileLength) {
+         fileLength *= 2;
+      }
+      pages = fileLength / XML_DISK_PAGE_LENGTH;
+      if(ftruncate(d->fd, fileLength) < 0) {
+         logError("Can't grow disk tree's temporary file", __FILE__, __LINE__);
+         return -1;
+      }
+      if((slots = realloc(d->slots, pages * sizeof(int))) == NULL) {
+         logError("Can't reallocate memory for disk tree's pages", __FILE__, __LINE__);
+         return -1;
+      }
+      for(i = d->slotsLength; i < pages; i++) {
+         slots[i] = -1;
+      }
+      d->slots = slots;
+      d->slotsLength = pages;
+      d->fileLength = fileLength;
+   }
+
+   if(!copyXMLDisk(d, offset, (void*)data, length, 1)) {
+      return -1;
+   }
+   d->size = offset + length;
+
+   return offset;
+}
+
+
+/**
+ * \brief Read a node's record, checking node is in the file.
+ *
+ * \return  1 on success, 0 if node doesn't exist or an error happened.
+ */
+static int readXMLDiskNode(XML_Disk* d, long n, XML_DiskNode* node)
+{
+   if((d == NULL) || (n < 0) || (n + (long long)sizeof(XML_DiskNode) > d->size)) {
+      return 0;
+   }
+
+   return copyXMLDisk(d, n, node, sizeof(XML_DiskNode), 0);
+}
+
+
+/**
+ * \brief Write back a node's record.
+ */
+static int writeXMLDiskNode(XML_Disk* d, long long n, XML_DiskNode* node)
+{
+   return copyXMLDisk(d, n, node, sizeof(XML_DiskNode), 1);
+}
+
+
+/**
+ * \brief Append an element read from a start tag, as last child of parent.
+ * Element's attributes follow its record.
+ *
+ * \param parent  Parent's record, -1 for the root.
+ * \return        Element's record, -1 if an error happened.
+ */
+static long long appendXMLDiskElement(XML_Disk* d, XML_Tag* tag, long long parent)
+{
+   XML_DiskNode node, other;
+   XML_DiskAttribute record;
+   XML_Attribute* attr;
+   XML_Node* read;
+   long long offset, previous, a;
+
+   /* reads name and attributes as the parser does */
+   if((read = createXMLNode()) == NULL) {
+      return -1;
+   }
+   initXMLNodeFromXMLTag(read, tag);
+
+   node.parent = parent;
+   node.next = node.first = node.last = -1;
+   node.value = -1;
+   node.valueLength = 0;
+   node.attr = -1;
+   node.id = read->id;
+   node.cc = 0;
+   if((offset = appendXMLDisk(d, &node, sizeof(node))) < 0) {
+      destroyXMLNode(read);
+      return -1;
+   }
+
+   /* attributes' values, then records, linked in order */
+   previous = -1;
+   for(attr = read->attr; attr != NULL; attr = attr->next) {
+      record.next = -1;
+      record.valueLength = (attr->value != NULL) ? strlen(attr->value) : 0;
+      record.value = appendXMLDisk(d, attr->value, record.valueLength);
+      record.id = attr->id;
+      record.unused = 0;
+      if((record.value < 0) ||
+         ((a = appendXMLDisk(d, &record, sizeof(record))) < 0)) {
+         destroyXMLNode(read);
+         return -1;
+      }
+      if(previous < 0) {
+         node.attr = a;
+      }
+      else if(!copyXMLDisk(d, previous + offsetof(XML_DiskAttribute, next),
+                           &a, sizeof(a), 1)) {
+         destroyXMLNode(read);
+         return -1;
+      }
+      previous = a;
+   }
+   destroyXMLNode(read);
+   if((node.attr >= 0) && !writeXMLDiskNode(d, offset, &node)) {
+      return -1;
+   }
+
+   /* links element to its parent and previous sibling */
+   if(parent >= 0) {
+      if(!readXMLDiskNode(d, parent, &other)) {
+         return -1;
+      }
+      if(other.last >= 0) {
+         if(!copyXMLDisk(d, other.last + offsetof(XML_DiskNode, next),
+                         &offset, sizeof(offset), 1)) {
+            return -1;
+         }
+      }
+      else {
+         other.first = offset;
+      }
+      other.last = offset;
+      other.cc++;
+      if(!writeXMLDiskNode(d, parent, &other)) {
+         return -1;
+      }
+   }
+
+   return offset;
+}
+
+
+/**
+ * \brief Read a value following a tag, and make it an element's value.
+ * As with parseXMLElement(), a later value replaces an earlier one.
+ *
+ * \return  1 on success, 0 if an error happened.
+ */
+static int readXMLDiskValue(XML_Disk* d, long long n, FILE* file)
+{
+   XML_DiskNode node;
+   XML_Node* read;
+   int success;
+
+   if((read = createXMLNode()) == NULL) {
+      return 0;
+   }
+   readXMLNodeValue(read, file);
+
+   success = 1;
+   if(read->value != NULL) {
+      node.valueLength = strlen(read->value);
+      /* value's offset and length are written together */
+      success = ((node.value = appendXMLDisk(d, read->value, node.valueLength)) >= 0) &&
+                copyXMLDisk(d, n + offsetof(XML_DiskNode, value), &node.value,
+                            2 * sizeof(long long), 1);
+   }
+   destroyXMLNode(read);
+
+   return success;
+}
+
+
+/**
+ * \brief Parse a file's root element and its descendants into the temporary
+ * file.
+ *
+ * \return  1 on success, 0 if file isn't well formed or an error happened.
+ */
+static int parseXMLDisk(XML_Disk* d, FILE* file)
+{
+   XML_DiskNode node;
+   XML_Tag* tag;
+   long long *stack, *grown, offset;
+   int depth, stackLength, error;
+
+   if((tag = readXMLTag(file)) == NULL) {
+      logError("Nothing to parse", __FILE__, __LINE__);
+      return 0;
+   }
+   else if(tag->type == CLOSING) {
+      logError("First tag is a closing tag", __FILE__, __LINE__);
+      destroyXMLTag(tag);
+      return 0;
+   }
+
+   /* open elements' records */
+   stackLength = 16;
+   if((stack = malloc(stackLength * sizeof(long long))) == NULL) {
+      logError("Can't allocate memory for disk tree's stack", __FILE__, __LINE__);
+      destroyXMLTag(tag);
+      return 0;
+   }
+   depth = 0;
+   error = 0;
+
+   do {
+      /* tag opens a child of the open element, or the root */
+      if((tag->type == OPENING) || (tag->type == UNIQUE)) {
+         if((offset = appendXMLDiskElement(d, tag, (depth > 0) ? stack[depth - 1] : -1)) < 0) {
+            error = 1;
+         }
+         else if(tag->type == OPENING) {
+            if(depth == stackLength) {
+               stackLength *= 2;
+               if((grown = realloc(stack, stackLength * sizeof(long long))) == NULL) {
+                  logError("Can't reallocate memory for disk tree's stack",
+                           __FILE__, __LINE__);
+                  error = 1;
+               }
+               else {
+                  stack = grown;
+               }
+            }
+            if(!error) {
+               stack[depth] = offset;
+               depth++;
+            }
+         }
+      }
+      /* tag closes the open element, only if names match */
+      else if(tag->type == CLOSING) {
+         if(!readXMLDiskNode(d, stack[depth - 1], &node)) {
+            error = 1;
+         }
+         else if(findXMLName(tag->name, tag->nameLength) != node.id) {
+            logError("Closing tag doesn't match current node", __FILE__, __LINE__);
+            error = 1;
+         }
+         else {
+            depth--;
+         }
+      }
+      destroyXMLTag(tag);
+      tag = NULL;
+
+      /* reads open element's value, then next tag */
+      if(!error && (depth > 0)) {
+         if(!readXMLDiskValue(d, stack[depth - 1], file)) {
+            error = 1;
+         }
+         else if((tag = readXMLTag(file)) == NULL) {
+            logError("No tag remaining, and tree isn't finished", __FILE__, __LINE__);
+            error = 1;
+         }
+      }
+   } while(!error && (depth > 0));
+
+   if(tag != NULL) {
+      destroyXMLTag(tag);
+   }
+   free(stack);
+
+   return !error;
+}
+
+
+/**
+ * \brief Create the unlinked temporary file holding a disk tree.
+ * It is created in $TMPDIR, or /tmp.
+ *
+ * \return  File descriptor, -1 if an error happened.
+ */
+static int createXMLDiskFile(void)
+{
+   char path[XML_BUFFER_LENGTH];
+   const char* directory;
+   int fd;
+
+   if((directory = getenv("TMPDIR")) == NULL) {
+      directory = "/tmp";
+   }
+   if((size_t)snprintf(path, sizeof(path), "%s/xmlDiskXXXXXX", directory) >= sizeof(path)) {
+      logError("Temporary directory's path is too long", __FILE__, __LINE__);
+      return -1;
+   }
+   if((fd = mkstemp(path)) < 0) {
+      logError("Can't create disk tree's temporary file", __FILE__, __LINE__);
+      return -1;
+   }
+   unlink(path);
+
+   return fd;
+}
+
+
+/**
+ * \brief Load a XML file as a disk-backed tree.
+ * File is read once and can be modified or removed afterwards.
+ *
+ * \param[in] path      Path of the XML file.
+ * \param     capacity  Number of pages mapped at once, XML_DISK_CACHE_LENGTH
+ *                      if not positive.
+ * \return              Loaded tree, NULL if an error happened.
+ */
+XML_Disk* loadXMLDisk(const char* path, int capacity)
+{
+   char firstLine[XML_BUFFER_LENGTH];
+   XML_Disk* d;
+   FILE* file;
+   int success;
+
+   if(path == NULL) {
+      logError("Trying to load a disk tree from a NULL path", __FILE__, __LINE__);
+      return NULL;
+   }
+   if((d = calloc(1, sizeof(XML_Disk))) == NULL) {
+      logError("Can't allocate memory for XML_Disk", __FILE__, __LINE__);
+      return NULL;
+   }
+   logMem(LOG_ALLOC, d, "XML_Disk", "disk tree", __FILE__, __LINE__);
+   d->capacity = (capacity > 0) ? capacity : XML_DISK_CACHE_LENGTH;
+   d->head = d->tail = -1;
+   if((d->pages = calloc(d->capacity, sizeof(XML_DiskPage))) == NULL) {
+      logError("Can't allocate memory for disk tree's cache", __FILE__, __LINE__);
+      d->fd = -1;
+      destroyXMLDisk(d);
+      return NULL;
+   }
+   if((d->fd = createXMLDiskFile()) < 0) {
+      destroyXMLDisk(d);
+      return NULL;
+   }
+
+   if((file = fopen(path, "r")) == NULL) {
+      logError("Can't open XML file", __FILE__, __LINE__);
+      destroyXMLDisk(d);
+      return NULL;
+   }
+   /* skips XML declaration, as loadXMLFile() does */
+   success = (fgets(firstLine, XML_BUFFER_LENGTH, file) != NULL) && parseXMLDisk(d, file);
+   fclose(file);
+   if(!success) {
+      destroyXMLDisk(d);
+      return NULL;
+   }
+
+   return d;
+}
+
+
+/**
+ * \brief Destroy a disk tree, and its temporary file.
+ *
+ * \param d  Destroyed tree.
+ */
+void destroyXMLDisk(XML_Disk* d)
+{
+   int slot;
+
+   if(d == NULL) {
+      logError("Trying to destroy a NULL XML_Disk", __FILE__, __LINE__);
+   }
+   else {
+      for(slot = 0; slot < d->used; slot++) {
+         munmap(d->pages[slot].data, XML_DISK_PAGE_LENGTH);
+      }
+      if(d->fd >= 0) {
+         close(d->fd);
+      }
+      free(d->pages);
+      free(d->slots);
+      logMem(LOG_FREE, d, "XML_Disk", "disk tree", __FILE__, __LINE__);
+      free(d);
+   }
+}
+
+
+/**
+ * \brief Get a node's parent.
+ *
+ * \param n  Node.
+ * \param d  Node's tree.
+ * \return   Parent, -1 for the root.
+ */
+long getXMLDiskParent(long n, XML_Disk* d)
+{
+   XML_DiskNode node;
+
+   return readXMLDiskNode(d, n, &node) ? node.parent : -1;
+}
+
+
+/**
+ * \brief Get a node's first child.
+ *
+ * \param n  Node.
+ * \param d  Node's tree.
+ * \return   First child, -1 if node has no children.
+ */
+long getXMLDiskFirst(long n, XML_Disk* d)
+{
+   XML_DiskNode node;
+
+   return readXMLDiskNode(d, n, &node) ? node.first : -1;
+}
+
+
+/**
+ * \brief Get a node's next sibling.
+ *
+ * \param n  Node.
+ * \param d  Node's tree.
+ * \return   Next sibling, -1 if node is the last child.
+ */
+long getXMLDiskNext(long n, XML_Disk* d)
+{
+   XML_DiskNode node;
+
+   return readXMLDiskNode(d, n, &node) ? node.next : -1;
+}
+
+
+/**
+ * \brief Get a node's children count.
+ *
+ * \param n  Node.
+ * \param d  Node's tree.
+ * \return   Children count, -1 if node doesn't exist.
+ */
+int getXMLDiskChildCount(long n, XML_Disk* d)
+{
+   XML_DiskNode node;
+
+   return readXMLDiskNode(d, n, &node) ? node.cc : -1;
+}
+
+
+/**
+ * \brief Get a node's name identifier, for getXMLName().
+ *
+ * \param n  Node.
+ * \param d  Node's tree.
+ * \return   Name's identifier, XML_NO_NAME if node doesn't exist.
+ */
+int getXMLDiskNameId(long n, XML_Disk* d)
+{
+   XML_DiskNode node;
+
+   return readXMLDiskNode(d, n, &node) ? node.id : XML_NO_NAME;
+}
+
+
+/**
+ * \brief Copy a value of the temporary file into a string.
+ *
+ * \return  Allocated string, NULL if an error happened.
+ */
+static char* copyXMLDiskString(XML_Disk* d, long long offset, long long length)
+{
+   char* str;
+
+   if((str = malloc(length + 1)) == NULL) {
+      logError("Can't allocate memory for disk tree's value", __FILE__, __LINE__);
+      return NULL;
+   }
+   if(!copyXMLDisk(d, offset, str, length, 0)) {
+      free(str);
+      return NULL;
+   }
+   str[length] = '\0';
+
+   return str;
+}
+
+
+/**
+ * \brief Get a copy of a node's value.
+ *
+ * \param n  Node.
+ * \param d  Node's tree.
+ * \return   Value, to free with free(), NULL if node has none.
+ */
+char* getXMLDiskValue(long n, XML_Disk* d)
+{
+   XML_DiskNode node;
+
+   if(!readXMLDiskNode(d, n, &node) || (node.value < 0)) {
+      return NULL;
+   }
+
+   return copyXMLDiskString(d, node.value, node.valueLength);
+}
+
+
+/**
+ * \brief Get a copy of a node's attribute value.
+ *
+ * \param     n     Node.
+ * \param[in] name  Attribute's name.
+ * \param     d     Node's tree.
+ * \return          Value, to free with free(), NULL if node has no such
+ *                  attribute.
+ */
+char* getXMLDiskAttribute(long n, const char* name, XML_Disk* d)
+{
+   XML_DiskAttribute attr;
+   XML_DiskNode node;
+   long long a;
+   int id;
+
+   if((name == NULL) || !readXMLDiskNode(d, n, &node) ||
+      ((id = findXMLName(name, strlen(name))) == XML_NO_NAME)) {
+      return NULL;
+   }
+
+   for(a = node.attr; a >= 0; a = attr.next) {
+      if(!copyXMLDisk(d, a, &attr, sizeof(attr), 0)) {
+         return NULL;
+      }
+      if(attr.id == id) {
+         return copyXMLDiskString(d, attr.value, attr.valueLength);
+      }
+   }
+
+   return NULL;
+}
+
+
+/**
+ * \brief Find the first sibling with a name, and an attribute value.
+ *
+ * \param n      First sibling.
+ * \param id     Name's identifier.
+ * \param attr   Attribute's name, NULL not to check attributes.
+ * \param value  Attribute's value.
+ * \return       Found node, -1 if there is none.
+ */
+static long findXMLDiskSibling(long n, int id, const char* attr,
+                               const char* value, XML_Disk* d)
+{
+   XML_DiskNode node;
+   char* found;
+   int match;
+
+   for(; (n >= 0) && readXMLDiskNode(d, n, &node); n = node.next) {
+      if(node.id != id) {
+         continue;
+      }
+      if(attr == NULL) {
+         return n;
+      }
+      if((found = getXMLDiskAttribute(n, attr, d)) != NULL) {
+         match = (strcmp(found, value) == 0);
+         free(found);
+         if(match) {
+            return n;
+         }
+      }
+   }
+
+   return -1;
+}
+
+
+/**
+ * \brief Finds a particular node in a disk tree.
+ *
+ * \param[in] path  Node path in the tree, as for getXMLNode().
+ *                  eg. "foo/bar", "foo/bar?attr=value/lel"
+ * \param     d     Searched tree.
+ * \return          Found node, -1 if such a node wasn't found.
+ */
+long getXMLDiskNode(char* path, XML_Disk* d)
+{
+   char name[XML_BUFFER_LENGTH], attr[XML_BUFFER_LENGTH];
+   char value[XML_BUFFER_LENGTH];
+   size_t length;
+   long n;
+   int id;
+
+   if((path == NULL) || (d == NULL)) {
+      return -1;
+   }
+
+   for(n = 0; ; n = getXMLDiskFirst(n, d)) {
+      /* reads "name" or "name?attr=value" */
+      length = strcspn(path, "/?");
+      if(length >= sizeof(name)) {
+         return -1;
+      }
+      memcpy(name, path, length);
+      name[length] = '\0';
+      path += length;
+      attr[0] = '\0';
+      if(*path == '?') {
+         path++;
+         length = strcspn(path, "=");
+         if((path[length] != '=') || (length >= sizeof(attr))) {
+            logError("Attribute's name is not followed by a value.", __FILE__, __LINE__);
+            return -1;
+         }
+         memcpy(attr, path, length);
+         attr[length] = '\0';
+         path += length + 1;
+         length = strcspn(path, "/");
+         if(length >= sizeof(value)) {
+            return -1;
+         }
+         memcpy(value, path, length);
+         value[length] = '\0';
+         path += length;
+      }
+
+      if(((id = findXMLName(name, strlen(name))) == XML_NO_NAME) ||
+         ((n = findXMLDiskSibling(n, id, (attr[0] != '\0') ? attr : NULL,
+                                  value, d)) < 0)) {
+         return -1;
+      }
+      if(*path == '\0') {
+         return n;
+      }
+      path++;
+   }
+}
+
+
+/**
+ * \brief Finds a value or an attribute's value in a disk tree.
+ *
+ * \param[in] path  Value path in the tree, as for findXMLValue().
+ *                  eg. "foo/bar$", "foo/bar:attr"
+ * \param     d     Searched tree.
+ * \return          Copy of found value, to free with free(), NULL if it
+ *                  wasn't found.
+ */
+char* findXMLDiskValue(char* path, XML_Disk* d)
+{
+   char name[XML_BUFFER_LENGTH];
+   size_t nameLength;
+   long n;
+   int id;
+
+   if((path == NULL) || (d == NULL)) {
+      return NULL;
+   }
+
+   for(n = 0; ; n = getXMLDiskFirst(n, d)) {
+      nameLength = strcspn(path, "/:$");
+      if((path[nameLength] == '\0') || (nameLength >= sizeof(name))) {
+         logError("Reached end of path without ':' or '$'.", __FILE__, __LINE__);
+         return NULL;
+      }
+      memcpy(name, path, nameLength);
+      name[nameLength] = '\0';
+      if(((id = findXMLName(name, nameLength)) == XML_NO_NAME) ||
+         ((n = findXMLDiskSibling(n, id, NULL, NULL, d)) < 0)) {
+         return NULL;
+      }
+
+      path += nameLength;
+      if(*path == '$') {
+         return getXMLDiskValue(n, d);
+      }
+      if(*path == ':') {
+         return getXMLDiskAttribute(n, path + 1, d);
+      }
+      path++;
+   }
+}
@@ -0,0 +1,115 @@
+/**
+ * \file disk.h
+ * \brief Disk-backed XML trees related definitions
+ *
+ * Definition of a XML_Disk structure, a read-only XML tree kept in a temporary
+ * file instead of memory, for documents larger than it. Nodes and their
+ * contents are written in document order while parsing, and read back through
+ * a cache of a few mapped pages, the least recently used page being unmapped
+ * when another one is needed. Memory then depends on the cache's length and
+ * the tree's depth, not on the document's size.
+ *
+ * A node is the offset of its record in the temporary file, the root being 0.
+ * Values and attributes are returned as copies, since the page holding them
+ * may be unmapped by any following call. A XML_Disk must not be used by
+ * several threads at once.
+ *
+ * \author François-Xavier Balu \<fx.balu@gmail.com\>
+ * \date 17 octobre 2026
+ */
+
+
+#ifndef DISK_H_INCLUDED
+#define DISK_H_INCLUDED
+
+
+/**
+ * \brief Length of a cached page of the temporary file, in bytes.
+ * Must be a multiple of the system's page size.
+ */
+#ifndef XML_DISK_PAGE_LENGTH
+#define XML_DISK_PAGE_LENGTH  65536
+#endif /* XML_DISK_PAGE_LENGTH */
+
+/**
+ * \brief Default number of pages mapped at once.
+ */
+#ifndef XML_DISK_CACHE_LENGTH
+#define XML_DISK_CACHE_LENGTH  256
+#endif /* XML_DISK_CACHE_LENGTH */
+
+
+/**
+ * \brief Node's record in the temporary file.
+ */
+typedef struct XML_DiskNode {
+   long long parent;       /**< Parent's record, -1 for the root. */
+   long long next;         /**< Next sibling's record, -1 if none. */
+   long long first;        /**< First child's record, -1 if none. */
+   long long last;         /**< Last child's record, -1 if none. */
+   long long value;        /**< Value's offset, -1 if none. */
+   long long valueLength;  /**< Value's length. */
+   long long attr;         /**< First attribute's record, -1 if none. */
+   int id;                 /**< Name's identifier. */
+   int cc;                 /**< Children count. */
+} XML_DiskNode;
+
+
+/**
+ * \brief Attribute's record in the temporary file.
+ */
+typedef struct XML_DiskAttribute {
+   long long next;         /**< Next attribute's record, -1 if none. */
+   long long value;        /**< Value's offset. */
+   long long valueLength;  /**< Value's length. */
+   int id;                 /**< Name's identifier. */
+   int unused;             /**< Padding, 0. */
+} XML_DiskAttribute;
+
+
+/**
+ * \brief Mapped page of the temporary file.
+ */
+typedef struct XML_DiskPage {
+   char* data;       /**< Mapped page, NULL if slot is free. */
+   long page;        /**< Page's index in the file. */
+   int previous;     /**< More recently used slot, -1 if none. */
+   int next;         /**< Less recently used slot, -1 if none. */
+} XML_DiskPage;
+
+
+/**
+ * \brief Disk-backed read-only XML tree.
+ */
+typedef struct XML_Disk {
+   int fd;                 /**< Temporary file, already unlinked. */
+   long long size;         /**< Written bytes. */
+   long long fileLength;   /**< Temporary file's length. */
+   XML_DiskPage* pages;    /**< Cache's slots. */
+   int capacity;           /**< Number of slots. */
+   int used;               /**< Used slots. */
+   int head;               /**< Most recently used slot, -1 if none. */
+   int tail;               /**< Least recently used slot, -1 if none. */
+   int* slots;             /**< Slot of each page of the file, -1 if unmapped. */
+   long slotsLength;       /**< Pages in slots. */
+   long faults;            /**< Pages mapped since loading. */
+} XML_Disk;
+
+
+XML_Disk* loadXMLDisk(const char* path, int capacity);
+void destroyXMLDisk(XML_Disk* d);
+
+long getXMLDiskParent(long n, XML_Disk* d);
+long getXMLDiskFirst(long n, XML_Disk* d);
+long getXMLDiskNext(long n, XML_Disk* d);
+int getXMLDiskChildCount(long n, XML_Disk* d);
+
+int getXMLDiskNameId(long n, XML_Disk* d);
+char* getXMLDiskValue(long n, XML_Disk* d);
+char* getXMLDiskAttribute(long n, const char* name, XML_Disk* d);
+
+long getXMLDiskNode(char* path, XML_Disk* d);
+char* findXMLDiskValue(char* path, XML_Disk* d);
+
+
+#endif /* DISK_H_INCLUDED */
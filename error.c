@@ -0,0 +1,154 @@
+/**
+ * \file error.c
+ * \brief XML parsing errors related functions
+ *
+ * The last error is kept for each thread. Locating errors reads the file by
+ * blocks, newlines being found with memchr(), which compares many bytes at
+ * once where the C library vectorizes it.
+ *
+ * \author François-Xavier Balu \<fx.balu@gmail.com\>
+ * \date 17 octobre 2026
+ */
+
+
+#include <stdio.h>    /* ftell(), fseek(), fread() */
+#include <string.h>   /* memchr() */
+
+#include "../log.h"   /* logError() */
+#include "error.h"
+
+
+/**
+ * \brief Last parsing error of current thread.
+ */
+static _Thread_local XML_Error lastError = {NULL, -1, 0, 0};
+
+
+/**
+ * \brief Record a parsing error, found at file's current offset.
+ *
+ * \param message  Error's description, which must outlive the error.
+ * \param file     Read file.
+ */
+void setXMLError(const char* message, FILE* file)
+{
+   lastError.message = message;
+   lastError.offset = (file != NULL) ? ftell(file) : -1;
+   lastError.line = 0;
+   lastError.column = 0;
+}
+
+
+/**
+ * \brief Get current thread's last parsing error.
+ *
+ * \return  Last error, whose offset is -1 if there is none.
+ */
+const XML_Error* getXMLError(void)
+{
+   return &lastError;
+}
+
+
+/**
+ * \brief Forget current thread's last parsing error.
+ */
+void clearXMLError(void)
+{
+   lastError.message = NULL;
+   lastError.offset = -1;
+   lastError.line = 0;
+   lastError.column = 0;
+}
+
+
+/**
+ * \brief Count newlines in a buffer.
+ *
+ * \param[out] last  Character after the last newline, unchanged if none.
+ * \return           Number of newlines.
+ */
+static long countXMLNewlines(const char* p, const char* end, const char** last)
+{
+   const char* newline;
+   long count;
+
+   count = 0;
+   while((p < end) && ((newline = memchr(p, '\n', end - p)) != NULL)) {
+      count++;
+      p = newline + 1;
+      *last = p;
+   }
+
+   return count;
+}
+
+
+/**
+ * \brief Compute line and column of errors.
+ * File is read from its beginning up to the last error, and is left at the
+ * position it had.
+ *
+ * \param file    File where errors were found.
+ * \param errors  Located errors, in offsets' order.
+ * \param count   Number of errors.
+ * \return        1 on success, 0 if an error happened.
+ */
+int locateXMLErrors(FILE* file, XML_Error* errors, int count)
+{
+   char buffer[XML_ERROR_BUFFER_LENGTH];
+   const char *p, *stop, *last;
+   long position, offset, line, lineStart;
+   size_t length;
+   int i;
+
+   if((file == NULL) || ((errors == NULL) && (count > 0))) {
+      logError("Trying to locate errors in a NULL file", __FILE__, __LINE__);
+      return 0;
+   }
+   if(((position = ftell(file)) < 0) || (fseek(file, 0, SEEK_SET) != 0)) {
+      logError("Can't read file again to locate errors", __FILE__, __LINE__);
+      return 0;
+   }
+
+   offset = 0;
+   line = 1;
+   lineStart = 0;
+   i = 0;
+   while((i < count) && ((length = fread(buffer, 1, sizeof(buffer), file)) > 0)) {
+      p = buffer;
+      /* errors in this block */
+      for(; (i < count) && (errors[i].offset < offset + (long)length); i++) {
+         stop = buffer + ((errors[i].offset > offset) ? errors[i].offset - offset : 0);
+         if(stop > p) {
+            last = NULL;
+            line += countXMLNewlines(p, stop, &last);
+            if(last != NULL) {
+               lineStart = offset + (last - buffer);
+            }
+            p = stop;
+         }
+         errors[i].line = line;
+         errors[i].column = errors[i].offset - lineStart + 1;
+      }
+      /* rest of the block */
+      last = NULL;
+      line += countXMLNewlines(p, buffer + length, &last);
+      if(last != NULL) {
+         lineStart = offset + (last - buffer);
+      }
+      offset += length;
+   }
+   /* errors at end of file */
+   for(; i < count; i++) {
+      errors[i].line = line;
+      errors[i].column = errors[i].offset - lineStart + 1;
+   }
+
+   if(fseek(file, position, SEEK_SET) != 0) {
+      logError("Can't go back to file's position", __FILE__, __LINE__);
+      return 0;
+   }
+
+   return 1;
+}
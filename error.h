@@ -0,0 +1,57 @@
+/**
+ * \file error.h
+ * \brief XML parsing errors related definitions
+ *
+ * Definition of a XML_Error structure, telling where a parsing error was
+ * found in a XML file. Only the byte offset is recorded when the error
+ * happens, line and column being computed on demand by locateXMLErrors(), so
+ * reading characters doesn't have to count lines.
+ *
+ * \author François-Xavier Balu \<fx.balu@gmail.com\>
+ * \date 17 octobre 2026
+ */
+
+
+#ifndef ERROR_H_INCLUDED
+#define ERROR_H_INCLUDED
+
+
+#include <stdio.h>    /* FILE */
+
+
+/**
+ * \brief Bytes read at once while locating errors.
+ */
+#ifndef XML_ERROR_BUFFER_LENGTH
+#define XML_ERROR_BUFFER_LENGTH  16384
+#endif /* XML_ERROR_BUFFER_LENGTH */
+
+
+/**
+ * \brief Log a parsing error, and record it with file's offset.
+ * Uses logError(), from log.h included by the calling file.
+ */
+#define logXMLError(message, file)  do { \
+   setXMLError((message), (file)); \
+   logError((message), __FILE__, __LINE__); \
+} while(0)
+
+
+/**
+ * \brief Parsing error in a XML file.
+ */
+typedef struct XML_Error {
+   const char* message;  /**< Error's description, NULL if none. */
+   long offset;          /**< Offset in file where error was found, -1 if none. */
+   long line;            /**< Line of offset, from 1, 0 until located. */
+   long column;          /**< Column of offset in bytes, from 1, 0 until located. */
+} XML_Error;
+
+
+void setXMLError(const char* message, FILE* file);
+const XML_Error* getXMLError(void);
+void clearXMLError(void);
+int locateXMLErrors(FILE* file, XML_Error* errors, int count);
+
+
+#endif /* ERROR_H_INCLUDED */
@@ -0,0 +1,586 @@
+/**
+ * \file flat.c
+ * \brief Flattened XML tree related functions
+ *
+ * Functions to build a XML_Flat table from a tree and to find values in it.
+ *
+ * \author François-Xavier Balu \<fx.balu@gmail.com\>
+ * \date 17 octobre 2026
+ */
+
+
+#include <stdlib.h>     /* malloc(), realloc(), free(), atoi(), strtod(), qsort() */
+#include <string.h>     /* strlen(), strcmp(), memcpy(), memcmp() */
+
+#include "../log.h"     /* logError(), logMem() */
+#include "name.h"       /* hashXMLString(), countXMLNames() */
+#include "node.h"       /* XML_Node, getXMLNextChild() */
+#include "flat.h"
+
+
+/**
+ * \brief Average number of entries in a perfect hash bucket.
+ */
+#define XML_FLAT_BUCKET_SIZE  4
+
+/**
+ * \brief Displacements tried for a bucket before giving up perfect hashing.
+ */
+#define XML_FLAT_MAX_SEED  (1u << 20)
+
+
+/**
+ * \brief Paths and entries being gathered from a tree.
+ */
+typedef struct XML_FlatBuilder {
+   XML_FlatEntry* entries;    /**< Gathered entries. */
+   size_t* offsets;           /**< Entries' paths offsets in paths. */
+   size_t count;              /**< Number of entries. */
+   size_t capacity;           /**< Allocated entries. */
+   char* paths;               /**< Gathered paths, separated by '\\0'. */
+   size_t pathsLength;        /**< Used characters in paths. */
+   size_t pathsCapacity;      /**< Allocated characters in paths. */
+   char* path;                /**< Path of the node being flattened. */
+   size_t pathCapacity;       /**< Allocated characters in path. */
+   XML_Node** firsts;         /**< Flattened children of nodes being flattened. */
+   size_t firstsLength;       /**< Used children in firsts. */
+   size_t firstsCapacity;     /**< Allocated children in firsts. */
+   unsigned* seen;            /**< Stamp of last node with a child, by name id. */
+   size_t seenLength;         /**< Name identifiers in seen. */
+   unsigned stamp;            /**< Stamp of node whose children are gathered. */
+} XML_FlatBuilder;
+
+
+/**
+ * \brief Grow a buffer to hold at least \p needed bytes.
+ *
+ * \return  1 on success, 0 if memory can't be allocated.
+ */
+static int reserveXMLFlatBuffer(void** buffer, size_t* capacity, size_t needed,
+                                size_t size)
+{
+   void* grown;
+   size_t length;
+
+   if(needed <= *capacity) {
+      return 1;
+   }
+   length = (*capacity == 0) ? 256 : *capacity;
+   while(length < needed) {
+      length *= 2;
+   }
+   if((grown = realloc(*buffer, length * size)) == NULL) {
+      logError("Can't reallocate memory for flattened tree", __FILE__, __LINE__);
+      return 0;
+   }
+   *buffer = grown;
+   *capacity = length;
+
+   return 1;
+}
+
+
+/**
+ * \brief Append a string to the path being built.
+ *
+ * \return  1 on success, 0 if memory can't be allocated.
+ */
+static int appendXMLFlatPath(XML_FlatBuilder* b, size_t at,
+                             const char* str, size_t length)
+{
+   if(!reserveXMLFlatBuffer((void**)&b->path, &b->pathCapacity,
+                            at + length + 1, sizeof(char))) {
+      return 0;
+   }
+   memcpy(b->path + at, str, length);
+   b->path[at + length] = '\0';
+
+   return 1;
+}
+
+
+/**
+ * \brief Add an entry for the \p length first characters of current path.
+ *
+ * \return  1 on success, 0 if memory can't be allocated.
+ */
+static int addXMLFlatEntry(XML_FlatBuilder* b, size_t length, char* value)
+{
+   size_t capacity;
+
+   capacity = b->capacity;
+   if(!reserveXMLFlatBuffer((void**)&b->entries, &capacity,
+                            b->count + 1, sizeof(XML_FlatEntry)) ||
+      !reserveXMLFlatBuffer((void**)&b->offsets, &b->capacity,
+                            b->count + 1, sizeof(size_t)) ||
+      !reserveXMLFlatBuffer((void**)&b->paths, &b->pathsCapacity,
+                            b->pathsLength + length + 1, sizeof(char))) {
+      return 0;
+   }
+
+   memcpy(b->paths + b->pathsLength, b->path, length);
+   b->paths[b->pathsLength + length] = '\0';
+   b->offsets[b->count] = b->pathsLength;
+   b->entries[b->count].path = NULL;
+   b->entries[b->count].length = length;
+   b->entries[b->count].hash = hashXMLString(b->path, length);
+   b->entries[b->count].value = value;
+   b->pathsLength += length + 1;
+   b->count++;
+
+   return 1;
+}
+
+
+/**
+ * \brief Gather entries of a node and its descendants.
+ * The \p at first characters of current path hold the parent's path,
+ * followed by '/'. Among children with the same name, only the first one is
+ * gathered, so a later sibling never answers a path getXMLValue() would
+ * resolve through the first one.
+ *
+ * \return  1 on success, 0 if memory can't be allocated.
+ */
+static int flattenXMLNode(XML_Node* n, size_t at, XML_FlatBuilder* b)
+{
+   XML_Attribute* attr;
+   XML_Node* child;
+   size_t length, nameLength, attrLength, start, i;
+   int iChild;
+
+   nameLength = strlen(n->name);
+   if(!appendXMLFlatPath(b, at, n->name, nameLength)) {
+      return 0;
+   }
+   length = at + nameLength;
+
+   /* node's value, "path$" */
+   if(n->value != NULL) {
+      if(!appendXMLFlatPath(b, length, "$", 1) ||
+         !addXMLFlatEntry(b, length + 1, n->value)) {
+         return 0;
+      }
+   }
+
+   /* node's attributes, "path:attribute" */
+   decodeXMLNodeAttributes(n);
+   for(attr = n->attr; attr != NULL; attr = attr->next) {
+      attrLength = strlen(attr->name);
+      if(!appendXMLFlatPath(b, length, ":", 1) ||
+         !appendXMLFlatPath(b, length + 1, attr->name, attrLength) ||
+         !addXMLFlatEntry(b, length + 1 + attrLength, attr->value)) {
+         return 0;
+      }
+   }
+
+   /* node's children, "path/child", only the first one of each name, as
+      getXMLValue() only looks into it */
+   start = b->firstsLength;
+   b->stamp++;
+   for(iChild = 0, child = n->first; child != NULL;
+       child = getXMLNextChild(n, child, iChild++)) {
+      if((child->id >= 0) && ((size_t)child->id < b->seenLength)) {
+         if(b->seen[child->id] == b->stamp) {
+            continue;
+         }
+         b->seen[child->id] = b->stamp;
+      }
+      else {
+         for(i = start; (i < b->firstsLength) && (strcmp(b->firsts[i]->name, child->name) != 0);
+             i++);
+         if(i < b->firstsLength) {
+            continue;
+         }
+      }
+      if(!reserveXMLFlatBuffer((void**)&b->firsts, &b->firstsCapacity,
+                               b->firstsLength + 1, sizeof(XML_Node*))) {
+         return 0;
+      }
+      b->firsts[b->firstsLength++] = child;
+   }
+   for(i = start; i < b->firstsLength; i++) {
+      if(!appendXMLFlatPath(b, length, "/", 1) ||
+         !flattenXMLNode(b->firsts[i], length + 1, b)) {
+         return 0;
+      }
+   }
+   b->firstsLength = start;
+
+   return 1;
+}
+
+
+/**
+ * \brief Compute a perfect hash slot.
+ */
+static size_t getXMLFlatSlot(unsigned long long hash, unsigned seed, size_t count)
+{
+   hash ^= (seed + 1ULL) * 0x9E3779B97F4A7C15ULL;
+   hash ^= hash >> 33;
+   hash *= 0xFF51AFD7ED558CCDULL;
+   hash ^= hash >> 33;
+
+   return (size_t)(hash % count);
+}
+
+
+/**
+ * \brief Compute a perfect hash bucket.
+ */
+static size_t getXMLFlatBucket(unsigned long long hash, size_t bucketCount)
+{
+   return (size_t)((hash >> 32) % bucketCount);
+}
+
+
+/**
+ * \brief Bucket size and index, to sort buckets by decreasing size.
+ */
+typedef struct XML_FlatBucket {
+   size_t size;
+   size_t index;
+} XML_FlatBucket;
+
+
+static int compareXMLFlatBuckets(const void* a, const void* b)
+{
+   const XML_FlatBucket* x = a;
+   const XML_FlatBucket* y = b;
+
+   if(x->size != y->size) {
+      return (x->size < y->size) ? 1 : -1;
+   }
+   return (x->index < y->index) ? -1 : (x->index > y->index);
+}
+
+
+/**
+ * \brief Build a minimal perfect hash of unique entries.
+ * Entries are spread in buckets, and largest buckets first look for a seed
+ * sending all their entries to free slots. Entries are then moved to their
+ * slot, so a lookup reads one seed and one entry.
+ *
+ * \return  1 on success, 0 if no perfect hash was found.
+ */
+static int buildXMLFlatPerfectHash(XML_Flat* flat)
+{
+   XML_FlatBucket* buckets;
+   XML_FlatEntry* sorted;
+   size_t *starts, *order, *slots;
+   unsigned char* taken;
+   size_t i, j, k, b, first, size;
+   unsigned seed;
+   int found, success;
+
+   flat->bucketCount = flat->count / XML_FLAT_BUCKET_SIZE + 1;
+   buckets = malloc(flat->bucketCount * sizeof(XML_FlatBucket));
+   starts = calloc(flat->bucketCount + 1, sizeof(size_t));
+   order = malloc(flat->count * sizeof(size_t));
+   slots = malloc(flat->count * sizeof(size_t));
+   taken = calloc(flat->count, sizeof(unsigned char));
+   sorted = malloc(flat->count * sizeof(XML_FlatEntry));
+   flat->seeds = calloc(flat->bucketCount, sizeof(unsigned));
+   success = 1;
+
+   if((buckets == NULL) || (starts == NULL) || (order == NULL) ||
+      (slots == NULL) || (taken == NULL) || (sorted == NULL) ||
+      (flat->seeds == NULL)) {
+      logError("Can't allocate memory for perfect hash", __FILE__, __LINE__);
+      success = 0;
+   }
+   else {
+      /* group entries by bucket */
+      for(i = 0; i < flat->count; i++) {
+         starts[getXMLFlatBucket(flat->entries[i].hash, flat->bucketCount) + 1]++;
+      }
+      for(b = 0; b < flat->bucketCount; b++) {
+         buckets[b].size = starts[b + 1];
+         buckets[b].index = b;
+         starts[b + 1] += starts[b];
+      }
+      for(i = 0; i < flat->count; i++) {
+         b = getXMLFlatBucket(flat->entries[i].hash, flat->bucketCount);
+         order[starts[b] + (--buckets[b].size)] = i;
+      }
+      for(b = 0; b < flat->bucketCount; b++) {
+         buckets[b].size = starts[b + 1] - starts[b];
+      }
+      qsort(buckets, flat->bucketCount, sizeof(XML_FlatBucket),
+            compareXMLFlatBuckets);
+
+      /* find a seed for each bucket, largest first */
+      for(b = 0; (b < flat->bucketCount) && success; b++) {
+         size = buckets[b].size;
+         first = starts[buckets[b].index];
+         found = 0;
+         for(seed = 0; (seed < XML_FLAT_MAX_SEED) && !found && (size > 0); seed++) {
+            found = 1;
+            for(k = 0; (k < size) && found; k++) {
+               slots[k] = getXMLFlatSlot(flat->entries[order[first + k]].hash,
+                                         seed, flat->count);
+               if(taken[slots[k]]) {
+                  found = 0;
+               }
+               for(j = 0; (j < k) && found; j++) {
+                  if(slots[j] == slots[k]) {
+                     found = 0;
+                  }
+               }
+            }
+            if(found) {
+               flat->seeds[buckets[b].index] = seed;
+               for(k = 0; k < size; k++) {
+                  taken[slots[k]] = 1;
+                  sorted[slots[k]] = flat->entries[order[first + k]];
+               }
+            }
+         }
+         if((size > 0) && !found) {
+            success = 0;
+         }
+      }
+   }
+
+   if(success) {
+      free(flat->entries);
+      flat->entries = sorted;
+   }
+   else {
+      free(sorted);
+      free(flat->seeds);
+      flat->seeds = NULL;
+      flat->bucketCount = 0;
+   }
+   free(buckets);
+   free(starts);
+   free(order);
+   free(slots);
+   free(taken);
+
+   return success;
+}
+
+
+/**
+ * \brief Index entries in an open addressing table.
+ * Entries' paths are unique, as only the first of same named siblings is
+ * flattened.
+ *
+ * \return  1 on success, 0 if memory can't be allocated.
+ */
+static int buildXMLFlatTable(XML_Flat* flat)
+{
+   XML_FlatEntry* entry;
+   size_t i, count, slot;
+
+   flat->tableLength = 16;
+   while(flat->tableLength < flat->count * 2) {
+      flat->tableLength *= 2;
+   }
+   if((flat->table = calloc(flat->tableLength, sizeof(size_t))) == NULL) {
+      logError("Can't allocate memory for flattened tree", __FILE__, __LINE__);
+      return 0;
+   }
+
+   count = 0;
+   for(i = 0; i < flat->count; i++) {
+      entry = &flat->entries[i];
+      slot = (size_t)entry->hash & (flat->tableLength - 1);
+      while((flat->table[slot] != 0) &&
+            ((flat->entries[flat->table[slot] - 1].hash != entry->hash) ||
+             (strcmp(flat->entries[flat->table[slot] - 1].path, entry->path) != 0))) {
+         slot = (slot + 1) & (flat->tableLength - 1);
+      }
+      /* new path, keep entry */
+      if(flat->table[slot] == 0) {
+         flat->entries[count] = *entry;
+         count++;
+         flat->table[slot] = count;
+      }
+   }
+   flat->count = count;
+
+   return 1;
+}
+
+
+/**
+ * \brief Flatten a tree in a table.
+ * Every node value and attribute is added to the table with its full path.
+ * Values aren't copied, so the table must be destroyed before the tree, and
+ * rebuilt after the tree is modified.
+ *
+ * \param root   Flattened tree.
+ * \param flags  XML_FLAT_TYPED, XML_FLAT_PERFECT, or both.
+ * \return       Created table, NULL if an error happened.
+ */
+XML_Flat* createXMLFlat(XML_Node* root, int flags)
+{
+   XML_FlatBuilder b;
+   XML_Flat* flat;
+   XML_FlatEntry* entry;
+   size_t i;
+
+   if(root == NULL) {
+      logError("Trying to flatten a NULL tree", __FILE__, __LINE__);
+      return NULL;
+   }
+   if((flat = malloc(sizeof(XML_Flat))) == NULL) {
+      logError("Can't allocate memory for XML_Flat", __FILE__, __LINE__);
+      return NULL;
+   }
+   logMem(LOG_ALLOC, flat, "XML_Flat", "flattened tree", __FILE__, __LINE__);
+   flat->entries = NULL;
+   flat->count = 0;
+   flat->paths = NULL;
+   flat->table = NULL;
+   flat->tableLength = 0;
+   flat->seeds = NULL;
+   flat->bucketCount = 0;
+   flat->flags = flags;
+
+   /* gather paths and values */
+   b.entries = NULL;
+   b.offsets = NULL;
+   b.count = b.capacity = 0;
+   b.paths = NULL;
+   b.pathsLength = b.pathsCapacity = 0;
+   b.path = NULL;
+   b.pathCapacity = 0;
+   b.firsts = NULL;
+   b.firstsLength = b.firstsCapacity = 0;
+   b.seenLength = countXMLNames();
+   b.stamp = 0;
+   if(((b.seen = calloc(b.seenLength + 1, sizeof(unsigned))) == NULL) ||
+      !flattenXMLNode(root, 0, &b)) {
+      if(b.seen == NULL) {
+         logError("Can't allocate memory for flattened tree", __FILE__, __LINE__);
+      }
+      free(b.entries);
+      free(b.offsets);
+      free(b.paths);
+      free(b.path);
+      free(b.firsts);
+      free(b.seen);
+      destroyXMLFlat(flat);
+      return NULL;
+   }
+   flat->entries = b.entries;
+   flat->count = b.count;
+   flat->paths = b.paths;
+   for(i = 0; i < b.count; i++) {
+      flat->entries[i].path = b.paths + b.offsets[i];
+   }
+   free(b.offsets);
+   free(b.path);
+   free(b.firsts);
+   free(b.seen);
+
+   /* pre-convert values */
+   for(i = 0; i < flat->count; i++) {
+      entry = &flat->entries[i];
+      entry->intValue = 0;
+      entry->doubleValue = 0.0;
+      entry->boolValue = -1;
+      if(flags & XML_FLAT_TYPED) {
+         entry->intValue = atoi(entry->value);
+         entry->doubleValue = strtod(entry->value, NULL);
+         if(strcmp(entry->value, "true") == 0) {
+            entry->boolValue = 1;
+         }
+         else if(strcmp(entry->value, "false") == 0) {
+            entry->boolValue = 0;
+         }
+      }
+   }
+
+   /* index entries, perfect hash needs unique paths */
+   if(!buildXMLFlatTable(flat)) {
+      destroyXMLFlat(flat);
+      return NULL;
+   }
+   if((flags & XML_FLAT_PERFECT) && (flat->count > 0)) {
+      if(buildXMLFlatPerfectHash(flat)) {
+         free(flat->table);
+         flat->table = NULL;
+         flat->tableLength = 0;
+      }
+      else {
+         logError("No perfect hash found, keeping hash table", __FILE__, __LINE__);
+         flat->flags &= ~XML_FLAT_PERFECT;
+      }
+   }
+
+   return flat;
+}
+
+
+/**
+ * \brief Destroy a flattened tree.
+ * The tree itself isn't modified.
+ *
+ * \param flat  Destroyed table.
+ */
+void destroyXMLFlat(XML_Flat* flat)
+{
+   if(flat == NULL) {
+      logError("Trying to destroy a NULL XML_Flat", __FILE__, __LINE__);
+   }
+   else {
+      free(flat->entries);
+      free(flat->paths);
+      free(flat->table);
+      free(flat->seeds);
+      logMem(LOG_FREE, flat, "XML_Flat", "flattened tree", __FILE__, __LINE__);
+      free(flat);
+   }
+}
+
+
+/**
+ * \brief Find a value by its full path.
+ *
+ * \param[in] path  Value's path, such as "root/foo$" or "root/foo:attribute".
+ * \param     flat  Searched table.
+ * \return          Found entry, NULL if no value has this path.
+ */
+XML_FlatEntry* findXMLFlatEntry(const char* path, XML_Flat* flat)
+{
+   XML_FlatEntry* entry;
+   unsigned long long hash;
+   size_t length, slot;
+
+   if((path == NULL) || (flat == NULL) || (flat->count == 0)) {
+      return NULL;
+   }
+
+   length = strlen(path);
+   hash = hashXMLString(path, length);
+
+   /* perfect hash, a single entry to check */
+   if(flat->seeds != NULL) {
+      entry = &flat->entries[getXMLFlatSlot(hash,
+                             flat->seeds[getXMLFlatBucket(hash, flat->bucketCount)],
+                             flat->count)];
+      if((entry->hash == hash) &&
+         (entry->length == length) &&
+         (memcmp(entry->path, path, length) == 0)) {
+         return entry;
+      }
+      return NULL;
+   }
+
+   /* open addressing table */
+   slot = (size_t)hash & (flat->tableLength - 1);
+   while(flat->table[slot] != 0) {
+      entry = &flat->entries[flat->table[slot] - 1];
+      if((entry->hash == hash) &&
+         (entry->length == length) &&
+         (memcmp(entry->path, path, length) == 0)) {
+         return entry;
+      }
+      slot = (slot + 1) & (flat->tableLength - 1);
+   }
+
+   return NULL;
+}
@@ -0,0 +1,91 @@
+/**
+ * \file flat.h
+ * \brief Flattened XML tree related definitions
+ *
+ * Definition of a XML_Flat structure, a hash table from every value's full
+ * path, such as "root/foo/bar$" or "root/foo/bar:attribute", to this value.
+ * Finding a value is then a single hash probe, without reading the path step
+ * by step nor walking the tree.
+ *
+ * \author François-Xavier Balu \<fx.balu@gmail.com\>
+ * \date 17 octobre 2026
+ */
+
+
+#ifndef FLAT_H_INCLUDED
+#define FLAT_H_INCLUDED
+
+
+#include "node.h"    /* XML_Node */
+
+
+/**
+ * \brief Convert values to int, double and boolean when flattening.
+ */
+#define XML_FLAT_TYPED    1
+
+/**
+ * \brief Index entries with a minimal perfect hash.
+ * Building takes longer, but the table uses about one byte per entry, and a
+ * lookup always reads a single entry. Best for configurations never modified.
+ */
+#define XML_FLAT_PERFECT  2
+
+/**
+ * \brief Also build children arrays of all nodes.
+ * Children can then be read by index with getXMLChildAt() in constant time,
+ * and getXMLChildren() returns their arrays.
+ */
+#define XML_FLAT_CHILDREN  4
+
+/**
+ * \brief Also sort all nodes' children by name.
+ * getXMLNode() and getXMLValue() then find each node of a path by binary
+ * search, instead of comparing every sibling's name.
+ */
+#define XML_FLAT_SORTED  8
+
+/**
+ * \brief Also decode attributes kept undecoded by XML_PARSE_LAZY_ATTRIBUTES.
+ * Looking an undecoded attribute up adds it to its node, so a lazy tree read
+ * by several threads must be decoded first.
+ */
+#define XML_FLAT_ATTRIBUTES  16
+
+
+/**
+ * \brief A value and its full path.
+ */
+typedef struct XML_FlatEntry {
+   char* path;                /**< Full path of the value. */
+   size_t length;             /**< Path's length. */
+   unsigned long long hash;   /**< Path's hash. */
+   char* value;               /**< Value, owned by the tree. */
+   int intValue;              /**< Value read as an int, with XML_FLAT_TYPED. */
+   double doubleValue;        /**< Value read as a double, with XML_FLAT_TYPED. */
+   int boolValue;             /**< 1 for "true", 0 for "false", -1 otherwise. */
+} XML_FlatEntry;
+
+
+/**
+ * \brief Table of all values in a tree, by full path.
+ */
+typedef struct XML_Flat {
+   XML_FlatEntry* entries;    /**< Entries, in slots order if perfect. */
+   size_t count;              /**< Number of entries. */
+   char* paths;               /**< Storage of all entries' paths. */
+   size_t* table;             /**< Open addressing table of entries + 1. */
+   size_t tableLength;        /**< Slots in table, power of 2. */
+   unsigned* seeds;           /**< Perfect hash displacement, by bucket. */
+   size_t bucketCount;        /**< Number of perfect hash buckets. */
+   int flags;                 /**< XML_FLAT_TYPED and XML_FLAT_PERFECT. */
+} XML_Flat;
+
+
+XML_Flat* createXMLFlat(XML_Node* root, int flags);
+void destroyXMLFlat(XML_Flat* flat);
+
+XML_FlatEntry* findXMLFlatEntry(const char* path, XML_Flat* flat);
+
+
+#endif /* FLAT_H_INCLUDED */
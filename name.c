@@ -0,0 +1,558 @@
+/**
+ * \file name.c
+ * \brief XML names dictionary related functions
+ *
+ * Names are stored once in a growing array, indexed by their identifier, and
+ * found back through an open addressing table of identifiers. The dictionary
+ * is shared by all threads, and looked up on every parsed name, so lookups
+ * never lock.
+ *
+ * Arrays and table form a snapshot, published through an atomic pointer.
+ * Adding a name only fills free slots of the current snapshot: the name is
+ * written first, then its identifier is stored in the table, so a reader
+ * finding an identifier also finds its name. A full snapshot is copied into
+ * a bigger one, published in its place. As in reload.c, readers announce the
+ * epoch they read in, and the replaced snapshot is freed once every reader
+ * has left older epochs. Only additions are serialized, by a mutex.
+ *
+ * Names come from parsed files, so the table is probed with SipHash keyed
+ * randomly once per process: colliding names can't be chosen in advance.
+ *
+ * \author François-Xavier Balu \<fx.balu@gmail.com\>
+ * \date 17 octobre 2026
+ */
+
+
+#include <stdio.h>    /* fopen(), fread(), fclose() */
+#include <stdlib.h>   /* malloc(), realloc(), free() */
+#include <string.h>   /* memcmp(), memcpy() */
+#include <time.h>     /* time() */
+#include <unistd.h>   /* getpid() */
+#include <sched.h>    /* sched_yield() */
+#include <pthread.h>  /* pthread_mutex_lock(), pthread_mutex_unlock(),
+                         pthread_once(), pthread_key_create(), pthread_setspecific() */
+#include <stdatomic.h>  /* atomic types */
+
+#include "../log.h"  /* logError(), logMem() */
+#include "name.h"
+
+
+/** \brief Initial number of slots in the identifiers table. */
+#define XML_NAME_TABLE_LENGTH  256
+
+
+/** \brief Maximum number of threads reading the dictionary without lock. */
+#ifndef XML_NAME_MAX_READERS
+#define XML_NAME_MAX_READERS  256
+#endif /* XML_NAME_MAX_READERS */
+
+
+/**
+ * \brief Snapshot of the dictionary.
+ */
+typedef struct XML_NameTable {
+   char** names;               /**< Names, indexed by identifier. */
+   size_t* lengths;            /**< Names' lengths. */
+   unsigned long long* hashes; /**< Names' hashes. */
+   atomic_int count;           /**< Number of interned names. */
+   int capacity;               /**< Allocated names. */
+   atomic_int* table;          /**< Identifiers table. */
+   size_t tableLength;         /**< Slots in table, power of 2. */
+} XML_NameTable;
+
+
+/**
+ * \brief A reader thread's slot.
+ */
+typedef struct XML_NameReader {
+   atomic_ulong epoch;  /**< Epoch read in, 0 outside lookups. */
+   atomic_int used;     /**< 1 if a thread holds this slot. */
+} XML_NameReader;
+
+
+static _Atomic(XML_NameTable*) current = NULL;  /**< Published snapshot. */
+static atomic_ulong epoch = 1;                   /**< Incremented at each publication. */
+static XML_NameReader readers[XML_NAME_MAX_READERS];  /**< Readers' slots. */
+static _Thread_local XML_NameReader* reader = NULL;   /**< Calling thread's slot. */
+static pthread_key_t readerKey;                  /**< Frees a slot at thread's exit. */
+static pthread_once_t readerOnce = PTHREAD_ONCE_INIT;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;  /**< Serializes additions. */
+static unsigned long long key[2];         /**< Table's hash key. */
+static int keyed = 0;                     /**< 1 once key is drawn. */
+
+
+/**
+ * \brief Hash a string.
+ * FNV-1a hash of \p length first characters of \p str. It is shared by every
+ * module needing to hash names, values or paths.
+ *
+ * \param[in] str     Hashed string.
+ * \param     length  Number of characters hashed.
+ * \return            64 bits hash.
+ */
+unsigned long long hashXMLString(const char* str, size_t length)
+{
+   unsigned long long hash;
+   size_t i;
+
+   hash = 14695981039346656037ULL;
+   for(i = 0; i < length; i++) {
+      hash ^= (unsigned char)str[i];
+      hash *= 1099511628211ULL;
+   }
+
+   return hash;
+}
+
+
+/**
+ * \brief Draw table's hash key, from /dev/urandom when available.
+ * Dictionary must be locked.
+ */
+static void drawXMLNameKey(void)
+{
+   FILE* random;
+
+   key[0] = ((unsigned long long)time(NULL) << 32) ^ (unsigned long long)getpid();
+   key[1] = (unsigned long long)(size_t)&key ^ 0x9e3779b97f4a7c15ULL;
+   if((random = fopen("/dev/urandom", "rb")) != NULL) {
+      if(fread(key, sizeof(key), 1, random) != 1) {
+         logError("Can't read a random key for names table", __FILE__, __LINE__);
+      }
+      fclose(random);
+   }
+   keyed = 1;
+}
+
+
+#define XML_ROTATE(x, b)  (((x) << (b)) | ((x) >> (64 - (b))))
+
+#define XML_SIP_ROUND(v0, v1, v2, v3)  do { \
+   v0 += v1; v1 = XML_ROTATE(v1, 13); v1 ^= v0; v0 = XML_ROTATE(v0, 32); \
+   v2 += v3; v3 = XML_ROTATE(v3, 16); v3 ^= v2; \
+   v0 += v3; v3 = XML_ROTATE(v3, 21); v3 ^= v0; \
+   v2 += v1; v1 = XML_ROTATE(v1, 17); v1 ^= v2; v2 = XML_ROTATE(v2, 32); \
+} while(0)
+
+
+/**
+ * \brief Hash a name with table's key.
+ * SipHash-2-4 of \p length first characters of \p name.
+ *
+ * \return  64 bits hash.
+ */
+static unsigned long long hashXMLName(const char* name, size_t length)
+{
+   unsigned long long v0, v1, v2, v3, m;
+   size_t i, j;
+
+   v0 = key[0] ^ 0x736f6d6570736575ULL;
+   v1 = key[1] ^ 0x646f72616e646f6dULL;
+   v2 = key[0] ^ 0x6c7967656e657261ULL;
+   v3 = key[1] ^ 0x7465646279746573ULL;
+
+   /* whole 8 bytes words, little endian */
+   for(i = 0; i + 8 <= length; i += 8) {
+      for(m = 0, j = 0; j < 8; j++) {
+         m |= (unsigned long long)(unsigned char)name[i + j] << (8 * j);
+      }
+      v3 ^= m;
+      XML_SIP_ROUND(v0, v1, v2, v3);
+      XML_SIP_ROUND(v0, v1, v2, v3);
+      v0 ^= m;
+   }
+
+   /* last bytes, with length in the top byte */
+   for(m = (unsigned long long)length << 56, j = 0; i + j < length; j++) {
+      m |= (unsigned long long)(unsigned char)name[i + j] << (8 * j);
+   }
+   v3 ^= m;
+   XML_SIP_ROUND(v0, v1, v2, v3);
+   XML_SIP_ROUND(v0, v1, v2, v3);
+   v0 ^= m;
+
+   v2 ^= 0xff;
+   for(i = 0; i < 4; i++) {
+      XML_SIP_ROUND(v0, v1, v2, v3);
+   }
+
+   return v0 ^ v1 ^ v2 ^ v3;
+}
+
+
+/**
+ * \brief Find the slot of a name in a snapshot's identifiers table.
+ *
+ * \return  Slot holding the name's identifier, or the empty slot where it
+ *          should be inserted.
+ */
+static size_t findXMLNameSlot(XML_NameTable* t, const char* name, size_t length,
+                              unsigned long long hash)
+{
+   size_t slot;
+   int id;
+
+   slot = (size_t)hash & (t->tableLength - 1);
+   while((id = atomic_load(&t->table[slot])) != XML_NO_NAME) {
+      if((t->hashes[id] == hash) &&
+         (t->lengths[id] == length) &&
+         (memcmp(t->names[id], name, length) == 0)) {
+         break;
+      }
+      slot = (slot + 1) & (t->tableLength - 1);
+   }
+
+   return slot;
+}
+
+
+/**
+ * \brief Free a snapshot, but not the names, which newer snapshots share.
+ */
+static void freeXMLNameTable(XML_NameTable* t)
+{
+   if(t != NULL) {
+      free(t->names);
+      free(t->lengths);
+      free(t->hashes);
+      free(t->table);
+      logMem(LOG_FREE, t, "XML_NameTable", "names snapshot", __FILE__, __LINE__);
+      free(t);
+   }
+}
+
+
+/**
+ * \brief Free a reader's slot, when its thread exits.
+ */
+static void releaseXMLNameReader(void* slot)
+{
+   atomic_store(&((XML_NameReader*)slot)->epoch, 0);
+   atomic_store(&((XML_NameReader*)slot)->used, 0);
+}
+
+
+static void createXMLNameReaderKey(void)
+{
+   pthread_key_create(&readerKey, releaseXMLNameReader);
+}
+
+
+/**
+ * \brief Start a lookup, announcing current epoch in thread's slot.
+ * A thread which can't get a slot locks the dictionary instead.
+ *
+ * \return  Thread's slot, NULL if dictionary was locked.
+ */
+static XML_NameReader* enterXMLNames(void)
+{
+   int i, unused;
+
+   if(reader == NULL) {
+      pthread_once(&readerOnce, createXMLNameReaderKey);
+      for(i = 0; (i < XML_NAME_MAX_READERS) && (reader == NULL); i++) {
+         unused = 0;
+         if(atomic_compare_exchange_strong(&readers[i].used, &unused, 1)) {
+            reader = &readers[i];
+            pthread_setspecific(readerKey, reader);
+         }
+      }
+      if(reader == NULL) {
+         pthread_mutex_lock(&lock);
+         return NULL;
+      }
+   }
+
+   atomic_store(&reader->epoch, atomic_load(&epoch));
+   return reader;
+}
+
+
+/**
+ * \brief End a lookup started by enterXMLNames().
+ */
+static void leaveXMLNames(XML_NameReader* slot)
+{
+   if(slot == NULL) {
+      pthread_mutex_unlock(&lock);
+   }
+   else {
+      atomic_store_explicit(&slot->epoch, 0, memory_order_release);
+   }
+}
+
+
+/**
+ * \brief Publish a snapshot, and free the replaced one once no reader can
+ * use it anymore. Dictionary must be locked.
+ */
+static void publishXMLNameTable(XML_NameTable* t)
+{
+   XML_NameTable* old;
+   unsigned long target, e;
+   int i;
+
+   old = atomic_exchange(&current, t);
+   target = atomic_fetch_add(&epoch, 1) + 1;
+
+   /* wait for readers still in an older epoch */
+   for(i = 0; i < XML_NAME_MAX_READERS; i++) {
+      while(atomic_load(&readers[i].used) &&
+            ((e = atomic_load(&readers[i].epoch)) != 0) &&
+            (e < target)) {
+         sched_yield();
+      }
+   }
+
+   freeXMLNameTable(old);
+}
+
+
+/**
+ * \brief Copy current snapshot into a bigger one, and publish it.
+ * Dictionary must be locked.
+ *
+ * \return  1 on success, 0 if memory can't be allocated.
+ */
+static int growXMLNameTable(void)
+{
+   XML_NameTable *old, *t;
+   size_t i, slot;
+   int id, count;
+
+   old = atomic_load(&current);
+   count = (old == NULL) ? 0 : atomic_load(&old->count);
+   if((t = malloc(sizeof(XML_NameTable))) == NULL) {
+      logError("Can't allocate memory for names table", __FILE__, __LINE__);
+      return 0;
+   }
+   logMem(LOG_ALLOC, t, "XML_NameTable", "names snapshot", __FILE__, __LINE__);
+   t->capacity = (old == NULL) ? XML_NAME_TABLE_LENGTH : (old->capacity * 2);
+   t->tableLength = 2 * (size_t)t->capacity;
+   t->names = malloc(t->capacity * sizeof(char*));
+   t->lengths = malloc(t->capacity * sizeof(size_t));
+   t->hashes = malloc(t->capacity * sizeof(unsigned long long));
+   t->table = malloc(t->tableLength * sizeof(atomic_int));
+   if((t->names == NULL) || (t->lengths == NULL) || (t->hashes == NULL) ||
+      (t->table == NULL)) {
+      logError("Can't allocate memory for names table", __FILE__, __LINE__);
+      freeXMLNameTable(t);
+      return 0;
+   }
+
+   if(count > 0) {
+      memcpy(t->names, old->names, count * sizeof(char*));
+      memcpy(t->lengths, old->lengths, count * sizeof(size_t));
+      memcpy(t->hashes, old->hashes, count * sizeof(unsigned long long));
+   }
+   for(i = 0; i < t->tableLength; i++) {
+      atomic_init(&t->table[i], XML_NO_NAME);
+   }
+   for(id = 0; id < count; id++) {
+      slot = (size_t)t->hashes[id] & (t->tableLength - 1);
+      while(atomic_load_explicit(&t->table[slot], memory_order_relaxed) != XML_NO_NAME) {
+         slot = (slot + 1) & (t->tableLength - 1);
+      }
+      atomic_init(&t->table[slot], id);
+   }
+   atomic_init(&t->count, count);
+
+   publishXMLNameTable(t);
+
+   return 1;
+}
+
+
+/**
+ * \brief Find a name's identifier in published snapshot, without locking.
+ *
+ * \return  Name's identifier, XML_NO_NAME if it isn't interned.
+ */
+static int lookupXMLName(const char* name, size_t length)
+{
+   XML_NameReader* slot;
+   XML_NameTable* t;
+   int id;
+
+   slot = enterXMLNames();
+   t = atomic_load(&current);
+   id = (t == NULL) ?
+        XML_NO_NAME : atomic_load(&t->table[findXMLNameSlot(t, name, length,
+                                                             hashXMLName(name, length))]);
+   leaveXMLNames(slot);
+
+   return id;
+}
+
+
+/**
+ * \brief Add a name to the dictionary, if it isn't already there.
+ * Dictionary must be locked.
+ *
+ * \return  Name's identifier, XML_NO_NAME if an error happened.
+ */
+static int insertXMLName(const char* name, size_t length)
+{
+   XML_NameTable* t;
+   unsigned long long hash;
+   size_t slot;
+   char* copy;
+   int id;
+
+   if(!keyed) {
+      drawXMLNameKey();
+   }
+
+   /* name added by another thread since its lookup */
+   hash = hashXMLName(name, length);
+   t = atomic_load(&current);
+   if((t != NULL) &&
+      ((id = atomic_load(&t->table[findXMLNameSlot(t, name, length, hash)])) != XML_NO_NAME)) {
+      return id;
+   }
+   if((t != NULL) && (atomic_load(&t->count) >= XML_MAX_NAMES)) {
+      logError("Names dictionary is full, see XML_MAX_NAMES", __FILE__, __LINE__);
+      return XML_NO_NAME;
+   }
+
+   /* grow a snapshot full of names, or whose table is half full */
+   if((t == NULL) || (atomic_load(&t->count) == t->capacity)) {
+      if(!growXMLNameTable()) {
+         return XML_NO_NAME;
+      }
+      t = atomic_load(&current);
+   }
+   slot = findXMLNameSlot(t, name, length, hash);
+
+   if((copy = malloc((length + 1) * sizeof(char))) == NULL) {
+      logError("Can't allocate memory for an interned name", __FILE__, __LINE__);
+      return XML_NO_NAME;
+   }
+   logMem(LOG_ALLOC, copy, "string", "interned name", __FILE__, __LINE__);
+   memcpy(copy, name, length);
+   copy[length] = '\0';
+
+   /* name first, identifier last, for readers */
+   id = atomic_load(&t->count);
+   t->names[id] = copy;
+   t->lengths[id] = length;
+   t->hashes[id] = hash;
+   atomic_store(&t->table[slot], id);
+   atomic_store(&t->count, id + 1);
+
+   return id;
+}
+
+
+/**
+ * \brief Intern a name.
+ * Give the identifier of a name, adding it to the dictionary if it isn't
+ * already there. Only additions lock the dictionary. Added names stay until
+ * clearXMLNames(), the dictionary holding at most XML_MAX_NAMES of them.
+ *
+ * \param[in] name    Interned name, doesn't need to end with '\\0'.
+ * \param     length  Name's length.
+ * \return            Name's identifier, XML_NO_NAME if dictionary is full or an
+ *                    error happened.
+ */
+int internXMLName(const char* name, size_t length)
+{
+   int id;
+
+   if(name == NULL) {
+      logError("Trying to intern a NULL name", __FILE__, __LINE__);
+      return XML_NO_NAME;
+   }
+
+   if((id = lookupXMLName(name, length)) != XML_NO_NAME) {
+      return id;
+   }
+
+   pthread_mutex_lock(&lock);
+   id = insertXMLName(name, length);
+   pthread_mutex_unlock(&lock);
+
+   return id;
+}
+
+
+/**
+ * \brief Find a name's identifier without interning it.
+ * Never locks.
+ *
+ * \param[in] name    Searched name, doesn't need to end with '\\0'.
+ * \param     length  Name's length.
+ * \return            Name's identifier, XML_NO_NAME if it was never interned.
+ */
+int findXMLName(const char* name, size_t length)
+{
+   if(name == NULL) {
+      return XML_NO_NAME;
+   }
+
+   return lookupXMLName(name, length);
+}
+
+
+/**
+ * \brief Get an interned name from its identifier.
+ * Returned string stays valid until clearXMLNames() is called. Never locks.
+ *
+ * \param id  Name's identifier.
+ * \return    Interned name, NULL if identifier is unknown.
+ */
+const char* getXMLName(int id)
+{
+   XML_NameReader* slot;
+   XML_NameTable* t;
+   const char* name;
+
+   slot = enterXMLNames();
+   t = atomic_load(&current);
+   name = ((t == NULL) || (id < 0) || (id >= atomic_load(&t->count))) ? NULL : t->names[id];
+   leaveXMLNames(slot);
+
+   return name;
+}
+
+
+/**
+ * \brief Count interned names.
+ * Identifiers are always in [0, countXMLNames()[.
+ */
+int countXMLNames(void)
+{
+   XML_NameReader* slot;
+   XML_NameTable* t;
+   int n;
+
+   slot = enterXMLNames();
+   t = atomic_load(&current);
+   n = (t == NULL) ? 0 : atomic_load(&t->count);
+   leaveXMLNames(slot);
+
+   return n;
+}
+
+
+/**
+ * \brief Empty names dictionary.
+ * Every identifier previously given becomes invalid, so this must only be
+ * called once all trees using them have been destroyed.
+ */
+void clearXMLNames(void)
+{
+   XML_NameTable* t;
+   int id, count;
+
+   pthread_mutex_lock(&lock);
+   if((t = atomic_load(&current)) != NULL) {
+      count = atomic_load(&t->count);
+      for(id = 0; id < count; id++) {
+         logMem(LOG_FREE, t->names[id], "string", "interned name", __FILE__, __LINE__);
+         free(t->names[id]);
+      }
+      publishXMLNameTable(NULL);
+   }
+   pthread_mutex_unlock(&lock);
+}
@@ -0,0 +1,51 @@
+/**
+ * \file name.h
+ * \brief XML names dictionary related definitions
+ *
+ * Element and attribute names are interned in a dictionary, which gives each
+ * distinct name a small integer identifier. Comparing two identifiers is then
+ * enough to compare two names.
+ *
+ * The dictionary is shared by the whole process and never shrinks: every
+ * element name, attribute name and namespace URI ever parsed stays in it,
+ * as trees refer to them by identifier. A service parsing files it doesn't
+ * control sees it grow with every new name, up to XML_MAX_NAMES. New names
+ * are then left without identifier: their nodes are still parsed, but what
+ * needs identifiers, such as namespaces' resolution, fails on them.
+ * clearXMLNames() empties the dictionary, once no tree exists.
+ *
+ * \author François-Xavier Balu \<fx.balu@gmail.com\>
+ * \date 17 octobre 2026
+ */
+
+
+#ifndef NAME_H_INCLUDED
+#define NAME_H_INCLUDED
+
+
+#include <stddef.h>  /* size_t */
+
+
+/**
+ * \brief Identifier of a name that isn't in the dictionary.
+ */
+#define XML_NO_NAME  (-1)
+
+/**
+ * \brief Maximal number of interned names, bounding dictionary's memory.
+ */
+#ifndef XML_MAX_NAMES
+#define XML_MAX_NAMES  (1 << 20)
+#endif /* XML_MAX_NAMES */
+
+
+unsigned long long hashXMLString(const char* str, size_t length);
+
+int internXMLName(const char* name, size_t length);
+int findXMLName(const char* name, size_t length);
+const char* getXMLName(int id);
+int countXMLNames(void);
+void clearXMLNames(void);
+
+
+#endif /* NAME_H_INCLUDED */
@@ -0,0 +1,443 @@
+/**
+ * \file namespace.c
+ * \brief XML namespaces related functions
+ *
+ * Functions to use a XML_NamespaceStack structure, and to find nodes by
+ * namespace URI and local name.
+ *
+ * \author François-Xavier Balu \<fx.balu@gmail.com\>
+ * \date 17 octobre 2026
+ */
+
+
+#include <stdlib.h>     /* malloc(), realloc(), free() */
+#include <string.h>     /* strlen(), strchr(), strcspn(), memchr(), strncmp() */
+
+#include "../log.h"     /* logError(), logMem() */
+#include "name.h"       /* internXMLName(), findXMLName() */
+#include "node.h"       /* XML_Node, getXMLNextChild(), setXMLNodeNamespace() */
+#include "namespace.h"
+
+
+/**
+ * \brief Create an empty namespace stack.
+ * Only reserved prefixes "xml" and "xmlns" are bound in it.
+ *
+ * \return  Created stack, NULL if an error happened.
+ */
+XML_NamespaceStack* createXMLNamespaceStack(void)
+{
+   XML_NamespaceStack* stack;
+
+   if((stack = malloc(sizeof(XML_NamespaceStack))) == NULL) {
+      logError("Can't allocate memory for XML_NamespaceStack", __FILE__, __LINE__);
+   }
+   else {
+      logMem(LOG_ALLOC, stack, "XML_NamespaceStack", "namespace stack",
+             __FILE__, __LINE__);
+      stack->bindings = NULL;
+      stack->count = stack->capacity = 0;
+      stack->scopes = NULL;
+      stack->depth = stack->scopesCapacity = 0;
+      stack->prefixes = NULL;
+      stack->prefixCount = stack->prefixLength = 0;
+      stack->defaultPrefix = internXMLName("", 0);
+      stack->xmlnsPrefix = internXMLName("xmlns", 5);
+
+      if(!pushXMLNamespace(internXMLName("xml", 3),
+                           internXMLName(XML_NAMESPACE_XML,
+                                         strlen(XML_NAMESPACE_XML)),
+                           stack) ||
+         !pushXMLNamespace(stack->xmlnsPrefix,
+                           internXMLName(XML_NAMESPACE_XMLNS,
+                                         strlen(XML_NAMESPACE_XMLNS)),
+                           stack)) {
+         destroyXMLNamespaceStack(stack);
+         stack = NULL;
+      }
+   }
+
+   return stack;
+}
+
+
+/**
+ * \brief Destroy a namespace stack.
+ *
+ * \param stack  Destroyed stack.
+ */
+void destroyXMLNamespaceStack(XML_NamespaceStack* stack)
+{
+   if(stack == NULL) {
+      logError("Trying to destroy a NULL namespace stack", __FILE__, __LINE__);
+   }
+   else {
+      free(stack->bindings);
+      free(stack->scopes);
+      free(stack->prefixes);
+      logMem(LOG_FREE, stack, "XML_NamespaceStack", "namespace stack",
+             __FILE__, __LINE__);
+      free(stack);
+   }
+}
+
+
+/**
+ * \brief Find a prefix in a stack's prefixes table.
+ *
+ * \return  Prefix's slot, or the empty slot where it should be inserted, -1
+ *          if table is empty.
+ */
+static int findXMLNamespacePrefix(int prefix, XML_NamespaceStack* stack)
+{
+   int slot;
+
+   if(stack->prefixLength == 0) {
+      return -1;
+   }
+   slot = ((unsigned)prefix * 2654435761u) & (stack->prefixLength - 1);
+   while((stack->prefixes[slot].prefix != XML_NO_NAME) &&
+         (stack->prefixes[slot].prefix != prefix)) {
+      slot = (slot + 1) & (stack->prefixLength - 1);
+   }
+
+   return slot;
+}
+
+
+/**
+ * \brief Double a stack's prefixes table.
+ *
+ * \return  1 on success, 0 if an error happened.
+ */
+static int growXMLNamespacePrefixes(XML_NamespaceStack* stack)
+{
+   XML_NamespacePrefix* old;
+   int oldLength, length, i, slot;
+
+   length = (stack->prefixLength == 0) ? 8 : (stack->prefixLength * 2);
+   old = stack->prefixes;
+   oldLength = stack->prefixLength;
+   if((stack->prefixes = malloc(length * sizeof(XML_NamespacePrefix))) == NULL) {
+      logError("Can't allocate memory for namespace prefixes", __FILE__, __LINE__);
+      stack->prefixes = old;
+      return 0;
+   }
+   stack->prefixLength = length;
+   for(i = 0; i < length; i++) {
+      stack->prefixes[i].prefix = XML_NO_NAME;
+      stack->prefixes[i].innermost = -1;
+   }
+   for(i = 0; i < oldLength; i++) {
+      if(old[i].prefix != XML_NO_NAME) {
+         slot = findXMLNamespacePrefix(old[i].prefix, stack);
+         stack->prefixes[slot] = old[i];
+      }
+   }
+   free(old);
+
+   return 1;
+}
+
+
+/**
+ * \brief Bind a prefix to a namespace URI.
+ * The binding shadows any previous binding of the same prefix, until the
+ * current scope is closed.
+ *
+ * \param prefix  Prefix identifier.
+ * \param uri     URI identifier, XML_NO_NAME to unbind prefix.
+ * \param stack   Modified stack.
+ * \return        1 on success, 0 if an error happened.
+ */
+int pushXMLNamespace(int prefix, int uri, XML_NamespaceStack* stack)
+{
+   void* grown;
+   int length, slot;
+
+   if(stack == NULL) {
+      logError("Trying to push a namespace in a NULL stack", __FILE__, __LINE__);
+      return 0;
+   }
+   if(prefix < 0) {
+      logError("Trying to push a namespace without prefix", __FILE__, __LINE__);
+      return 0;
+   }
+
+   /* grow bindings */
+   if(stack->count == stack->capacity) {
+      length = (stack->capacity == 0) ? 16 : (stack->capacity * 2);
+      if((grown = realloc(stack->bindings, length * sizeof(XML_Namespace))) == NULL) {
+         logError("Can't reallocate memory for namespaces", __FILE__, __LINE__);
+         return 0;
+      }
+      stack->bindings = grown;
+      stack->capacity = length;
+   }
+
+   /* find prefix, adding it to a table kept at most half full */
+   slot = findXMLNamespacePrefix(prefix, stack);
+   if((slot < 0) || (stack->prefixes[slot].prefix == XML_NO_NAME)) {
+      if((stack->prefixCount + 1) * 2 > stack->prefixLength) {
+         if(!growXMLNamespacePrefixes(stack)) {
+            return 0;
+         }
+         slot = findXMLNamespacePrefix(prefix, stack);
+      }
+      stack->prefixes[slot].prefix = prefix;
+      stack->prefixCount++;
+   }
+
+   stack->bindings[stack->count].prefix = prefix;
+   stack->bindings[stack->count].uri = uri;
+   stack->bindings[stack->count].previous = stack->prefixes[slot].innermost;
+   stack->prefixes[slot].innermost = stack->count;
+   stack->count++;
+
+   return 1;
+}
+
+
+/**
+ * \brief Find the namespace URI bound to a prefix.
+ *
+ * \param prefix  Prefix identifier.
+ * \param stack   Searched stack.
+ * \return        URI identifier, XML_NO_NAME if prefix isn't bound.
+ */
+int resolveXMLNamespace(int prefix, XML_NamespaceStack* stack)
+{
+   int slot;
+
+   if((stack == NULL) ||
+      (prefix < 0) ||
+      ((slot = findXMLNamespacePrefix(prefix, stack)) < 0) ||
+      (stack->prefixes[slot].innermost < 0)) {
+      return XML_NO_NAME;
+   }
+
+   return stack->bindings[stack->prefixes[slot].innermost].uri;
+}
+
+
+/**
+ * \brief Open a new scope, usually when an element is opened.
+ * Bindings pushed afterwards are popped by closeXMLNamespaceScope().
+ *
+ * \param stack  Modified stack.
+ * \return       1 on success, 0 if an error happened.
+ */
+int openXMLNamespaceScope(XML_NamespaceStack* stack)
+{
+   void* grown;
+   int length;
+
+   if(stack == NULL) {
+      logError("Trying to open a scope in a NULL stack", __FILE__, __LINE__);
+      return 0;
+   }
+
+   if(stack->depth == stack->scopesCapacity) {
+      length = (stack->scopesCapacity == 0) ? 16 : (stack->scopesCapacity * 2);
+      if((grown = realloc(stack->scopes, length * sizeof(int))) == NULL) {
+         logError("Can't reallocate memory for namespace scopes", __FILE__, __LINE__);
+         return 0;
+      }
+      stack->scopes = grown;
+      stack->scopesCapacity = length;
+   }
+   stack->scopes[stack->depth] = stack->count;
+   stack->depth++;
+
+   return 1;
+}
+
+
+/**
+ * \brief Close current scope, popping the bindings pushed in it.
+ *
+ * \param stack  Modified stack.
+ */
+void closeXMLNamespaceScope(XML_NamespaceStack* stack)
+{
+   XML_Namespace* binding;
+
+   if(stack == NULL) {
+      logError("Trying to close a scope in a NULL stack", __FILE__, __LINE__);
+   }
+   else if(stack->depth == 0) {
+      logError("No namespace scope to close", __FILE__, __LINE__);
+   }
+   else {
+      stack->depth--;
+      while(stack->count > stack->scopes[stack->depth]) {
+         stack->count--;
+         binding = &stack->bindings[stack->count];
+         stack->prefixes[findXMLNamespacePrefix(binding->prefix, stack)].innermost =
+            binding->previous;
+      }
+   }
+}
+
+
+/**
+ * \brief Split a qualified name and resolve its prefix.
+ *
+ * \param[in]  name           Qualified name, "prefix:local" or "local".
+ * \param      length         Name's length.
+ * \param      id             Identifier of the whole name.
+ * \param      defaultPrefix  Prefix of unprefixed names, XML_NO_NAME if they
+ *                            have no namespace.
+ * \param      stack          Current bindings.
+ * \param[out] ns             Namespace URI identifier.
+ * \param[out] local          Local name identifier.
+ * \return                    1 on success, 0 if prefix isn't bound.
+ */
+static int resolveXMLName(const char* name, size_t length, int id,
+                          int defaultPrefix, XML_NamespaceStack* stack,
+                          int* ns, int* local)
+{
+   const char* colon;
+   int prefix;
+
+   if((colon = memchr(name, ':', length)) == NULL) {
+      *ns = resolveXMLNamespace(defaultPrefix, stack);
+      *local = id;
+   }
+   else {
+      prefix = internXMLName(name, colon - name);
+      if((*ns = resolveXMLNamespace(prefix, stack)) == XML_NO_NAME) {
+         logError("Unbound namespace prefix", __FILE__, __LINE__);
+         return 0;
+      }
+      *local = internXMLName(colon + 1, length - (colon - name) - 1);
+   }
+
+   return 1;
+}
+
+
+/**
+ * \brief Resolve a node's names into namespace and local name identifiers.
+ * Namespaces declared by node's xmlns attributes are pushed in the current
+ * scope before resolution, so the scope must be opened beforehand with
+ * openXMLNamespaceScope(), and closed when node is closed.
+ *
+ * \param n      Resolved node.
+ * \param stack  Current bindings.
+ * \return       1 on success, 0 if a prefix isn't bound.
+ */
+int resolveXMLNodeNamespaces(XML_Node* n, XML_NamespaceStack* stack)
+{
+   XML_Attribute* attr;
+   int uri, ns, local;
+
+   if((n == NULL) || (stack == NULL)) {
+      logError("Trying to resolve namespaces with NULL node or stack",
+               __FILE__, __LINE__);
+      return 0;
+   }
+
+   /* push namespaces declared by this node */
+   for(attr = n->attr; attr != NULL; attr = attr->next) {
+      if(attr->id == stack->xmlnsPrefix) {
+         uri = (attr->value[0] == '\0') ?
+               XML_NO_NAME : internXMLName(attr->value, strlen(attr->value));
+         if(!pushXMLNamespace(stack->defaultPrefix, uri, stack)) {
+            return 0;
+         }
+      }
+      else if(strncmp(attr->name, "xmlns:", 6) == 0) {
+         if(!pushXMLNamespace(internXMLName(attr->name + 6, strlen(attr->name + 6)),
+                              internXMLName(attr->value, strlen(attr->value)),
+                              stack)) {
+            return 0;
+         }
+      }
+   }
+
+   /* unprefixed node names are in default namespace */
+   if(!resolveXMLName(n->name, strlen(n->name), n->id, stack->defaultPrefix,
+                      stack, &ns, &local)) {
+      return 0;
+   }
+   setXMLNodeNamespace(n, ns, local);
+
+   /* unprefixed attribute names have no namespace, except xmlns itself */
+   for(attr = n->attr; attr != NULL; attr = attr->next) {
+      if(!resolveXMLName(attr->name, strlen(attr->name), attr->id,
+                         (attr->id == stack->xmlnsPrefix) ?
+                         stack->xmlnsPrefix : XML_NO_NAME,
+                         stack, &attr->ns, &attr->local)) {
+         return 0;
+      }
+   }
+
+   return 1;
+}
+
+
+/**
+ * \brief Finds a node by namespace URIs and local names.
+ * Each path's step is written "{uri}local", or "local" for a name without
+ * namespace, so "{urn:a}root/{urn:b}item" matches <x:root><y:item> whatever
+ * prefixes are used. Steps are turned into identifiers once, then nodes are
+ * matched by comparing integers only.
+ *
+ * \param[in] path  Node path in the tree.
+ * \param[in] root  Tree's root, or first node of a siblings list.
+ * \return          A pointer to found node, NULL if such a node wasn't found.
+ */
+XML_Node* getXMLNodeNS(char* path, XML_Node* root)
+{
+   XML_Node *n, *parent;
+   char* end;
+   int ns, local, i;
+
+   if((path == NULL) || (root == NULL)) {
+      return NULL;
+   }
+
+   n = root;
+   parent = NULL;
+   while(n != NULL) {
+      /* reads namespace URI */
+      ns = XML_NO_NAME;
+      if(*path == '{') {
+         if((end = strchr(path, '}')) == NULL) {
+            logError("Namespace URI isn't closed by '}'.", __FILE__, __LINE__);
+            return NULL;
+         }
+         /* URI never met, so no node can be in this namespace */
+         if((ns = findXMLName(path + 1, end - path - 1)) == XML_NO_NAME) {
+            return NULL;
+         }
+         path = end + 1;
+      }
+
+      /* reads local name */
+      end = path + strcspn(path, "/");
+      if((local = findXMLName(path, end - path)) == XML_NO_NAME) {
+         return NULL;
+      }
+
+      /* finds a matching sibling */
+      i = 0;
+      while((n != NULL) &&
+            ((getXMLNodeNamespace(n) != ns) || (getXMLNodeLocalName(n) != local))) {
+         n = (parent == NULL) ? n->next : getXMLNextChild(parent, n, i++);
+      }
+
+      /* found node character '/', checks children */
+      if((n != NULL) && (*end == '/')) {
+         parent = n;
+         n = n->first;
+         path = end + 1;
+      }
+      else {
+         break;
+      }
+   }
+
+   return n;
+}
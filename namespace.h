@@ -0,0 +1,87 @@
+/**
+ * \file namespace.h
+ * \brief XML namespaces related definitions
+ *
+ * Definition of a XML_NamespaceStack structure, which keeps prefixes bound by
+ * xmlns attributes while parsing, and functions to resolve names with it.
+ *
+ * Every name is resolved into a (namespace, local name) pair of identifiers
+ * from the names dictionary, so namespace aware lookups only compare integers.
+ *
+ * \author François-Xavier Balu \<fx.balu@gmail.com\>
+ * \date 17 octobre 2026
+ */
+
+
+#ifndef NAMESPACE_H_INCLUDED
+#define NAMESPACE_H_INCLUDED
+
+
+#include "node.h"    /* XML_Node */
+
+
+/**
+ * \brief URI bound to the reserved prefix "xml".
+ */
+#define XML_NAMESPACE_XML    "http://www.w3.org/XML/1998/namespace"
+
+/**
+ * \brief URI of namespace declaring attributes, such as xmlns:prefix.
+ */
+#define XML_NAMESPACE_XMLNS  "http://www.w3.org/2000/xmlns/"
+
+
+/**
+ * \brief Binding of a prefix to a namespace URI.
+ */
+typedef struct XML_Namespace {
+   int prefix;    /**< Prefix identifier, "" for default namespace. */
+   int uri;       /**< URI identifier, XML_NO_NAME if prefix is unbound. */
+   int previous;  /**< Binding shadowed by this one, -1 if none. */
+} XML_Namespace;
+
+
+/**
+ * \brief Innermost binding of a prefix.
+ */
+typedef struct XML_NamespacePrefix {
+   int prefix;     /**< Prefix identifier, XML_NO_NAME for an empty slot. */
+   int innermost;  /**< Innermost binding index, -1 if none. */
+} XML_NamespacePrefix;
+
+
+/**
+ * \brief Stack of namespace bindings.
+ * Bindings are pushed by xmlns attributes and popped when their element is
+ * closed. Each prefix keeps the index of its innermost binding, in a small
+ * table holding only the prefixes bound by parsed documents, so pushing,
+ * popping and resolving a prefix are all O(1).
+ */
+typedef struct XML_NamespaceStack {
+   XML_Namespace* bindings;   /**< Pushed bindings. */
+   int count;                 /**< Number of pushed bindings. */
+   int capacity;              /**< Allocated bindings. */
+   int* scopes;               /**< Bindings count when each scope opened. */
+   int depth;                 /**< Number of opened scopes. */
+   int scopesCapacity;        /**< Allocated scopes. */
+   XML_NamespacePrefix* prefixes;  /**< Bound prefixes, open addressing. */
+   int prefixCount;           /**< Number of prefixes in table. */
+   int prefixLength;          /**< Slots in table, power of 2. */
+   int defaultPrefix;         /**< Identifier of "", the default prefix. */
+   int xmlnsPrefix;           /**< Identifier of "xmlns". */
+} XML_NamespaceStack;
+
+
+XML_NamespaceStack* createXMLNamespaceStack(void);
+void destroyXMLNamespaceStack(XML_NamespaceStack* stack);
+
+int pushXMLNamespace(int prefix, int uri, XML_NamespaceStack* stack);
+int resolveXMLNamespace(int prefix, XML_NamespaceStack* stack);
+int openXMLNamespaceScope(XML_NamespaceStack* stack);
+void closeXMLNamespaceScope(XML_NamespaceStack* stack);
+
+int resolveXMLNodeNamespaces(XML_Node* n, XML_NamespaceStack* stack);
+XML_Node* getXMLNodeNS(char* path, XML_Node* root);
+
+
+#endif /* NAMESPACE_H_INCLUDED */
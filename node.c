@@ -9,11 +9,13 @@
  */
 
 #include <stdio.h>      /* printf() */
-#include <stdlib.h>     /* malloc(), realloc(), free() */
-#include <string.h>     /* strlen(), strcpy() */
+#include <stdlib.h>     /* malloc(), realloc(), free(), qsort() */
+#include <string.h>     /* strlen(), strcpy(), strcmp(), strncmp(), memcmp(), memmove() */
 
 #include "../log.h"     /* logError() */
-#include "attribute.h"  /* XML_Attribute */
+#include "error.h"      /* logXMLError() */
+#include "name.h"       /* internXMLName() */
+#include "attribute.h"  /* XML_Attribute, readXMLRawAttribute() */
 #include "tag.h"        /* XML_Tag */
 #include "node.h"
 
@@ -46,11 +48,28 @@ XML_Node* createXMLNode(void)
  */
 void destroyXMLNode(XML_Node* n)
 {
+   XML_Node* child;
+   int i;
+
    if(n == NULL) {
       logError("Trying to destroy a NULL node", __FILE__, __LINE__);
    }
+   else if(isXMLNodePooled(n)) {
+      logError("Trying to destroy a pooled node, freed with its pool", __FILE__, __LINE__);
+   }
    else {
-      /* destroy children */
+      /* destroy children, pooled ones being left to their pool */
+      if(isXMLNodeFrozen(n)) {
+         for(i = 0; i < n->cc; i++) {
+            child = getXMLChildren(n)[i];
+            if(!isXMLNodePooled(child)) {
+               child->parent = NULL;
+               destroyXMLNode(child);
+            }
+         }
+         n->cc = 0;
+         n->first = n->current = n->last = NULL;
+      }
       while(n->cc > 0) {
          destroyXMLNode(n->last);
       }
@@ -60,7 +79,12 @@ void destroyXMLNode(XML_Node* n)
          deleteXMLNodeFromParent(n);
       }
 
-      /* destroy other members */
+      /* destroy other members, unless a pool owns them */
+      if(isXMLNodeShared(n)) {
+         n->name = NULL;
+         n->value = NULL;
+         n->attr = NULL;
+      }
       if(n->name != NULL) {
          logMem(LOG_FREE, n->name, "string", "node name", __FILE__, __LINE__);
          free(n->name);
@@ -72,6 +96,7 @@ void destroyXMLNode(XML_Node* n)
       if(n->attr != NULL) {
          destroyXMLAttribute(n->attr);
       }
+      freeXMLNodeData(n);
 
       /* free node */
       logMem(LOG_FREE, n, "XML_Node", "node", __FILE__, __LINE__);
@@ -105,6 +130,7 @@ void freeXMLNode(XML_Node* n)
    else if((n->name != NULL) ||
            (n->value != NULL) ||
            (n->attr != NULL) ||
+           (n->data != NULL) ||
            (n->parent != NULL) ||
            (n->previous != NULL) ||
            (n->next != NULL) ||
@@ -136,6 +162,7 @@ void initXMLNode(XML_Node* n)
       n->name = NULL;
       n->value = NULL;
       n->attr = NULL;
+      n->data = NULL;
       n->parent = NULL;
       n->previous = NULL;
       n->next = NULL;
@@ -143,10 +170,173 @@ void initXMLNode(XML_Node* n)
       n->current = NULL;
       n->last = NULL;
       n->cc = 0;
+      n->id = XML_NO_NAME;
+   }
+}
+
+
+/**
+ * \brief Data of nodes without any, as read by getters.
+ */
+static const XML_NodeData defaultXMLNodeData = {
+   XML_NO_NAME, XML_NO_NAME, NULL, -1, -1, 0, NULL, 0, 0
+};
+
+/**
+ * \brief Data of pooled nodes without any other, shared by all of them.
+ * It's never written: getXMLNodeData() gives such a node its own copy.
+ */
+static XML_NodeData sharedXMLNodeData = {
+   XML_NO_NAME, XML_NO_NAME, NULL, -1, -1, 0, NULL, 1, 0
+};
+
+/**
+ * \brief Data of nodes themselves pooled, without any other, shared the same
+ * way.
+ */
+static XML_NodeData pooledXMLNodeData = {
+   XML_NO_NAME, XML_NO_NAME, NULL, -1, -1, 0, NULL, 2, 0
+};
+
+
+/**
+ * \brief Check if a node's data is its own, and not a shared one.
+ */
+static int hasXMLNodeOwnData(const XML_Node* n)
+{
+   return (n->data != NULL) && (n->data != &sharedXMLNodeData) &&
+          (n->data != &pooledXMLNodeData);
+}
+
+
+/**
+ * \brief Get a node's optional data, to modify it.
+ * Data is allocated on first call, so it's only called to store a value
+ * which isn't the default one.
+ *
+ * \param n  Node.
+ * \return   Node's own data, NULL if memory can't be allocated.
+ */
+XML_NodeData* getXMLNodeData(XML_Node* n)
+{
+   XML_NodeData* data;
+
+   if(n == NULL) {
+      logError("Trying to get data of a NULL node", __FILE__, __LINE__);
+      return NULL;
+   }
+   if(hasXMLNodeOwnData(n)) {
+      return n->data;
+   }
+
+   if((data = malloc(sizeof(XML_NodeData))) == NULL) {
+      logError("Can't allocate memory for node's data", __FILE__, __LINE__);
+      return NULL;
+   }
+   logMem(LOG_ALLOC, data, "XML_NodeData", "node data", __FILE__, __LINE__);
+   *data = (n->data == NULL) ? defaultXMLNodeData : *n->data;
+   n->data = data;
+
+   return data;
+}
+
+
+/**
+ * \brief Free a node's optional data, with its children arrays and undecoded
+ * attributes.
+ *
+ * \param n  Node, left without data.
+ */
+void freeXMLNodeData(XML_Node* n)
+{
+   if(n == NULL) {
+      logError("Trying to free data of a NULL node", __FILE__, __LINE__);
+   }
+   else if(hasXMLNodeOwnData(n)) {
+      if(n->data->rawAttr != NULL) {
+         logMem(LOG_FREE, n->data->rawAttr, "string", "node attributes", __FILE__, __LINE__);
+         free(n->data->rawAttr);
+      }
+      if(n->data->index != NULL) {
+         free(n->data->index->children);
+         free(n->data->index->byName);
+         logMem(LOG_FREE, n->data->index, "XML_NodeIndex", "node index", __FILE__, __LINE__);
+         free(n->data->index);
+      }
+      logMem(LOG_FREE, n->data, "XML_NodeData", "node data", __FILE__, __LINE__);
+      free(n->data);
+      n->data = NULL;
+   }
+   else {
+      n->data = NULL;
+   }
+}
+
+
+/**
+ * \brief Get a node's children arrays, to modify them.
+ *
+ * \param n  Node.
+ * \return   Node's arrays, allocated on first call, NULL if memory can't be
+ *           allocated.
+ */
+XML_NodeIndex* getXMLNodeIndex(XML_Node* n)
+{
+   XML_NodeData* data;
+
+   if((data = getXMLNodeData(n)) == NULL) {
+      return NULL;
+   }
+   if(data->index == NULL) {
+      if((data->index = malloc(sizeof(XML_NodeIndex))) == NULL) {
+         logError("Can't allocate memory for node's index", __FILE__, __LINE__);
+         return NULL;
+      }
+      logMem(LOG_ALLOC, data->index, "XML_NodeIndex", "node index", __FILE__, __LINE__);
+      data->index->children = NULL;
+      data->index->byName = NULL;
+      data->index->childrenLength = 0;
+      data->index->frozen = 0;
+   }
+
+   return data->index;
+}
+
+
+/**
+ * \brief Free a node's index once both its arrays are dropped.
+ */
+static void dropXMLNodeIndex(XML_Node* n)
+{
+   XML_NodeIndex* index;
+
+   index = n->data->index;
+   if((index->children == NULL) && (index->byName == NULL)) {
+      logMem(LOG_FREE, index, "XML_NodeIndex", "node index", __FILE__, __LINE__);
+      free(index);
+      n->data->index = NULL;
    }
 }
 
 
+/**
+ * \brief Get a node's children array, NULL if it isn't indexed.
+ */
+static XML_Node** findXMLNodeChildren(const XML_Node* n)
+{
+   return ((n->data != NULL) && (n->data->index != NULL)) ? n->data->index->children : NULL;
+}
+
+
+/**
+ * \brief Get a node's children sorted by name, NULL if they aren't.
+ */
+static XML_Node** findXMLNodeSortedChildren(const XML_Node* n)
+{
+   return ((n->data != NULL) && (n->data->index != NULL)) ? n->data->index->byName : NULL;
+}
+
+
 
 /**
  * \brief Set a node's name.
@@ -158,10 +348,22 @@ void initXMLNode(XML_Node* n)
  */
 void setXMLNodeName(const char* name, XML_Node* n)
 {
+   /* pooled contents are read-only, and parent's sorted children change */
+   if((n != NULL) && !isXMLNodePooled(n)) {
+      unshareXMLNode(n);
+      if(n->parent != NULL) {
+         unsortXMLNodeChildren(n->parent);
+      }
+   }
+
    /* NULL node */
    if(n == NULL) {
       logError("Giving a name to a NULL node", __FILE__, __LINE__);
    }
+   /* pooled node, standing for several subtrees */
+   else if(isXMLNodePooled(n)) {
+      logError("Giving a name to a pooled node", __FILE__, __LINE__);
+   }
    /* NULL node */
    else if(n == NULL) {
       logError("Giving a NULL name to a node", __FILE__, __LINE__);
@@ -173,6 +375,8 @@ void setXMLNodeName(const char* name, XML_Node* n)
       }
       else {
          strcpy(n->name, name);
+         n->id = internXMLName(name, strlen(name));
+         invalidateXMLNodeHash(n);
       }
    }
    /* node doesn't have a name */
@@ -183,6 +387,8 @@ void setXMLNodeName(const char* name, XML_Node* n)
       else {
          logMem(LOG_ALLOC, n->name, "string", "node name", __FILE__, __LINE__);
          strcpy(n->name, name);
+         n->id = internXMLName(name, strlen(name));
+         invalidateXMLNodeHash(n);
       }
    }
 }
@@ -198,10 +404,19 @@ void setXMLNodeName(const char* name, XML_Node* n)
  */
 void setXMLNodeValue(const char* value, XML_Node* n)
 {
+   /* pooled contents are read-only */
+   if((n != NULL) && !isXMLNodePooled(n)) {
+      unshareXMLNode(n);
+   }
+
    /* NULL node */
    if(n == NULL) {
       logError("Giving a value to a NULL node", __FILE__, __LINE__);
    }
+   /* pooled node, standing for several subtrees */
+   else if(isXMLNodePooled(n)) {
+      logError("Giving a value to a pooled node", __FILE__, __LINE__);
+   }
    /* NULL node */
    else if(n == NULL) {
       logError("Giving a NULL value to a node", __FILE__, __LINE__);
@@ -213,6 +428,7 @@ void setXMLNodeValue(const char* value, XML_Node* n)
       }
       else {
          strcpy(n->value, value);
+         invalidateXMLNodeHash(n);
       }
    }
    /* node doesn't have a value */
@@ -223,11 +439,148 @@ void setXMLNodeValue(const char* value, XML_Node* n)
       else {
          logMem(LOG_ALLOC, n->value, "string", "node value", __FILE__, __LINE__);
          strcpy(n->value, value);
+         invalidateXMLNodeHash(n);
+      }
+   }
+}
+
+
+/**
+ * \brief Get a node's namespace URI identifier.
+ *
+ * \param n  Node, whose namespaces are resolved.
+ * \return   Namespace's identifier, XML_NO_NAME if node has none.
+ */
+int getXMLNodeNamespace(const XML_Node* n)
+{
+   return (n->data == NULL) ? XML_NO_NAME : n->data->ns;
+}
+
+
+/**
+ * \brief Get a node's local name identifier.
+ *
+ * \param n  Node, whose namespaces are resolved.
+ * \return   Local name's identifier, node's name one if it isn't prefixed.
+ */
+int getXMLNodeLocalName(const XML_Node* n)
+{
+   return ((n->data == NULL) || (n->data->local == XML_NO_NAME)) ? n->id : n->data->local;
+}
+
+
+/**
+ * \brief Set a node's resolved namespace and local name.
+ * An unprefixed name without namespace doesn't allocate node's data.
+ *
+ * \param n      Resolved node.
+ * \param ns     Namespace URI identifier, XML_NO_NAME for none.
+ * \param local  Local name identifier.
+ */
+void setXMLNodeNamespace(XML_Node* n, int ns, int local)
+{
+   XML_NodeData* data;
+
+   if((getXMLNodeNamespace(n) != ns) || (getXMLNodeLocalName(n) != local)) {
+      if((data = getXMLNodeData(n)) != NULL) {
+         data->ns = ns;
+         data->local = local;
       }
    }
 }
 
 
+/**
+ * \brief Get a node's offset in its file, see XML_NodeData.
+ *
+ * \return  Node's offset, -1 if unknown.
+ */
+long getXMLNodeOffset(const XML_Node* n)
+{
+   return (n->data == NULL) ? -1 : n->data->offset;
+}
+
+
+/**
+ * \brief Get a node's length in its file, see XML_NodeData.
+ *
+ * \return  Node's length, -1 if unknown.
+ */
+long getXMLNodeLength(const XML_Node* n)
+{
+   return (n->data == NULL) ? -1 : n->data->length;
+}
+
+
+/**
+ * \brief Set a node's offset in its file, -1 if unknown.
+ */
+void setXMLNodeOffset(XML_Node* n, long offset)
+{
+   XML_NodeData* data;
+
+   if((getXMLNodeOffset(n) != offset) && ((data = getXMLNodeData(n)) != NULL)) {
+      data->offset = offset;
+   }
+}
+
+
+/**
+ * \brief Set a node's length in its file, -1 if unknown.
+ */
+void setXMLNodeLength(XML_Node* n, long length)
+{
+   XML_NodeData* data;
+
+   if((getXMLNodeLength(n) != length) && ((data = getXMLNodeData(n)) != NULL)) {
+      data->length = length;
+   }
+}
+
+
+/**
+ * \brief Check if a node's name, value and attributes are pooled.
+ */
+int isXMLNodeShared(const XML_Node* n)
+{
+   return (n->data != NULL) && n->data->shared;
+}
+
+
+/**
+ * \brief Mark a node's name, value and attributes as pooled, or as its own.
+ * Pooled nodes without other data share the same one, so pooling doesn't
+ * allocate anything per node.
+ *
+ * \param n       Node.
+ * \param shared  1 if node's contents are pooled, 2 if node itself is, 0 if
+ *                they are its own.
+ */
+void setXMLNodeShared(XML_Node* n, int shared)
+{
+   if(n == NULL) {
+      logError("Trying to share a NULL node", __FILE__, __LINE__);
+   }
+   else if(!hasXMLNodeOwnData(n)) {
+      n->data = (shared == 2) ? &pooledXMLNodeData : shared ? &sharedXMLNodeData : NULL;
+   }
+   else {
+      n->data->shared = shared;
+   }
+}
+
+
+/**
+ * \brief Check if a node itself is pooled, see poolXMLNode().
+ * Such a node stands for identical subtrees of several parents: it has no
+ * parent nor siblings, and it's read-only.
+ */
+int isXMLNodePooled(const XML_Node* n)
+{
+   return (n->data != NULL) && (n->data->shared == 2);
+}
+
+
 /**
  * \brief Add an attribute to a XML node.
  *
@@ -236,20 +589,30 @@ void setXMLNodeValue(const char* value, XML_Node* n)
  */
 void addAttributeToXMLNode(XML_Attribute* attr, XML_Node* n)
 {
+   /* pooled contents are read-only */
+   if((n != NULL) && !isXMLNodePooled(n)) {
+      unshareXMLNode(n);
+   }
+
    if(n == NULL) {
       logError("Trying to add an attribute to a NULL tag", __FILE__, __LINE__);
    }
+   else if(isXMLNodePooled(n)) {
+      logError("Trying to add an attribute to a pooled node", __FILE__, __LINE__);
+   }
    else if(n == NULL) {
       logError("Trying to add a NULL attribute to a tag", __FILE__, __LINE__);
    }
    /* no attribute in node */
    else if(n->attr == NULL) {
       n->attr = attr;
+      invalidateXMLNodeHash(n);
    }
    /* one or more attributes in node */
    else {
       attr->next = n->attr;
       n->attr = attr;
+      invalidateXMLNodeHash(n);
    }
 }
 
@@ -266,6 +629,11 @@ XML_Attribute* deleteAttributeFromXMLNode(XML_Node* n)
 {
    XML_Attribute* deleted;
 
+   /* undecoded attributes are deleted too */
+   if(n != NULL) {
+      decodeXMLNodeAttributes(n);
+   }
+
    deleted = NULL;
    if(n == NULL) {
       logError("Trying to delete an attribute from a NULL node",
@@ -274,16 +642,198 @@ XML_Attribute* deleteAttributeFromXMLNode(XML_Node* n)
    else if(n->attr == NULL) {
       logError("Nothing to delete in node", __FILE__, __LINE__);
    }
+   else if(isXMLNodePooled(n)) {
+      logError("Trying to delete an attribute from a pooled node", __FILE__, __LINE__);
+   }
    else {
+      unshareXMLNode(n);
       deleted = n->attr;
       n->attr = deleted->next;
       deleted->next = NULL;
+      invalidateXMLNodeHash(n);
    }
 
    return deleted;
 }
 
 
+/**
+ * \brief Find a decoded attribute by name.
+ */
+static XML_Attribute* findXMLNodeAttribute(XML_Node* n, const char* name, size_t length)
+{
+   XML_Attribute* attr;
+
+   for(attr = n->attr; attr != NULL; attr = attr->next) {
+      if((strncmp(attr->name, name, length) == 0) && (attr->name[length] == '\0')) {
+         return attr;
+      }
+   }
+
+   return NULL;
+}
+
+
+/**
+ * \brief Get a node's attribute by name.
+ * An attribute kept undecoded while parsing is decoded on its first lookup,
+ * and added to the node: nodes with undecoded attributes mustn't be read by
+ * several threads, see XML_FLAT_ATTRIBUTES.
+ *
+ * \param     n     Searched node.
+ * \param[in] name  Attribute's name.
+ * \return          Found attribute, NULL if node has no such attribute.
+ */
+XML_Attribute* getXMLNodeAttribute(XML_Node* n, const char* name)
+{
+   const char *p, *rawName, *value;
+   size_t length, nameLength, valueLength;
+   XML_Attribute* attr;
+   char* raw;
+
+   if((n == NULL) || (name == NULL)) {
+      logError("Trying to get an attribute of a NULL node, or a NULL name",
+               __FILE__, __LINE__);
+      return NULL;
+   }
+
+   length = strlen(name);
+   raw = (n->data == NULL) ? NULL : n->data->rawAttr;
+   if(((attr = findXMLNodeAttribute(n, name, length)) != NULL) || (raw == NULL)) {
+      return attr;
+   }
+   for(p = raw; (p = readXMLRawAttribute(p, &rawName, &nameLength, &value,
+                                                &valueLength)) != NULL; ) {
+      if((nameLength == length) && (memcmp(rawName, name, length) == 0)) {
+         if((attr = createXMLRawAttribute(rawName, nameLength, value, valueLength)) != NULL) {
+            attr->next = n->attr;
+            n->attr = attr;
+         }
+         return attr;
+      }
+   }
+
+   return NULL;
+}
+
+
+/**
+ * \brief Decode a node's attributes kept undecoded while parsing.
+ * Functions reading all attributes of a node call it first. Decoding doesn't
+ * change node's contents, so its hash is kept.
+ *
+ * \param n  Decoded node.
+ */
+void decodeXMLNodeAttributes(XML_Node* n)
+{
+   const char *p, *name, *value;
+   size_t nameLength, valueLength;
+   XML_Attribute* attr;
+
+   if((n == NULL) || (n->data == NULL) || (n->data->rawAttr == NULL)) {
+      return;
+   }
+
+   for(p = n->data->rawAttr; (p = readXMLRawAttribute(p, &name, &nameLength, &value,
+                                                &valueLength)) != NULL; ) {
+      if((findXMLNodeAttribute(n, name, nameLength) == NULL) &&
+         ((attr = createXMLRawAttribute(name, nameLength, value, valueLength)) != NULL)) {
+         attr->next = n->attr;
+         n->attr = attr;
+      }
+   }
+   logMem(LOG_FREE, n->data->rawAttr, "string", "node attributes", __FILE__, __LINE__);
+   free(n->data->rawAttr);
+   n->data->rawAttr = NULL;
+}
+
+
+/**
+ * \brief Find a child's index in its parent's children array.
+ * Last children are checked first, as they are the most often added or
+ * deleted.
+ *
+ * \return  Child's index, -1 if parent has no children array or child isn't
+ *          in it.
+ */
+static int findXMLNodeChildIndex(XML_Node* parent, XML_Node* child)
+{
+   XML_Node** children;
+   int i;
+
+   if((children = findXMLNodeChildren(parent)) == NULL) {
+      return -1;
+   }
+   for(i = parent->cc - 1; (i >= 0) && (children[i] != child); i--);
+
+   return i;
+}
+
+
+/**
+ * \brief Insert a child in its parent's children array, if it has one.
+ * Parent's children count must already include it. If the array can't grow,
+ * it's dropped, and built again on next access, unless parent is frozen.
+ *
+ * \return  1 on success, 0 if a frozen parent's array can't grow.
+ */
+static int insertXMLNodeChildAt(XML_Node* parent, int index, XML_Node* child)
+{
+   XML_NodeIndex* nodeIndex;
+   XML_Node** children;
+   int length;
+
+   if((findXMLNodeChildren(parent) == NULL) || (index < 0)) {
+      return 1;
+   }
+   nodeIndex = parent->data->index;
+   if(parent->cc > nodeIndex->childrenLength) {
+      length = 2 * nodeIndex->childrenLength;
+      if((children = realloc(nodeIndex->children, length * sizeof(XML_Node*))) == NULL) {
+         if(nodeIndex->frozen) {
+            logError("Can't reallocate memory for children array", __FILE__, __LINE__);
+            return 0;
+         }
+         unindexXMLNodeChildren(parent);
+         return 1;
+      }
+      nodeIndex->children = children;
+      nodeIndex->childrenLength = length;
+   }
+   memmove(&nodeIndex->children[index + 1], &nodeIndex->children[index],
+           (parent->cc - 1 - index) * sizeof(XML_Node*));
+   nodeIndex->children[index] = child;
+
+   return 1;
+}
+
+
+/**
+ * \brief Delete a child from its parent's children array, if it has one.
+ * Parent's children count must still include it.
+ */
+static void deleteXMLNodeChildAt(XML_Node* parent, int index)
+{
+   XML_Node** children;
+
+   if(((children = findXMLNodeChildren(parent)) != NULL) && (index >= 0)) {
+      memmove(&children[index], &children[index + 1],
+              (parent->cc - 1 - index) * sizeof(XML_Node*));
+   }
+}
+
+
+/**
+ * \brief Set a frozen node's first, current and last children from its array.
+ */
+static void linkXMLFrozenChildren(XML_Node* n)
+{
+   n->first = (n->cc > 0) ? n->data->index->children[0] : NULL;
+   n->current = n->first;
+   n->last = (n->cc > 0) ? n->data->index->children[n->cc - 1] : NULL;
+}
+
+
 void addXMLNodeToParent(XML_Node* parent, XML_Node* child)
 {
    if(parent == NULL) {
@@ -298,6 +848,22 @@ void addXMLNodeToParent(XML_Node* parent, XML_Node* child)
    else if((child->previous != NULL) || (child->next != NULL)) {
       logError("Child node already has siblings", __FILE__, __LINE__);
    }
+   else if(isXMLNodePooled(parent) || isXMLNodePooled(child)) {
+      logError("Trying to link a pooled node", __FILE__, __LINE__);
+   }
+   else if(isXMLNodeFrozen(parent)) {
+      /* frozen parent's children are only in its array */
+      parent->cc++;
+      if(!insertXMLNodeChildAt(parent, parent->cc - 1, child)) {
+         parent->cc--;
+      }
+      else {
+         child->parent = parent;
+         linkXMLFrozenChildren(parent);
+         unsortXMLNodeChildren(parent);
+         invalidateXMLNodeHash(parent);
+      }
+   }
    else {
       child->parent = parent;
       parent->cc++;
@@ -313,12 +879,84 @@ void addXMLNodeToParent(XML_Node* parent, XML_Node* child)
          child->previous = parent->last;
          parent->last = child;
       }
+      insertXMLNodeChildAt(parent, parent->cc - 1, child);
+      unsortXMLNodeChildren(parent);
+      invalidateXMLNodeHash(parent);
+   }
+}
+
+
+/**
+ * \brief Add a child node to a parent, before one of its children.
+ *
+ * \param sibling  Parent's child, before which \p child is added.
+ * \param child    Added node, without parent nor siblings.
+ */
+void insertXMLNodeBefore(XML_Node* sibling, XML_Node* child)
+{
+   int index;
+
+   if(sibling == NULL) {
+      logError("Trying to insert a node before a NULL sibling", __FILE__, __LINE__);
+   }
+   else if(sibling->parent == NULL) {
+      logError("Trying to insert a node before a node without parent",
+               __FILE__, __LINE__);
+   }
+   else if(child == NULL) {
+      logError("Trying to insert a NULL child node", __FILE__, __LINE__);
+   }
+   else if(child->parent != NULL) {
+      logError("Child node already has a parent", __FILE__, __LINE__);
+   }
+   else if((child->previous != NULL) || (child->next != NULL)) {
+      logError("Child node already has siblings", __FILE__, __LINE__);
+   }
+   else if(isXMLNodePooled(child)) {
+      logError("Trying to link a pooled node", __FILE__, __LINE__);
+   }
+   else if(isXMLNodeFrozen(sibling->parent)) {
+      /* frozen parent's children are only in its array */
+      index = findXMLNodeChildIndex(sibling->parent, sibling);
+      sibling->parent->cc++;
+      if((index < 0) || !insertXMLNodeChildAt(sibling->parent, index, child)) {
+         sibling->parent->cc--;
+      }
+      else {
+         child->parent = sibling->parent;
+         linkXMLFrozenChildren(child->parent);
+         unsortXMLNodeChildren(child->parent);
+         invalidateXMLNodeHash(child->parent);
+      }
+   }
+   else {
+      /* an array missing the sibling is stale, it's dropped */
+      if((index = findXMLNodeChildIndex(sibling->parent, sibling)) < 0) {
+         unindexXMLNodeChildren(sibling->parent);
+      }
+      child->parent = sibling->parent;
+      sibling->parent->cc++;
+      child->previous = sibling->previous;
+      child->next = sibling;
+      /* sibling was parent's first node */
+      if(sibling->previous == NULL) {
+         sibling->parent->first = child;
+      }
+      else {
+         sibling->previous->next = child;
+      }
+      sibling->previous = child;
+      insertXMLNodeChildAt(child->parent, index, child);
+      unsortXMLNodeChildren(child->parent);
+      invalidateXMLNodeHash(child->parent);
    }
 }
 
 
 void deleteXMLNodeFromParent(XML_Node* child)
 {
+   int index;
+
    if(child == NULL) {
       logError("Trying to delete a NULL node from its parent",
                __FILE__, __LINE__);
@@ -327,7 +965,24 @@ void deleteXMLNodeFromParent(XML_Node* child)
       logError("Node doesn't have parent and can't be deleted",
                __FILE__, __LINE__);
    }
+   else if(isXMLNodeFrozen(child->parent)) {
+      /* frozen parent's children are only in its array */
+      invalidateXMLNodeHash(child->parent);
+      if((index = findXMLNodeChildIndex(child->parent, child)) >= 0) {
+         deleteXMLNodeChildAt(child->parent, index);
+         unsortXMLNodeChildren(child->parent);
+         child->parent->cc--;
+         linkXMLFrozenChildren(child->parent);
+      }
+      child->parent = NULL;
+   }
    else {
+      invalidateXMLNodeHash(child->parent);
+      if((index = findXMLNodeChildIndex(child->parent, child)) < 0) {
+         unindexXMLNodeChildren(child->parent);
+      }
+      deleteXMLNodeChildAt(child->parent, index);
+      unsortXMLNodeChildren(child->parent);
       /* decrement parent's child count */
       (child->parent->cc)--;
       /* remove reference from parent first node */
@@ -364,8 +1019,411 @@ void deleteXMLNodeFromParent(XML_Node* child)
 }
 
 
+/**
+ * \brief Build a node's children array.
+ * Children can then be accessed by index in constant time. The array is kept
+ * up to date by this file's functions, until unindexXMLNodeChildren() is
+ * called.
+ *
+ * \param n  Indexed node.
+ * \return   1 on success, 0 if an error happened.
+ */
+int indexXMLNodeChildren(XML_Node* n)
+{
+   XML_NodeIndex* index;
+   XML_Node* child;
+   int i;
+
+   if(n == NULL) {
+      logError("Trying to index children of a NULL node", __FILE__, __LINE__);
+      return 0;
+   }
+   if((findXMLNodeChildren(n) != NULL) || (n->cc == 0)) {
+      return 1;
+   }
+
+   if((index = getXMLNodeIndex(n)) == NULL) {
+      return 0;
+   }
+   if((index->children = malloc(n->cc * sizeof(XML_Node*))) == NULL) {
+      logError("Can't allocate memory for children array", __FILE__, __LINE__);
+      dropXMLNodeIndex(n);
+      return 0;
+   }
+   index->childrenLength = n->cc;
+   for(child = n->first, i = 0; child != NULL; child = child->next, i++) {
+      index->children[i] = child;
+   }
+
+   return 1;
+}
+
+
+/**
+ * \brief Free a node's children array.
+ * A frozen node keeps it, as its children are only linked through it.
+ *
+ * \param n  Node, which children are only linked afterwards.
+ */
+void unindexXMLNodeChildren(XML_Node* n)
+{
+   if(n == NULL) {
+      logError("Trying to unindex children of a NULL node", __FILE__, __LINE__);
+   }
+   else if(isXMLNodeFrozen(n)) {
+      logError("Trying to unindex children of a frozen node", __FILE__, __LINE__);
+   }
+   else if(findXMLNodeChildren(n) != NULL) {
+      free(n->data->index->children);
+      n->data->index->children = NULL;
+      n->data->index->childrenLength = 0;
+      dropXMLNodeIndex(n);
+   }
+}
+
+
+/**
+ * \brief Link a node's children through its children array only.
+ * Their siblings links are cleared, so a child can then be replaced by a node
+ * that several parents share, see replaceXMLNodeChild(). This file's functions
+ * keep the array up to date, and children are iterated with
+ * getXMLNextChild().
+ *
+ * \param n  Frozen node.
+ * \return   1 on success, 0 if an error happened.
+ */
+int freezeXMLNodeChildren(XML_Node* n)
+{
+   XML_Node** children;
+   int i;
+
+   if(n == NULL) {
+      logError("Trying to freeze children of a NULL node", __FILE__, __LINE__);
+      return 0;
+   }
+   if((n->cc == 0) || isXMLNodeFrozen(n)) {
+      return 1;
+   }
+   if(!indexXMLNodeChildren(n)) {
+      return 0;
+   }
+
+   children = n->data->index->children;
+   for(i = 0; i < n->cc; i++) {
+      children[i]->previous = children[i]->next = NULL;
+   }
+   n->data->index->frozen = 1;
+   linkXMLFrozenChildren(n);
+
+   return 1;
+}
+
+
+/**
+ * \brief Check if a node's children are only linked through its array.
+ */
+int isXMLNodeFrozen(const XML_Node* n)
+{
+   return (n->data != NULL) && (n->data->index != NULL) && n->data->index->frozen;
+}
+
+
+/**
+ * \brief Replace a frozen node's child.
+ * Replaced child is only unlinked. New one gets \p n as parent, unless it's
+ * pooled, as it then has several.
+ *
+ * \param n      Frozen parent.
+ * \param i      Replaced child's index.
+ * \param child  New child, without parent.
+ */
+void replaceXMLNodeChild(XML_Node* n, int i, XML_Node* child)
+{
+   XML_Node** children;
+
+   if((n == NULL) || (child == NULL) || !isXMLNodeFrozen(n)) {
+      logError("Trying to replace a child of a NULL or not frozen node, or by a NULL one",
+               __FILE__, __LINE__);
+   }
+   else if((i < 0) || (i >= n->cc)) {
+      logError("Trying to replace a child out of node's children", __FILE__, __LINE__);
+   }
+   else {
+      children = n->data->index->children;
+      if(children[i]->parent == n) {
+         children[i]->parent = NULL;
+      }
+      children[i] = child;
+      if(!isXMLNodePooled(child)) {
+         child->parent = n;
+      }
+      linkXMLFrozenChildren(n);
+      unsortXMLNodeChildren(n);
+      invalidateXMLNodeHash(n);
+   }
+}
+
+
+/**
+ * \brief Get a node's child by index.
+ * Takes constant time once node is indexed by indexXMLNodeChildren(), or by
+ * flattenXMLFile() with XML_FLAT_CHILDREN, else children are walked. Node
+ * is never modified, so any number of threads can read it.
+ *
+ * \param n  Parent node.
+ * \param i  Child's index, from 0 to n->cc - 1.
+ * \return   Child, NULL if there is no such child or an error happened.
+ */
+XML_Node* getXMLChildAt(XML_Node* n, int i)
+{
+   XML_Node *child, **children;
+
+   if(n == NULL) {
+      logError("Trying to get a child of a NULL node", __FILE__, __LINE__);
+      return NULL;
+   }
+   if((i < 0) || (i >= n->cc)) {
+      return NULL;
+   }
+   if((children = findXMLNodeChildren(n)) != NULL) {
+      return children[i];
+   }
+
+   for(child = n->first; (child != NULL) && (i > 0); child = child->next, i--);
+
+   return child;
+}
+
+
+/**
+ * \brief Get an indexed node's children as a contiguous array.
+ * Array holds n->cc children, in order. It's only built by
+ * indexXMLNodeChildren() or flattenXMLFile() with XML_FLAT_CHILDREN, never
+ * while reading. Any range of it can be iterated directly, or split between
+ * threads:
+ * \code
+ * children = getXMLChildren(n);
+ * for(i = from; i < to; i++) {
+ *    process(children[i]);
+ * }
+ * \endcode
+ * The array is invalidated by adding or deleting a child of \p n.
+ *
+ * \param n  Parent node.
+ * \return   Children array, NULL if node has no children, isn't indexed or an
+ *           error happened.
+ */
+XML_Node** getXMLChildren(XML_Node* n)
+{
+   if(n == NULL) {
+      logError("Trying to get children of a NULL node", __FILE__, __LINE__);
+      return NULL;
+   }
+
+   return findXMLNodeChildren(n);
+}
+
+
+/**
+ * \brief Get the child following another one.
+ * Children array is followed when node has one, as nodes of persistent
+ * versions are only linked through it. Iterating a node's children:
+ * \code
+ * for(i = 0, child = n->first; child != NULL; child = getXMLNextChild(n, child, i++)) {
+ *    process(child);
+ * }
+ * \endcode
+ *
+ * \param n      Parent node.
+ * \param child  Current child.
+ * \param i      Current child's index.
+ * \return       Next child, NULL after the last one.
+ */
+XML_Node* getXMLNextChild(XML_Node* n, XML_Node* child, int i)
+{
+   XML_Node** children;
+
+   if((children = findXMLNodeChildren(n)) != NULL) {
+      return (i + 1 < n->cc) ? children[i + 1] : NULL;
+   }
+
+   return child->next;
+}
+
+
+/**
+ * \brief A child and its position, sorted by sortXMLNodeChildren().
+ */
+typedef struct XML_NodeSortKey {
+   XML_Node* node;   /**< Child. */
+   int index;        /**< Child's position among its siblings. */
+} XML_NodeSortKey;
+
+
+/**
+ * \brief Compare two children by name, then by position.
+ */
+static int compareXMLNodeSortKeys(const void* a, const void* b)
+{
+   const XML_NodeSortKey *x, *y;
+   int cmp;
+
+   x = a;
+   y = b;
+   if((cmp = strcmp(x->node->name, y->node->name)) == 0) {
+      cmp = (x->index > y->index) - (x->index < y->index);
+   }
+
+   return cmp;
+}
+
+
+/**
+ * \brief Sort a node's children by name, for read-only trees.
+ * Children with the same name stay in document order. Looking a child up by
+ * name is then a binary search, without any shared table to lock. Adding,
+ * deleting or renaming a child drops the sorted array.
+ *
+ * \param n  Sorted node.
+ * \return   1 on success, 0 if an error happened.
+ */
+int sortXMLNodeChildren(XML_Node* n)
+{
+   XML_NodeSortKey* keys;
+   XML_NodeIndex* index;
+   XML_Node* child;
+   int i;
+
+   if(n == NULL) {
+      logError("Trying to sort children of a NULL node", __FILE__, __LINE__);
+      return 0;
+   }
+   if((findXMLNodeSortedChildren(n) != NULL) || (n->cc == 0)) {
+      return 1;
+   }
+   for(i = 0, child = n->first; child != NULL; child = getXMLNextChild(n, child, i++)) {
+      if(child->name == NULL) {
+         logError("Trying to sort children without name", __FILE__, __LINE__);
+         return 0;
+      }
+   }
+
+   if((index = getXMLNodeIndex(n)) == NULL) {
+      return 0;
+   }
+   keys = malloc(n->cc * sizeof(XML_NodeSortKey));
+   index->byName = malloc(n->cc * sizeof(XML_Node*));
+   if((keys == NULL) || (index->byName == NULL)) {
+      logError("Can't allocate memory for sorted children", __FILE__, __LINE__);
+      free(keys);
+      free(index->byName);
+      index->byName = NULL;
+      dropXMLNodeIndex(n);
+      return 0;
+   }
+
+   for(i = 0, child = n->first; child != NULL; child = getXMLNextChild(n, child, i++)) {
+      keys[i].node = child;
+      keys[i].index = i;
+   }
+   qsort(keys, n->cc, sizeof(XML_NodeSortKey), compareXMLNodeSortKeys);
+   for(i = 0; i < n->cc; i++) {
+      index->byName[i] = keys[i].node;
+   }
+   free(keys);
+
+   return 1;
+}
+
+
+/**
+ * \brief Free a node's sorted children.
+ *
+ * \param n  Node, which children are only linked afterwards.
+ */
+void unsortXMLNodeChildren(XML_Node* n)
+{
+   if(n == NULL) {
+      logError("Trying to unsort children of a NULL node", __FILE__, __LINE__);
+   }
+   else if(findXMLNodeSortedChildren(n) != NULL) {
+      free(n->data->index->byName);
+      n->data->index->byName = NULL;
+      dropXMLNodeIndex(n);
+   }
+}
+
+
+/**
+ * \brief Get a node's children sorted by sortXMLNodeChildren().
+ *
+ * \param n  Parent node.
+ * \return   Children sorted by name, NULL if node isn't sorted or an error
+ *           happened.
+ */
+XML_Node** getXMLSortedChildren(XML_Node* n)
+{
+   if(n == NULL) {
+      logError("Trying to get sorted children of a NULL node", __FILE__, __LINE__);
+      return NULL;
+   }
+
+   return findXMLNodeSortedChildren(n);
+}
+
+
+/**
+ * \brief Get a sorted node's children with a given name.
+ *
+ * \param      n      Parent node, sorted by sortXMLNodeChildren().
+ * \param[in]  name   Children's name.
+ * \param[out] count  Number of children with this name.
+ * \return            Children with this name, contiguous and in document
+ *                    order, NULL if there is none or node isn't sorted.
+ */
+XML_Node** getXMLChildrenByName(XML_Node* n, const char* name, int* count)
+{
+   XML_Node** byName;
+   int low, high, middle, first;
+
+   *count = 0;
+   if((n == NULL) || (name == NULL) || ((byName = findXMLNodeSortedChildren(n)) == NULL)) {
+      return NULL;
+   }
+
+   /* first child with this name, then first with a greater one */
+   low = 0;
+   high = n->cc;
+   while(low < high) {
+      middle = (low + high) / 2;
+      if(strcmp(byName[middle]->name, name) < 0) {
+         low = middle + 1;
+      }
+      else {
+         high = middle;
+      }
+   }
+   first = low;
+   high = n->cc;
+   while(low < high) {
+      middle = (low + high) / 2;
+      if(strcmp(byName[middle]->name, name) <= 0) {
+         low = middle + 1;
+      }
+      else {
+         high = middle;
+      }
+   }
+   *count = low - first;
+
+   return (*count > 0) ? &byName[first] : NULL;
+}
+
+
 void initXMLNodeFromXMLTag(XML_Node* n, XML_Tag* tag)
 {
+   XML_NodeData* data;
+
    if(n == NULL) {
       logError("Trying to initialize a NULL node", __FILE__, __LINE__);
    }
@@ -378,6 +1436,102 @@ void initXMLNodeFromXMLTag(XML_Node* n, XML_Tag* tag)
       while(tag->attr != NULL) {
          addAttributeToXMLNode(deleteAttributeFromXMLTag(tag), n);
       }
+      /* tag keeps its bytes if data can't be allocated */
+      if((tag->raw != NULL) && ((data = getXMLNodeData(n)) != NULL)) {
+         data->rawAttr = tag->raw;
+         tag->raw = NULL;
+      }
+   }
+}
+
+
+/**
+ * \brief Copy a subtree.
+ * Copy has no parent, and isn't linked to a file's bytes anymore.
+ *
+ * \param n  Copied subtree's root.
+ * \return   Copy, NULL if \p n is NULL.
+ */
+XML_Node* copyXMLNode(XML_Node* n)
+{
+   XML_Node *copy, *child;
+   XML_Attribute *attr, **tail;
+   XML_NodeData* data;
+   int i;
+
+   if(n == NULL) {
+      logError("Trying to copy a NULL node", __FILE__, __LINE__);
+      return NULL;
+   }
+
+   copy = createXMLNode();
+   if(n->name != NULL) {
+      setXMLNodeName(n->name, copy);
+   }
+   if(n->value != NULL) {
+      setXMLNodeValue(n->value, copy);
+   }
+   setXMLNodeNamespace(copy, getXMLNodeNamespace(n), getXMLNodeLocalName(n));
+
+   /* keep attributes' order */
+   decodeXMLNodeAttributes(n);
+   tail = &copy->attr;
+   for(attr = n->attr; attr != NULL; attr = attr->next) {
+      *tail = createXMLAttribute();
+      copyXMLAttribute(*tail, attr);
+      tail = &(*tail)->next;
+   }
+
+   for(i = 0, child = n->first; child != NULL; child = getXMLNextChild(n, child, i++)) {
+      addXMLNodeToParent(copy, copyXMLNode(child));
+   }
+   if((n->data != NULL) && (n->data->hash != 0) && ((data = getXMLNodeData(copy)) != NULL)) {
+      data->hash = n->data->hash;
+   }
+
+   return copy;
+}
+
+
+/**
+ * \brief Give a node its own copies of pooled name, value and attributes.
+ * Modifying functions of this file already call it; it's only needed before
+ * changing an attribute in place. A pooled node can't be given its own
+ * contents, as it stands for several subtrees: it's copied by copyXMLNode().
+ *
+ * \param n  Node that will be modified.
+ */
+void unshareXMLNode(XML_Node* n)
+{
+   XML_Attribute *attr, *pooled, **tail;
+   char *name, *value;
+
+   if(n == NULL) {
+      logError("Trying to unshare a NULL node", __FILE__, __LINE__);
+   }
+   else if(isXMLNodePooled(n)) {
+      logError("Trying to unshare a pooled node, which must be copied", __FILE__, __LINE__);
+   }
+   else if(isXMLNodeShared(n)) {
+      name = n->name;
+      value = n->value;
+      pooled = n->attr;
+      n->name = n->value = NULL;
+      n->attr = NULL;
+      setXMLNodeShared(n, 0);
+
+      if(name != NULL) {
+         setXMLNodeName(name, n);
+      }
+      if(value != NULL) {
+         setXMLNodeValue(value, n);
+      }
+      tail = &n->attr;
+      for(attr = pooled; attr != NULL; attr = attr->next) {
+         *tail = createXMLAttribute();
+         copyXMLAttribute(*tail, attr);
+         tail = &(*tail)->next;
+      }
    }
 }
 
@@ -396,6 +1550,7 @@ void printXMLNode(XML_Node* n, int mode)
 {
    XML_Attribute* current;
    XML_Node* child;
+   int i;
 
    if(n == NULL) {
       logError("Trying to print a NULL node", __FILE__, __LINE__);
@@ -403,6 +1558,7 @@ void printXMLNode(XML_Node* n, int mode)
    else {
       printf("<%s", n->name);
       /* printing attributes */
+      decodeXMLNodeAttributes(n);
       current = n->attr;
       while(current != NULL) {
          printf(" %s=\"%s\"", current->name, current->value);
@@ -427,9 +1583,10 @@ void printXMLNode(XML_Node* n, int mode)
             printf(">\n");
          }
          child = n->first;
+         i = 0;
          while(child != NULL) {
             printXMLNode(child, 2);
-            child = child->next;
+            child = getXMLNextChild(n, child, i++);
          }
          printf("</%s>\n", n->name);
       }
@@ -437,24 +1594,27 @@ void printXMLNode(XML_Node* n, int mode)
 }
 
 
-void readXMLNodeValue(XML_Node* n, FILE* file){
+long readXMLNodeValue(XML_Node* n, FILE* file){
    char strBuffer[XML_BUFFER_LENGTH];
    int charBuffer;
    int i, reading;
+   long length;
 
    /* reaches first useful character */
    i = 0;
+   length = 0;
    do{
       charBuffer = fgetc(file);
+      length++;
 
       /* reached end of file, that's not good */
       if(charBuffer == EOF){
-         logError("Reached EOF while reading a node's value", __FILE__, __LINE__);
-         return;
+         logXMLError("Reached EOF while reading a node's value", file);
+         return length - 1;
       }
       /* found a tag, stop reading */
       else if((char)charBuffer == '<'){
-         return;
+         return length;
       }
       /* found a compatible character */
       else if(((char)charBuffer >= '!') && ((char)charBuffer <= '~')){
@@ -467,11 +1627,12 @@ void readXMLNodeValue(XML_Node* n, FILE* file){
    reading = 1;
    do{
       charBuffer = fgetc(file);
+      length++;
 
       /* reached end of file, that's not good */
       if(charBuffer == EOF){
-         logError("Reached EOF while reading a node's value", __FILE__, __LINE__);
-         return;
+         logXMLError("Reached EOF while reading a node's value", file);
+         return length - 1;
       }
       /* end of value, stop reading */
       else if(((char)charBuffer == '<') ||
@@ -489,4 +1650,99 @@ void readXMLNodeValue(XML_Node* n, FILE* file){
    /* stop reading and copy string */
    strBuffer[i] = '\0';
    setXMLNodeValue(strBuffer, n);
+
+   return length;
+}
+
+
+/**
+ * \brief Mix bits of a hash, so close inputs give unrelated outputs.
+ */
+static unsigned long long mixXMLHash(unsigned long long h)
+{
+   h ^= h >> 33;
+   h *= 0xff51afd7ed558ccdULL;
+   h ^= h >> 33;
+   h *= 0xc4ceb9fe1a85ec53ULL;
+   h ^= h >> 33;
+
+   return h;
+}
+
+
+/**
+ * \brief Hash a string that may be NULL.
+ */
+static unsigned long long hashXMLNodeString(const char* str)
+{
+   return (str == NULL) ? 0 : hashXMLString(str, strlen(str));
+}
+
+
+/**
+ * \brief Get the hash of a subtree.
+ * It covers node's name, value, attributes and children's hashes, so two
+ * subtrees with the same hash are equal with high probability. Attributes'
+ * order doesn't matter, children's does. Hash is computed on first call and
+ * kept until the subtree is modified.
+ *
+ * \param n  Hashed subtree's root.
+ * \return   Subtree's hash, never 0.
+ */
+unsigned long long getXMLNodeHash(XML_Node* n)
+{
+   XML_Attribute* attr;
+   XML_NodeData* data;
+   XML_Node* child;
+   unsigned long long h, attributes;
+   int i;
+
+   if(n == NULL) {
+      logError("Trying to hash a NULL node", __FILE__, __LINE__);
+      return 0;
+   }
+   if((n->data != NULL) && (n->data->hash != 0)) {
+      return n->data->hash;
+   }
+
+   h = mixXMLHash(hashXMLNodeString(n->name) ^
+                  mixXMLHash(hashXMLNodeString(n->value)));
+
+   /* sum is independent of attributes' order */
+   decodeXMLNodeAttributes(n);
+   attributes = 0;
+   for(attr = n->attr; attr != NULL; attr = attr->next) {
+      attributes += mixXMLHash(hashXMLNodeString(attr->name) ^
+                               mixXMLHash(hashXMLNodeString(attr->value)));
+   }
+   h = mixXMLHash(h ^ attributes);
+
+   for(i = 0, child = n->first; child != NULL; child = getXMLNextChild(n, child, i++)) {
+      h = mixXMLHash(h * 0x100000001b3ULL ^ getXMLNodeHash(child));
+   }
+
+   /* hash is still given if it can't be kept */
+   h = (h == 0) ? 1 : h;
+   if((data = getXMLNodeData(n)) != NULL) {
+      data->hash = h;
+   }
+
+   return h;
+}
+
+
+/**
+ * \brief Forget hashes of a modified node and its ancestors.
+ * Modifying functions of this file already call it; it's only needed after
+ * changing an attribute in place.
+ *
+ * \param n  Modified node.
+ */
+void invalidateXMLNodeHash(XML_Node* n)
+{
+   /* a node is hashed only once its descendants are */
+   while((n != NULL) && (n->data != NULL) && (n->data->hash != 0)) {
+      n->data->hash = 0;
+      n = n->parent;
+   }
 }
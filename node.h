@@ -17,16 +17,60 @@
 #include "tag.h"        /* XML_Tag member in XML_Node structure */
 
 
+typedef struct XML_Node XML_Node;
+
+
+/**
+ * \struct XML_NodeIndex
+ * \brief A node's children arrays, for frozen or persistent trees.
+ */
+typedef struct XML_NodeIndex
+{
+   XML_Node** children;    /**< Children by index, NULL until built. */
+   XML_Node** byName;      /**< Children by name id, NULL unless sorted. */
+   int childrenLength;     /**< Allocated slots in children. */
+   int frozen;             /**< 1 if children are only linked through
+                                children, without siblings links. */
+} XML_NodeIndex;
+
+
+/**
+ * \struct XML_NodeData
+ * \brief A node's optional data, allocated on first use.
+ * Most parsed nodes have none, so a node stays as small as its links.
+ * Members are read with node's getters, and written through
+ * getXMLNodeData().
+ */
+typedef struct XML_NodeData
+{
+   int ns;                 /**< Node's namespace URI identifier. */
+   int local;              /**< Node's local name identifier, XML_NO_NAME for
+                                node's name identifier. */
+   char* rawAttr;          /**< Undecoded attributes' bytes, NULL if none. */
+   long offset;            /**< Bytes from previous sibling's end, or from
+                                parent's opening tag for a first child, or
+                                from file's start for the root, to opening
+                                tag. -1 if unknown. */
+   long length;            /**< Bytes from opening tag to closing tag's end,
+                                -1 if unknown. */
+   unsigned long long hash;   /**< Subtree's hash, 0 until computed. */
+   XML_NodeIndex* index;   /**< Children arrays, NULL if none. */
+   int shared;             /**< 1 if name, value and attributes are pooled,
+                                2 if node itself is, see isXMLNodePooled(). */
+   int refs;               /**< Links to node in persistent versions, else 0. */
+} XML_NodeData;
+
+
 /**
  * \struct XML_Node
  * \brief A XML tree's node.
  */
-typedef struct XML_Node XML_Node;
 struct XML_Node
 {
    char* name;             /**< Node's name. */
    char* value;            /**< Node's value. */
    XML_Attribute* attr;    /**< First node's attribute. */
+   XML_NodeData* data;     /**< Optional data, NULL if node has none. */
 
    /** \name Parent node */
    /**@{*/
@@ -46,6 +90,8 @@ struct XML_Node
    XML_Node* last;         /**< Last child node. */
    int cc;                 /**< Children count. */
    /**@}*/
+
+   int id;                 /**< Node's name identifier. */
 };
 
 
@@ -56,15 +102,48 @@ XML_Node* allocXMLNode(XML_Node* n);
 void freeXMLNode(XML_Node* n);
 
 void initXMLNode(XML_Node* n);
+XML_NodeData* getXMLNodeData(XML_Node* n);
+void freeXMLNodeData(XML_Node* n);
+XML_NodeIndex* getXMLNodeIndex(XML_Node* n);
 void initXMLNodeFromXMLTag(XML_Node* n, XML_Tag* tag);
 
 void setXMLNodeName(const char* name, XML_Node* n);
 void setXMLNodeValue(const char* value, XML_Node* n);
+int getXMLNodeNamespace(const XML_Node* n);
+int getXMLNodeLocalName(const XML_Node* n);
+void setXMLNodeNamespace(XML_Node* n, int ns, int local);
+long getXMLNodeOffset(const XML_Node* n);
+long getXMLNodeLength(const XML_Node* n);
+void setXMLNodeOffset(XML_Node* n, long offset);
+void setXMLNodeLength(XML_Node* n, long length);
+int isXMLNodeShared(const XML_Node* n);
+void setXMLNodeShared(XML_Node* n, int shared);
+int isXMLNodePooled(const XML_Node* n);
 void addAttributeToXMLNode(XML_Attribute* attr, XML_Node* n);
 XML_Attribute* deleteAttributeFromXMLNode(XML_Node* n);
+XML_Attribute* getXMLNodeAttribute(XML_Node* n, const char* name);
+void decodeXMLNodeAttributes(XML_Node* n);
 void addXMLNodeToParent(XML_Node* parent, XML_Node* child);
+void insertXMLNodeBefore(XML_Node* sibling, XML_Node* child);
+XML_Node* copyXMLNode(XML_Node* n);
+void unshareXMLNode(XML_Node* n);
 void deleteXMLNodeFromParent(XML_Node* child);
-void readXMLNodeValue(XML_Node* n, FILE* file);
+int indexXMLNodeChildren(XML_Node* n);
+void unindexXMLNodeChildren(XML_Node* n);
+int freezeXMLNodeChildren(XML_Node* n);
+int isXMLNodeFrozen(const XML_Node* n);
+void replaceXMLNodeChild(XML_Node* n, int i, XML_Node* child);
+XML_Node* getXMLChildAt(XML_Node* n, int i);
+XML_Node** getXMLChildren(XML_Node* n);
+XML_Node* getXMLNextChild(XML_Node* n, XML_Node* child, int i);
+int sortXMLNodeChildren(XML_Node* n);
+void unsortXMLNodeChildren(XML_Node* n);
+XML_Node** getXMLSortedChildren(XML_Node* n);
+XML_Node** getXMLChildrenByName(XML_Node* n, const char* name, int* count);
+long readXMLNodeValue(XML_Node* n, FILE* file);
+
+unsigned long long getXMLNodeHash(XML_Node* n);
+void invalidateXMLNodeHash(XML_Node* n);
 
 void printXMLNode(XML_Node* n, int mode);
 
@@ -0,0 +1,314 @@
+/**
+ * \file overlay.c
+ * \brief Overlaid XML files related functions
+ *
+ * Functions to use a XML_Overlay structure. Every looked up path is cached
+ * with the file resolving it, found or not, so repeated lookups are a single
+ * hash probe. The cache holds at most XML_OVERLAY_CACHE_LIMIT paths: once
+ * full, it is emptied as a whole, which costs less than tracking recency on
+ * every lookup and keeps hot paths a probe away once cached again.
+ * As every lookup may fill the cache, lookups hold the overlay's lock while
+ * probing it and return what the entry points to, never the entry itself.
+ *
+ * \author François-Xavier Balu \<fx.balu@gmail.com\>
+ * \date 17 octobre 2026
+ */
+
+
+#include <stdlib.h>     /* malloc(), calloc(), free() */
+#include <string.h>     /* strlen(), strcmp(), memcpy() */
+#include <pthread.h>    /* pthread_mutex_init(), pthread_mutex_lock(),
+                           pthread_mutex_unlock(), pthread_mutex_destroy() */
+
+#include "../log.h"     /* logError(), logMem() */
+#include "name.h"       /* hashXMLString() */
+#include "xml.h"        /* XML_File, findXMLValue(), getXMLNode() */
+#include "overlay.h"
+
+
+/** \brief Initial number of slots in an overlay's cache. */
+#define XML_OVERLAY_CACHE_LENGTH  64
+
+
+/**
+ * \brief Create an overlay of XML files.
+ * Files aren't copied nor owned by the overlay, they must outlive it.
+ *
+ * \param files  Overlaid files, from base to topmost.
+ * \param count  Number of files.
+ * \return       Created overlay, NULL if an error happened.
+ */
+XML_Overlay* createXMLOverlay(XML_File** files, int count)
+{
+   XML_Overlay* overlay;
+
+   if((files == NULL) || (count <= 0)) {
+      logError("Trying to overlay no file", __FILE__, __LINE__);
+      return NULL;
+   }
+   if((overlay = malloc(sizeof(XML_Overlay))) == NULL) {
+      logError("Can't allocate memory for XML_Overlay", __FILE__, __LINE__);
+      return NULL;
+   }
+   logMem(LOG_ALLOC, overlay, "XML_Overlay", "overlay", __FILE__, __LINE__);
+
+   overlay->count = count;
+   overlay->cacheLength = XML_OVERLAY_CACHE_LENGTH;
+   overlay->cacheCount = 0;
+   overlay->files = malloc(count * sizeof(XML_File*));
+   overlay->cache = calloc(overlay->cacheLength, sizeof(XML_OverlayEntry));
+   if((overlay->files == NULL) || (overlay->cache == NULL)) {
+      logError("Can't allocate memory for XML_Overlay", __FILE__, __LINE__);
+      free(overlay->files);
+      free(overlay->cache);
+      logMem(LOG_FREE, overlay, "XML_Overlay", "overlay", __FILE__, __LINE__);
+      free(overlay);
+      return NULL;
+   }
+   memcpy(overlay->files, files, count * sizeof(XML_File*));
+   pthread_mutex_init(&overlay->lock, NULL);
+
+   return overlay;
+}
+
+
+/**
+ * \brief Free every cached path, overlay's lock held.
+ */
+static void clearXMLOverlayCache(XML_Overlay* overlay)
+{
+   size_t i;
+
+   for(i = 0; i < overlay->cacheLength; i++) {
+      free(overlay->cache[i].path);
+      overlay->cache[i].path = NULL;
+   }
+   overlay->cacheCount = 0;
+}
+
+
+/**
+ * \brief Destroy an overlay.
+ * Overlaid files aren't destroyed.
+ *
+ * \param overlay  Destroyed overlay.
+ */
+void destroyXMLOverlay(XML_Overlay* overlay)
+{
+   if(overlay == NULL) {
+      logError("Trying to destroy a NULL overlay", __FILE__, __LINE__);
+   }
+   else {
+      clearXMLOverlayCache(overlay);
+      pthread_mutex_destroy(&overlay->lock);
+      free(overlay->cache);
+      free(overlay->files);
+      logMem(LOG_FREE, overlay, "XML_Overlay", "overlay", __FILE__, __LINE__);
+      free(overlay);
+   }
+}
+
+
+/**
+ * \brief Forget every resolved path.
+ * Must be called when an overlaid file is modified.
+ *
+ * \param overlay  Modified overlay.
+ */
+void resetXMLOverlayCache(XML_Overlay* overlay)
+{
+   if(overlay == NULL) {
+      logError("Trying to reset a NULL overlay", __FILE__, __LINE__);
+   }
+   else {
+      pthread_mutex_lock(&overlay->lock);
+      clearXMLOverlayCache(overlay);
+      pthread_mutex_unlock(&overlay->lock);
+   }
+}
+
+
+/**
+ * \brief Find the cache slot of a path.
+ *
+ * \return  Slot holding the path, or the free slot where it should go.
+ */
+static XML_OverlayEntry* findXMLOverlayEntry(XML_OverlayEntry* cache,
+                                             size_t length, const char* path,
+                                             unsigned long long hash, int isNode)
+{
+   size_t slot;
+
+   slot = (size_t)(hash ^ (unsigned long long)isNode) & (length - 1);
+   while((cache[slot].path != NULL) &&
+         ((cache[slot].hash != hash) ||
+          (cache[slot].isNode != isNode) ||
+          (strcmp(cache[slot].path, path) != 0))) {
+      slot = (slot + 1) & (length - 1);
+   }
+
+   return &cache[slot];
+}
+
+
+/**
+ * \brief Double an overlay's cache length.
+ *
+ * \return  1 on success, 0 if memory can't be allocated.
+ */
+static int growXMLOverlayCache(XML_Overlay* overlay)
+{
+   XML_OverlayEntry *cache, *entry;
+   size_t length, i;
+
+   length = overlay->cacheLength * 2;
+   if((cache = calloc(length, sizeof(XML_OverlayEntry))) == NULL) {
+      logError("Can't allocate memory for overlay cache", __FILE__, __LINE__);
+      return 0;
+   }
+   for(i = 0; i < overlay->cacheLength; i++) {
+      if(overlay->cache[i].path != NULL) {
+         entry = findXMLOverlayEntry(cache, length, overlay->cache[i].path,
+                                     overlay->cache[i].hash,
+                                     overlay->cache[i].isNode);
+         *entry = overlay->cache[i];
+      }
+   }
+   free(overlay->cache);
+   overlay->cache = cache;
+   overlay->cacheLength = length;
+
+   return 1;
+}
+
+
+/**
+ * \brief Resolve a path against overlaid files, from topmost to base.
+ * Overlay's lock must be held as long as the returned entry is read.
+ *
+ * \return  Cache entry of the path, NULL if an error happened.
+ */
+static XML_OverlayEntry* resolveXMLOverlayPath(char* path, XML_Overlay* overlay,
+                                               int isNode)
+{
+   XML_OverlayEntry* entry;
+   XML_FlatEntry* flatEntry;
+   XML_File* xml;
+   unsigned long long hash;
+   size_t length;
+   int layer;
+
+   if((path == NULL) || (overlay == NULL)) {
+      return NULL;
+   }
+
+   /* already resolved */
+   length = strlen(path);
+   hash = hashXMLString(path, length);
+   entry = findXMLOverlayEntry(overlay->cache, overlay->cacheLength,
+                               path, hash, isNode);
+   if(entry->path != NULL) {
+      return entry;
+   }
+
+   /* bounded cache, emptied when full */
+   if(overlay->cacheCount >= XML_OVERLAY_CACHE_LIMIT) {
+      clearXMLOverlayCache(overlay);
+      entry = findXMLOverlayEntry(overlay->cache, overlay->cacheLength,
+                                  path, hash, isNode);
+   }
+
+   /* keep cache at most half full */
+   if((overlay->cacheCount + 1) * 2 > overlay->cacheLength) {
+      if(!growXMLOverlayCache(overlay)) {
+         return NULL;
+      }
+      entry = findXMLOverlayEntry(overlay->cache, overlay->cacheLength,
+                                  path, hash, isNode);
+   }
+
+   if((entry->path = malloc((length + 1) * sizeof(char))) == NULL) {
+      logError("Can't allocate memory for overlay cache", __FILE__, __LINE__);
+      return NULL;
+   }
+   memcpy(entry->path, path, length + 1);
+   entry->hash = hash;
+   entry->isNode = isNode;
+   entry->layer = -1;
+   entry->value = NULL;
+   entry->node = NULL;
+   overlay->cacheCount++;
+
+   /* topmost file defining path wins */
+   for(layer = overlay->count - 1; (layer >= 0) && (entry->layer < 0); layer--) {
+      xml = overlay->files[layer];
+      if(isNode) {
+         entry->node = getXMLNode(path, xml->root);
+         if(entry->node != NULL) {
+            entry->layer = layer;
+         }
+      }
+      else {
+         if(xml->flat != NULL) {
+            flatEntry = findXMLFlatEntry(path, xml->flat);
+            entry->value = (flatEntry == NULL) ? NULL : flatEntry->value;
+         }
+         else {
+            entry->value = findXMLValue(path, xml->root);
+         }
+         if(entry->value != NULL) {
+            entry->layer = layer;
+         }
+      }
+   }
+
+   return entry;
+}
+
+
+/**
+ * \brief Reads a value in the topmost file defining it.
+ *
+ * \param[in] path     Value's path, see getXMLValue().
+ * \param     overlay  Searched overlay.
+ * \return             Found value, NULL if no file defines it.
+ */
+char* getXMLOverlayValue(char* path, XML_Overlay* overlay)
+{
+   XML_OverlayEntry* entry;
+   char* value;
+
+   if(overlay == NULL) {
+      return NULL;
+   }
+   pthread_mutex_lock(&overlay->lock);
+   entry = resolveXMLOverlayPath(path, overlay, 0);
+   value = (entry == NULL) ? NULL : entry->value;
+   pthread_mutex_unlock(&overlay->lock);
+
+   return value;
+}
+
+
+/**
+ * \brief Finds a node in the topmost file defining it.
+ *
+ * \param[in] path     Node's path, see getXMLNode().
+ * \param     overlay  Searched overlay.
+ * \return             Found node, NULL if no file defines it.
+ */
+XML_Node* getXMLOverlayNode(char* path, XML_Overlay* overlay)
+{
+   XML_OverlayEntry* entry;
+   XML_Node* node;
+
+   if(overlay == NULL) {
+      return NULL;
+   }
+   pthread_mutex_lock(&overlay->lock);
+   entry = resolveXMLOverlayPath(path, overlay, 1);
+   node = (entry == NULL) ? NULL : entry->node;
+   pthread_mutex_unlock(&overlay->lock);
+
+   return node;
+}
@@ -0,0 +1,69 @@
+/**
+ * \file overlay.h
+ * \brief Overlaid XML files related definitions
+ *
+ * Definition of a XML_Overlay structure, a stack of XML files read as a single
+ * one: a path is looked up in the topmost file defining it. A base file can
+ * then be overridden by environment or host files without copying any node.
+ *
+ * \author François-Xavier Balu \<fx.balu@gmail.com\>
+ * \date 17 octobre 2026
+ */
+
+
+#ifndef OVERLAY_H_INCLUDED
+#define OVERLAY_H_INCLUDED
+
+
+#include <pthread.h>  /* pthread_mutex_t */
+
+#include "xml.h"     /* XML_File */
+
+
+/**
+ * \brief Maximum number of paths cached by an overlay.
+ * A full cache is emptied before the next path is cached, so paths built by
+ * callers can't grow it without bound.
+ */
+#ifndef XML_OVERLAY_CACHE_LIMIT
+#define XML_OVERLAY_CACHE_LIMIT  4096
+#endif /* XML_OVERLAY_CACHE_LIMIT */
+
+
+/**
+ * \brief A resolved path, cached in an overlay.
+ */
+typedef struct XML_OverlayEntry {
+   char* path;                /**< Looked up path, NULL for a free slot. */
+   unsigned long long hash;   /**< Path's hash. */
+   int isNode;                /**< 1 for getXMLOverlayNode() lookups. */
+   int layer;                 /**< File defining path, -1 if none does. */
+   char* value;               /**< Found value. */
+   XML_Node* node;            /**< Found node. */
+} XML_OverlayEntry;
+
+
+/**
+ * \brief Stack of XML files read as one.
+ * Lookups may run from several threads at once: the cache is guarded by the
+ * overlay's lock, and found values and nodes belong to the overlaid files.
+ */
+typedef struct XML_Overlay {
+   XML_File** files;          /**< Files, from base to topmost. */
+   int count;                 /**< Number of files. */
+   XML_OverlayEntry* cache;   /**< Resolved paths, open addressing table. */
+   size_t cacheLength;        /**< Slots in cache, power of 2. */
+   size_t cacheCount;         /**< Used slots in cache. */
+   pthread_mutex_t lock;      /**< Serializes cache accesses. */
+} XML_Overlay;
+
+
+XML_Overlay* createXMLOverlay(XML_File** files, int count);
+void destroyXMLOverlay(XML_Overlay* overlay);
+void resetXMLOverlayCache(XML_Overlay* overlay);
+
+char* getXMLOverlayValue(char* path, XML_Overlay* overlay);
+XML_Node* getXMLOverlayNode(char* path, XML_Overlay* overlay);
+
+
+#endif /* OVERLAY_H_INCLUDED */
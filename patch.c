@@ -0,0 +1,731 @@
+/**
+ * \file patch.c
+ * \brief XML trees differences related functions
+ *
+ * Functions to compute and apply a XML_Patch.
+ *
+ * Children lists are compared in three steps. Children with equal hashes are
+ * paired first, and never descended into. Remaining ones are paired by name,
+ * in order, and compared recursively. Unpaired old children are deleted, then
+ * the new list is built from left to right with moves and insertions, so each
+ * operation only shifts siblings that weren't placed yet.
+ *
+ * \author François-Xavier Balu \<fx.balu@gmail.com\>
+ * \date 17 octobre 2026
+ */
+
+
+#include <stdlib.h>     /* malloc(), calloc(), realloc(), free() */
+#include <string.h>     /* strlen(), strcpy(), strcmp(), memcpy(), memmove() */
+
+#include "../log.h"     /* logError(), logMem() */
+#include "attribute.h"  /* XML_Attribute */
+#include "node.h"       /* XML_Node, getXMLNodeHash(), copyXMLNode(), getXMLNextChild(),
+                           isXMLNodePooled() */
+#include "patch.h"
+
+
+/**
+ * \brief State of a diff: produced patch and path of compared nodes.
+ */
+typedef struct XML_Diff {
+   XML_Patch* patch;    /**< Produced patch. */
+   int* path;           /**< Children's indexes of compared nodes. */
+   int depth;           /**< Number of indexes in path. */
+   int capacity;        /**< Allocated indexes in path. */
+   int error;           /**< 1 if an allocation failed. */
+} XML_Diff;
+
+
+/**
+ * \brief Create an empty patch.
+ *
+ * \return  Created patch, NULL if an error happened.
+ */
+XML_Patch* createXMLPatch(void)
+{
+   XML_Patch* patch;
+
+   if((patch = malloc(sizeof(XML_Patch))) == NULL) {
+      logError("Can't allocate memory for XML_Patch", __FILE__, __LINE__);
+      return NULL;
+   }
+   logMem(LOG_ALLOC, patch, "XML_Patch", "patch", __FILE__, __LINE__);
+   patch->ops = NULL;
+   patch->count = 0;
+   patch->capacity = 0;
+
+   return patch;
+}
+
+
+/**
+ * \brief Destroy a patch and the subtrees it holds.
+ *
+ * \param patch  Destroyed patch.
+ */
+void destroyXMLPatch(XML_Patch* patch)
+{
+   int i;
+
+   if(patch == NULL) {
+      logError("Trying to destroy a NULL XML_Patch", __FILE__, __LINE__);
+   }
+   else {
+      for(i = 0; i < patch->count; i++) {
+         free(patch->ops[i].path);
+         free(patch->ops[i].name);
+         free(patch->ops[i].value);
+         if(patch->ops[i].node != NULL) {
+            destroyXMLNode(patch->ops[i].node);
+         }
+      }
+      free(patch->ops);
+      logMem(LOG_FREE, patch, "XML_Patch", "patch", __FILE__, __LINE__);
+      free(patch);
+   }
+}
+
+
+/**
+ * \brief Copy a string that may be NULL.
+ *
+ * \return  Copy, NULL if \p str is NULL or an error happened.
+ */
+static char* copyXMLPatchString(const char* str, XML_Diff* diff)
+{
+   char* copy;
+
+   if(str == NULL) {
+      return NULL;
+   }
+   if((copy = malloc((strlen(str) + 1) * sizeof(char))) == NULL) {
+      logError("Can't allocate memory for patch string", __FILE__, __LINE__);
+      diff->error = 1;
+      return NULL;
+   }
+   strcpy(copy, str);
+
+   return copy;
+}
+
+
+/**
+ * \brief Append an operation targeting current node, or one of its children.
+ *
+ * \param child  Targeted child's index, -1 to target current node.
+ * \return       Appended operation, NULL if an error happened.
+ */
+static XML_PatchOp* addXMLPatchOp(XML_Diff* diff, XML_PatchOpType type, int child)
+{
+   XML_Patch* patch;
+   XML_PatchOp *ops, *op;
+   int capacity;
+
+   patch = diff->patch;
+   if(patch->count == patch->capacity) {
+      capacity = (patch->capacity == 0) ? 16 : 2 * patch->capacity;
+      if((ops = realloc(patch->ops, capacity * sizeof(XML_PatchOp))) == NULL) {
+         logError("Can't allocate memory for patch operations", __FILE__, __LINE__);
+         diff->error = 1;
+         return NULL;
+      }
+      patch->ops = ops;
+      patch->capacity = capacity;
+   }
+
+   op = &patch->ops[patch->count];
+   op->depth = diff->depth + ((child >= 0) ? 1 : 0);
+   if((op->path = malloc((op->depth + 1) * sizeof(int))) == NULL) {
+      logError("Can't allocate memory for patch path", __FILE__, __LINE__);
+      diff->error = 1;
+      return NULL;
+   }
+   if(diff->depth > 0) {
+      memcpy(op->path, diff->path, diff->depth * sizeof(int));
+   }
+   if(child >= 0) {
+      op->path[diff->depth] = child;
+   }
+   op->type = type;
+   op->index = -1;
+   op->name = NULL;
+   op->value = NULL;
+   op->node = NULL;
+   patch->count++;
+
+   return op;
+}
+
+
+/**
+ * \brief Find an attribute by name identifier.
+ */
+static XML_Attribute* findXMLPatchAttribute(XML_Node* n, int id)
+{
+   XML_Attribute* attr;
+
+   for(attr = n->attr; attr != NULL; attr = attr->next) {
+      if(attr->id == id) {
+         return attr;
+      }
+   }
+
+   return NULL;
+}
+
+
+/**
+ * \brief Compare two strings that may be NULL.
+ */
+static int isSameXMLPatchString(const char* a, const char* b)
+{
+   if((a == NULL) || (b == NULL)) {
+      return (a == b);
+   }
+
+   return (strcmp(a, b) == 0);
+}
+
+
+static void diffXMLNodes(XML_Node* a, XML_Node* b, XML_Diff* diff);
+
+
+/**
+ * \brief Compare attributes of two nodes with the same name.
+ */
+static void diffXMLAttributes(XML_Node* a, XML_Node* b, XML_Diff* diff)
+{
+   XML_Attribute *attr, *old;
+   XML_PatchOp* op;
+
+   decodeXMLNodeAttributes(a);
+   decodeXMLNodeAttributes(b);
+   for(attr = b->attr; attr != NULL; attr = attr->next) {
+      old = findXMLPatchAttribute(a, attr->id);
+      if((old == NULL) || !isSameXMLPatchString(old->value, attr->value)) {
+         if((op = addXMLPatchOp(diff, XML_PATCH_SET_ATTRIBUTE, -1)) != NULL) {
+            op->name = copyXMLPatchString(attr->name, diff);
+            op->value = copyXMLPatchString(attr->value, diff);
+         }
+      }
+   }
+   for(attr = a->attr; attr != NULL; attr = attr->next) {
+      if(findXMLPatchAttribute(b, attr->id) == NULL) {
+         if((op = addXMLPatchOp(diff, XML_PATCH_DELETE_ATTRIBUTE, -1)) != NULL) {
+            op->name = copyXMLPatchString(attr->name, diff);
+         }
+      }
+   }
+}
+
+
+/**
+ * \brief Slot of a children table: chain of unpaired children sharing a key.
+ */
+typedef struct XML_DiffBucket {
+   unsigned long long key;    /**< Children's hash or name identifier. */
+   int head;                  /**< First unpaired child, -1 if none left. */
+   int occupied;              /**< 1 if slot is used. */
+} XML_DiffBucket;
+
+
+/**
+ * \brief Get the key of a child in a children table.
+ */
+static unsigned long long getXMLDiffKey(XML_Node* n, int byName)
+{
+   return byName ? (unsigned long long)(unsigned)n->id : getXMLNodeHash(n);
+}
+
+
+/**
+ * \brief Index unpaired old children by hash or by name.
+ * Children sharing a key are chained in order through \p next.
+ *
+ * \return  Open addressing table, NULL if an error happened.
+ */
+static XML_DiffBucket* indexXMLChildren(XML_Node** olds, int count, const char* used,
+                                        int byName, int* next, size_t* length)
+{
+   XML_DiffBucket* table;
+   unsigned long long key;
+   size_t slot;
+   int i;
+
+   for(*length = 2; *length < 2 * (size_t)count; *length *= 2);
+   if((table = calloc(*length, sizeof(XML_DiffBucket))) == NULL) {
+      logError("Can't allocate memory for children table", __FILE__, __LINE__);
+      return NULL;
+   }
+
+   /* from the last, so chains are in order */
+   for(i = count - 1; i >= 0; i--) {
+      if(used[i]) {
+         continue;
+      }
+      key = getXMLDiffKey(olds[i], byName);
+      for(slot = key & (*length - 1);
+          table[slot].occupied && (table[slot].key != key);
+          slot = (slot + 1) & (*length - 1));
+      next[i] = table[slot].occupied ? table[slot].head : -1;
+      table[slot].key = key;
+      table[slot].head = i;
+      table[slot].occupied = 1;
+   }
+
+   return table;
+}
+
+
+/**
+ * \brief Take the first unpaired old child with a key.
+ *
+ * \return  Child's index, -1 if there is none.
+ */
+static int takeXMLChild(XML_DiffBucket* table, size_t length, unsigned long long key,
+                        const int* next)
+{
+   size_t slot;
+   int i;
+
+   for(slot = key & (length - 1); table[slot].occupied; slot = (slot + 1) & (length - 1)) {
+      if(table[slot].key == key) {
+         if((i = table[slot].head) >= 0) {
+            table[slot].head = next[i];
+         }
+         return i;
+      }
+   }
+
+   return -1;
+}
+
+
+/**
+ * \brief Pair children of two nodes.
+ * Sets, for each new child, the old one it comes from, or NULL. Unchanged
+ * children at both ends are paired by position, so an edit in a long list
+ * doesn't shift pairs of identical siblings.
+ *
+ * \param[out] pairs      Old child of each new one.
+ * \param[out] identical  1 for new children paired by hash.
+ * \param[out] used       1 for paired old children.
+ * \return                1 on success, 0 if an error happened.
+ */
+static int pairXMLChildren(XML_Node** olds, int oldCount,
+                           XML_Node** news, int newCount,
+                           XML_Node** pairs, char* identical, char* used)
+{
+   XML_DiffBucket* table;
+   size_t length;
+   int *next, byName, i, j, k;
+
+   /* unchanged children at both ends keep their place */
+   for(i = 0; (i < oldCount) && (i < newCount) &&
+       (getXMLNodeHash(olds[i]) == getXMLNodeHash(news[i])); i++) {
+      pairs[i] = olds[i];
+      identical[i] = 1;
+      used[i] = 1;
+   }
+   for(k = 1; (oldCount - k >= i) && (newCount - k >= i) &&
+       (getXMLNodeHash(olds[oldCount - k]) == getXMLNodeHash(news[newCount - k])); k++) {
+      pairs[newCount - k] = olds[oldCount - k];
+      identical[newCount - k] = 1;
+      used[oldCount - k] = 1;
+   }
+
+   if((next = malloc((oldCount + 1) * sizeof(int))) == NULL) {
+      logError("Can't allocate memory for children chains", __FILE__, __LINE__);
+      return 0;
+   }
+
+   /* identical subtrees first, then same names, in order */
+   for(byName = 0; byName <= 1; byName++) {
+      if((table = indexXMLChildren(olds, oldCount, used, byName, next, &length)) == NULL) {
+         free(next);
+         return 0;
+      }
+      for(j = 0; j < newCount; j++) {
+         if((pairs[j] == NULL) &&
+            ((i = takeXMLChild(table, length, getXMLDiffKey(news[j], byName), next)) >= 0)) {
+            pairs[j] = olds[i];
+            identical[j] = !byName;
+            used[i] = 1;
+         }
+      }
+      free(table);
+   }
+   free(next);
+
+   return 1;
+}
+
+
+/**
+ * \brief Compare children of two nodes with the same name.
+ */
+static void diffXMLChildren(XML_Node* a, XML_Node* b, XML_Diff* diff)
+{
+   XML_Node **olds, **news, **pairs, **list, *child, *moved;
+   XML_PatchOp* op;
+   char *identical, *used;
+   int *path, i, j, count;
+
+   olds = malloc((a->cc + 1) * sizeof(XML_Node*));
+   news = malloc((b->cc + 1) * sizeof(XML_Node*));
+   pairs = calloc(b->cc + 1, sizeof(XML_Node*));
+   list = malloc((a->cc + b->cc + 1) * sizeof(XML_Node*));
+   identical = calloc(b->cc + 1, sizeof(char));
+   used = calloc(a->cc + 1, sizeof(char));
+   if((olds == NULL) || (news == NULL) || (pairs == NULL) || (list == NULL) ||
+      (identical == NULL) || (used == NULL)) {
+      logError("Can't allocate memory to compare children", __FILE__, __LINE__);
+      diff->error = 1;
+   }
+   else {
+      for(i = 0, child = a->first; child != NULL; child = getXMLNextChild(a, child, i++)) {
+         olds[i] = child;
+      }
+      for(j = 0, child = b->first; child != NULL; child = getXMLNextChild(b, child, j++)) {
+         news[j] = child;
+      }
+      if(!pairXMLChildren(olds, a->cc, news, b->cc, pairs, identical, used)) {
+         diff->error = 1;
+      }
+   }
+
+   if(diff->error) {
+      free(olds);
+      free(news);
+      free(pairs);
+      free(list);
+      free(identical);
+      free(used);
+      return;
+   }
+
+   /* delete unpaired old children, from the last so indexes don't move */
+   for(i = a->cc - 1; i >= 0; i--) {
+      if(!used[i]) {
+         addXMLPatchOp(diff, XML_PATCH_DELETE, i);
+      }
+   }
+   count = 0;
+   for(i = 0; i < a->cc; i++) {
+      if(used[i]) {
+         list[count++] = olds[i];
+      }
+   }
+
+   /* place new children from left to right */
+   for(j = 0; (j < b->cc) && !diff->error; j++) {
+      if(pairs[j] == NULL) {
+         if((op = addXMLPatchOp(diff, XML_PATCH_INSERT, -1)) != NULL) {
+            op->index = j;
+            op->node = copyXMLNode(news[j]);
+         }
+         memmove(&list[j + 1], &list[j], (count - j) * sizeof(XML_Node*));
+         list[j] = NULL;
+         count++;
+         continue;
+      }
+
+      for(i = j; list[i] != pairs[j]; i++);
+      if(i != j) {
+         if((op = addXMLPatchOp(diff, XML_PATCH_MOVE, i)) != NULL) {
+            op->index = j;
+         }
+         moved = list[i];
+         memmove(&list[j + 1], &list[j], (i - j) * sizeof(XML_Node*));
+         list[j] = moved;
+      }
+
+      if(!identical[j]) {
+         if(diff->depth == diff->capacity) {
+            diff->capacity = (diff->capacity == 0) ? 16 : 2 * diff->capacity;
+            if((path = realloc(diff->path, diff->capacity * sizeof(int))) == NULL) {
+               logError("Can't allocate memory for diff path", __FILE__, __LINE__);
+               diff->error = 1;
+               break;
+            }
+            diff->path = path;
+         }
+         diff->path[diff->depth++] = j;
+         diffXMLNodes(pairs[j], news[j], diff);
+         diff->depth--;
+      }
+   }
+
+   free(olds);
+   free(news);
+   free(pairs);
+   free(list);
+   free(identical);
+   free(used);
+}
+
+
+/**
+ * \brief Compare two nodes, at current path.
+ */
+static void diffXMLNodes(XML_Node* a, XML_Node* b, XML_Diff* diff)
+{
+   XML_PatchOp* op;
+
+   if(getXMLNodeHash(a) == getXMLNodeHash(b)) {
+      return;
+   }
+
+   if(a->id != b->id) {
+      if((op = addXMLPatchOp(diff, XML_PATCH_REPLACE, -1)) != NULL) {
+         op->node = copyXMLNode(b);
+      }
+      return;
+   }
+
+   if(!isSameXMLPatchString(a->value, b->value)) {
+      if((op = addXMLPatchOp(diff, XML_PATCH_VALUE, -1)) != NULL) {
+         op->value = copyXMLPatchString(b->value, diff);
+      }
+   }
+   diffXMLAttributes(a, b, diff);
+   diffXMLChildren(a, b, diff);
+}
+
+
+/**
+ * \brief Compute the edit script turning a tree into another one.
+ * Identical subtrees are found by hash and skipped, so comparing two versions
+ * of a large tree costs in proportion to their differences. Inserted and
+ * replacing subtrees are copied, so both trees can be destroyed afterwards.
+ *
+ * \param a  Old tree.
+ * \param b  New tree.
+ * \return   Patch turning \p a into \p b, NULL if an error happened.
+ */
+XML_Patch* diffXMLNode(XML_Node* a, XML_Node* b)
+{
+   XML_Diff diff;
+
+   if((a == NULL) || (b == NULL)) {
+      logError("Trying to diff a NULL node", __FILE__, __LINE__);
+      return NULL;
+   }
+   if((diff.patch = createXMLPatch()) == NULL) {
+      return NULL;
+   }
+   diff.path = NULL;
+   diff.depth = 0;
+   diff.capacity = 0;
+   diff.error = 0;
+
+   diffXMLNodes(a, b, &diff);
+   free(diff.path);
+
+   if(diff.error) {
+      destroyXMLPatch(diff.patch);
+      return NULL;
+   }
+
+   return diff.patch;
+}
+
+
+/**
+ * \brief Get a node's child by index.
+ *
+ * \return  Child, NULL if there is no such child.
+ */
+static XML_Node* getXMLPatchChild(XML_Node* n, int index)
+{
+   XML_Node* child;
+   int i;
+
+   for(i = 0, child = n->first; (child != NULL) && (i < index); i++) {
+      child = getXMLNextChild(n, child, i);
+   }
+
+   return (i == index) ? child : NULL;
+}
+
+
+/**
+ * \brief Insert a node among a parent's children, at given index.
+ *
+ * \return  1 on success, 0 if index is out of children list, or before a
+ *          pooled child.
+ */
+static int insertXMLPatchChild(XML_Node* parent, int index, XML_Node* child)
+{
+   XML_Node* sibling;
+
+   if(index == parent->cc) {
+      addXMLNodeToParent(parent, child);
+   }
+   else if((index < 0) || ((sibling = getXMLPatchChild(parent, index)) == NULL) ||
+           isXMLNodePooled(sibling)) {
+      return 0;
+   }
+   else {
+      insertXMLNodeBefore(sibling, child);
+   }
+
+   return 1;
+}
+
+
+/**
+ * \brief Delete an attribute of a node by name.
+ *
+ * \return  1 on success, 0 if node has no such attribute.
+ */
+static int deleteXMLPatchAttribute(XML_Node* n, const char* name)
+{
+   XML_Attribute *attr, **link;
+
+   unshareXMLNode(n);
+   decodeXMLNodeAttributes(n);
+   for(link = &n->attr; (attr = *link) != NULL; link = &attr->next) {
+      if(strcmp(attr->name, name) == 0) {
+         *link = attr->next;
+         attr->next = NULL;
+         destroyXMLAttribute(attr);
+         invalidateXMLNodeHash(n);
+         return 1;
+      }
+   }
+
+   return 0;
+}
+
+
+/**
+ * \brief Apply an operation to its target node.
+ *
+ * \param[in,out] tree  Patched tree's root, replaced if root is.
+ * \return              1 on success, 0 if operation doesn't match tree, or
+ *                      targets a pooled node.
+ */
+static int applyXMLPatchOp(XML_Node** tree, XML_Node* n, XML_PatchOp* op)
+{
+   XML_Attribute* attr;
+   XML_Node *parent, *copy;
+
+   /* a pooled node stands for subtrees of other parents too */
+   if(isXMLNodePooled(n)) {
+      return 0;
+   }
+
+   switch(op->type)
+   {
+      case XML_PATCH_VALUE:
+         if(op->value != NULL) {
+            setXMLNodeValue(op->value, n);
+         }
+         else if(n->value != NULL) {
+            unshareXMLNode(n);
+            logMem(LOG_FREE, n->value, "string", "node value", __FILE__, __LINE__);
+            free(n->value);
+            n->value = NULL;
+            invalidateXMLNodeHash(n);
+         }
+         return 1;
+
+      case XML_PATCH_SET_ATTRIBUTE:
+         unshareXMLNode(n);
+         decodeXMLNodeAttributes(n);
+         for(attr = n->attr; (attr != NULL) && (strcmp(attr->name, op->name) != 0);
+             attr = attr->next);
+         if(attr != NULL) {
+            setXMLAttributeValue(op->value, attr);
+            invalidateXMLNodeHash(n);
+         }
+         else {
+            attr = createXMLAttribute();
+            setXMLAttributeName(op->name, attr);
+            setXMLAttributeValue(op->value, attr);
+            addAttributeToXMLNode(attr, n);
+         }
+         return 1;
+
+      case XML_PATCH_DELETE_ATTRIBUTE:
+         return deleteXMLPatchAttribute(n, op->name);
+
+      case XML_PATCH_INSERT:
+         copy = copyXMLNode(op->node);
+         if(!insertXMLPatchChild(n, op->index, copy)) {
+            destroyXMLNode(copy);
+            return 0;
+         }
+         return 1;
+
+      case XML_PATCH_DELETE:
+         if(n->parent == NULL) {
+            return 0;
+         }
+         destroyXMLNode(n);
+         return 1;
+
+      case XML_PATCH_MOVE:
+         if((parent = n->parent) == NULL) {
+            return 0;
+         }
+         deleteXMLNodeFromParent(n);
+         if(!insertXMLPatchChild(parent, op->index, n)) {
+            addXMLNodeToParent(parent, n);
+            return 0;
+         }
+         return 1;
+
+      case XML_PATCH_REPLACE:
+         copy = copyXMLNode(op->node);
+         if(n->parent == NULL) {
+            *tree = copy;
+         }
+         else {
+            insertXMLNodeBefore(n, copy);
+         }
+         destroyXMLNode(n);
+         return 1;
+
+      default:
+         return 0;
+   }
+}
+
+
+/**
+ * \brief Apply a patch to a tree.
+ * The patch isn't modified, so it can be applied to several copies of the
+ * tree it was computed from. If an operation doesn't match the tree, previous
+ * ones stay applied.
+ *
+ * \param tree   Patched tree.
+ * \param patch  Applied patch.
+ * \return       Patched tree's root, which changes if root was replaced, NULL
+ *               if the patch doesn't match the tree.
+ */
+XML_Node* applyXMLPatch(XML_Node* tree, XML_Patch* patch)
+{
+   XML_Node* n;
+   int i, d;
+
+   if((tree == NULL) || (patch == NULL)) {
+      logError("Trying to apply a patch with NULL tree or patch", __FILE__, __LINE__);
+      return NULL;
+   }
+
+   for(i = 0; i < patch->count; i++) {
+      n = tree;
+      for(d = 0; (d < patch->ops[i].depth) && (n != NULL); d++) {
+         n = getXMLPatchChild(n, patch->ops[i].path[d]);
+      }
+      if((n == NULL) || !applyXMLPatchOp(&tree, n, &patch->ops[i])) {
+         logError("Patch doesn't match tree", __FILE__, __LINE__);
+         return NULL;
+      }
+   }
+
+   return tree;
+}
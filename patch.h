@@ -0,0 +1,69 @@
+/**
+ * \file patch.h
+ * \brief XML trees differences related definitions
+ *
+ * Definition of a XML_Patch structure, an edit script turning a tree into
+ * another one. Identical subtrees are paired by hash, so a diff only walks the
+ * changed parts of both trees, and a patch only holds them.
+ *
+ * \author François-Xavier Balu \<fx.balu@gmail.com\>
+ * \date 17 octobre 2026
+ */
+
+
+#ifndef PATCH_H_INCLUDED
+#define PATCH_H_INCLUDED
+
+
+#include "node.h"    /* XML_Node */
+
+
+/**
+ * \enum XML_PatchOpType
+ * \brief Kind of a patch operation.
+ */
+typedef enum XML_PatchOpType {
+   XML_PATCH_VALUE,              /**< Set node's value, NULL removes it. */
+   XML_PATCH_SET_ATTRIBUTE,      /**< Add or change an attribute. */
+   XML_PATCH_DELETE_ATTRIBUTE,   /**< Delete an attribute. */
+   XML_PATCH_INSERT,             /**< Insert a copy of node at index. */
+   XML_PATCH_DELETE,             /**< Delete node. */
+   XML_PATCH_MOVE,               /**< Move node to index among its siblings. */
+   XML_PATCH_REPLACE             /**< Replace node by a copy of node. */
+} XML_PatchOpType;
+
+
+/**
+ * \brief A patch operation.
+ * Target is found by following children's indexes from the root, in the tree
+ * as modified by previous operations. Inserting targets the parent.
+ */
+typedef struct XML_PatchOp {
+   XML_PatchOpType type;   /**< Kind of operation. */
+   int* path;              /**< Children's indexes from root to target. */
+   int depth;              /**< Number of indexes in path. */
+   int index;              /**< Inserted or moved node's new index. */
+   char* name;             /**< Attribute's name. */
+   char* value;            /**< Node's or attribute's new value. */
+   XML_Node* node;         /**< Inserted or replacing subtree. */
+} XML_PatchOp;
+
+
+/**
+ * \brief Edit script, applied in order.
+ */
+typedef struct XML_Patch {
+   XML_PatchOp* ops;       /**< Operations. */
+   int count;              /**< Number of operations. */
+   int capacity;           /**< Allocated operations. */
+} XML_Patch;
+
+
+XML_Patch* createXMLPatch(void);
+void destroyXMLPatch(XML_Patch* patch);
+
+XML_Patch* diffXMLNode(XML_Node* a, XML_Node* b);
+XML_Node* applyXMLPatch(XML_Node* tree, XML_Patch* patch);
+
+
+#endif /* PATCH_H_INCLUDED */
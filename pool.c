@@ -0,0 +1,472 @@
+/**
+ * \file pool.c
+ * \brief Shared XML contents related functions
+ *
+ * Functions to use a XML_Pool structure.
+ *
+ * \author François-Xavier Balu \<fx.balu@gmail.com\>
+ * \date 17 octobre 2026
+ */
+
+
+#include <stdint.h>     /* uintptr_t */
+#include <stdlib.h>     /* malloc(), calloc(), free() */
+#include <string.h>     /* strlen(), strncmp(), strcmp(), memcpy() */
+
+#include "../log.h"     /* logError(), logMem() */
+#include "name.h"       /* hashXMLString() */
+#include "pool.h"
+
+
+/**
+ * \brief Create an empty pool.
+ *
+ * \return  Created pool, NULL if an error happened.
+ */
+XML_Pool* createXMLPool(void)
+{
+   XML_Pool* pool;
+
+   if((pool = malloc(sizeof(XML_Pool))) == NULL) {
+      logError("Can't allocate memory for XML_Pool", __FILE__, __LINE__);
+      return NULL;
+   }
+   logMem(LOG_ALLOC, pool, "XML_Pool", "pool", __FILE__, __LINE__);
+   pool->chunks = NULL;
+   pool->strings = NULL;
+   pool->stringsLength = 0;
+   pool->stringsCount = 0;
+   pool->attributes = NULL;
+   pool->attributesLength = 0;
+   pool->attributesCount = 0;
+   pool->nodes = NULL;
+   pool->nodesLength = 0;
+   pool->nodesCount = 0;
+
+   return pool;
+}
+
+
+/**
+ * \brief Destroy a pool and all its contents.
+ * Nodes sharing them must have been destroyed before.
+ *
+ * \param pool  Destroyed pool.
+ */
+void destroyXMLPool(XML_Pool* pool)
+{
+   XML_PoolChunk* chunk;
+   size_t i;
+
+   if(pool == NULL) {
+      logError("Trying to destroy a NULL XML_Pool", __FILE__, __LINE__);
+   }
+   else {
+      /* pooled nodes are in chunks, but not their data */
+      for(i = 0; i < pool->nodesLength; i++) {
+         if(pool->nodes[i].content != NULL) {
+            freeXMLNodeData(pool->nodes[i].content);
+         }
+      }
+      while((chunk = pool->chunks) != NULL) {
+         pool->chunks = chunk->next;
+         free(chunk);
+      }
+      free(pool->strings);
+      free(pool->attributes);
+      free(pool->nodes);
+      logMem(LOG_FREE, pool, "XML_Pool", "pool", __FILE__, __LINE__);
+      free(pool);
+   }
+}
+
+
+/**
+ * \brief Allocate memory in pool's chunks.
+ *
+ * \return  Allocated memory, aligned for pointers, NULL if an error happened.
+ */
+static void* allocXMLPoolMemory(size_t size, XML_Pool* pool)
+{
+   XML_PoolChunk* chunk;
+   size_t length;
+   void* memory;
+
+   size = (size + sizeof(void*) - 1) & ~(sizeof(void*) - 1);
+   chunk = pool->chunks;
+   if((chunk == NULL) || (chunk->used + size > chunk->length)) {
+      length = (size > XML_POOL_CHUNK_LENGTH) ? size : XML_POOL_CHUNK_LENGTH;
+      if((chunk = malloc(sizeof(XML_PoolChunk) + length)) == NULL) {
+         logError("Can't allocate memory for pool chunk", __FILE__, __LINE__);
+         return NULL;
+      }
+      chunk->next = pool->chunks;
+      chunk->used = 0;
+      chunk->length = length;
+      pool->chunks = chunk;
+   }
+   memory = chunk->data + chunk->used;
+   chunk->used += size;
+
+   return memory;
+}
+
+
+/**
+ * \brief Make room for one more entry in a pool's table.
+ * Table is kept at most half full.
+ *
+ * \return  1 on success, 0 if an error happened.
+ */
+static int growXMLPoolTable(XML_PoolEntry** table, size_t* length, size_t count)
+{
+   XML_PoolEntry* entries;
+   size_t newLength, i, slot;
+
+   if(2 * (count + 1) <= *length) {
+      return 1;
+   }
+   newLength = (*length == 0) ? 256 : 2 * *length;
+   if((entries = calloc(newLength, sizeof(XML_PoolEntry))) == NULL) {
+      logError("Can't allocate memory for pool table", __FILE__, __LINE__);
+      return 0;
+   }
+   for(i = 0; i < *length; i++) {
+      if((*table)[i].content != NULL) {
+         slot = (*table)[i].hash & (newLength - 1);
+         while(entries[slot].content != NULL) {
+            slot = (slot + 1) & (newLength - 1);
+         }
+         entries[slot] = (*table)[i];
+      }
+   }
+   free(*table);
+   *table = entries;
+   *length = newLength;
+
+   return 1;
+}
+
+
+/**
+ * \brief Get the pooled copy of a string.
+ *
+ * \param[in] str     Pooled string, which doesn't need to end with '\\0'.
+ * \param     length  String's length.
+ * \param     pool    Used pool.
+ * \return            Shared string, NULL if an error happened.
+ */
+char* poolXMLString(const char* str, size_t length, XML_Pool* pool)
+{
+   unsigned long long hash;
+   size_t slot;
+   char* copy;
+
+   if((str == NULL) || (pool == NULL)) {
+      logError("Trying to pool a NULL string, or in a NULL pool", __FILE__, __LINE__);
+      return NULL;
+   }
+   if(!growXMLPoolTable(&pool->strings, &pool->stringsLength, pool->stringsCount)) {
+      return NULL;
+   }
+
+   hash = hashXMLString(str, length);
+   for(slot = hash & (pool->stringsLength - 1);
+       pool->strings[slot].content != NULL;
+       slot = (slot + 1) & (pool->stringsLength - 1)) {
+      copy = pool->strings[slot].content;
+      if((pool->strings[slot].hash == hash) &&
+         (strncmp(copy, str, length) == 0) && (copy[length] == '\0')) {
+         return copy;
+      }
+   }
+
+   if((copy = allocXMLPoolMemory(length + 1, pool)) == NULL) {
+      return NULL;
+   }
+   memcpy(copy, str, length);
+   copy[length] = '\0';
+   pool->strings[slot].content = copy;
+   pool->strings[slot].hash = hash;
+   pool->stringsCount++;
+
+   return copy;
+}
+
+
+/**
+ * \brief Check if two attributes lists are equal, in the same order.
+ */
+static int isSameXMLPoolAttributes(XML_Attribute* a, XML_Attribute* b)
+{
+   while((a != NULL) && (b != NULL)) {
+      if((a->id != b->id) || (a->ns != b->ns) || (a->local != b->local) ||
+         (strcmp(a->value, b->value) != 0)) {
+         return 0;
+      }
+      a = a->next;
+      b = b->next;
+   }
+
+   return (a == b);
+}
+
+
+/**
+ * \brief Get the pooled copy of an attributes list.
+ * Given list isn't modified. Pooled list and its strings mustn't be modified.
+ *
+ * \param[in] attr  First attribute of pooled list.
+ * \param     pool  Used pool.
+ * \return          Shared list, NULL if \p attr is NULL or an error happened.
+ */
+XML_Attribute* poolXMLAttributes(XML_Attribute* attr, XML_Pool* pool)
+{
+   XML_Attribute *a, *copy;
+   unsigned long long hash;
+   size_t slot, count, i;
+
+   if((attr == NULL) || (pool == NULL)) {
+      return NULL;
+   }
+   if(!growXMLPoolTable(&pool->attributes, &pool->attributesLength,
+                        pool->attributesCount)) {
+      return NULL;
+   }
+
+   hash = 0;
+   count = 0;
+   for(a = attr; a != NULL; a = a->next) {
+      hash = (hash ^ hashXMLString(a->name, strlen(a->name))) * 0x100000001b3ULL;
+      hash = (hash ^ hashXMLString(a->value, strlen(a->value))) * 0x100000001b3ULL;
+      count++;
+   }
+   for(slot = hash & (pool->attributesLength - 1);
+       pool->attributes[slot].content != NULL;
+       slot = (slot + 1) & (pool->attributesLength - 1)) {
+      if((pool->attributes[slot].hash == hash) &&
+         isSameXMLPoolAttributes(pool->attributes[slot].content, attr)) {
+         return pool->attributes[slot].content;
+      }
+   }
+
+   /* contiguous copy, with pooled strings */
+   if((copy = allocXMLPoolMemory(count * sizeof(XML_Attribute), pool)) == NULL) {
+      return NULL;
+   }
+   for(a = attr, i = 0; a != NULL; a = a->next, i++) {
+      copy[i].name = poolXMLString(a->name, strlen(a->name), pool);
+      copy[i].value = poolXMLString(a->value, strlen(a->value), pool);
+      if((copy[i].name == NULL) || (copy[i].value == NULL)) {
+         return NULL;
+      }
+      copy[i].id = a->id;
+      copy[i].ns = a->ns;
+      copy[i].local = a->local;
+      copy[i].next = (a->next == NULL) ? NULL : &copy[i + 1];
+   }
+   pool->attributes[slot].content = copy;
+   pool->attributes[slot].hash = hash;
+   pool->attributesCount++;
+
+   return copy;
+}
+
+
+/**
+ * \brief Replace a node's name, value and attributes by pooled ones.
+ * Node's own copies are freed. If node's contents already belong to another
+ * pool, they are left to it, so a node can follow its subtree to another file.
+ * Node is left unchanged if an error happens.
+ *
+ * \param n     Shared node.
+ * \param pool  Used pool.
+ * \return      1 on success, 0 if an error happened.
+ */
+int shareXMLNode(XML_Node* n, XML_Pool* pool)
+{
+   char *name, *value;
+   XML_Attribute* attr;
+
+   if((n == NULL) || (pool == NULL)) {
+      logError("Trying to share a NULL node, or in a NULL pool", __FILE__, __LINE__);
+      return 0;
+   }
+   if(isXMLNodePooled(n)) {
+      return 1;
+   }
+
+   /* pooled attributes are decoded ones */
+   decodeXMLNodeAttributes(n);
+   name = value = NULL;
+   attr = NULL;
+   if(((n->name != NULL) &&
+       ((name = poolXMLString(n->name, strlen(n->name), pool)) == NULL)) ||
+      ((n->value != NULL) &&
+       ((value = poolXMLString(n->value, strlen(n->value), pool)) == NULL)) ||
+      ((n->attr != NULL) &&
+       ((attr = poolXMLAttributes(n->attr, pool)) == NULL))) {
+      return 0;
+   }
+
+   /* another pool keeps its contents */
+   if(!isXMLNodeShared(n)) {
+      if(n->name != NULL) {
+         logMem(LOG_FREE, n->name, "string", "node name", __FILE__, __LINE__);
+         free(n->name);
+      }
+      if(n->value != NULL) {
+         logMem(LOG_FREE, n->value, "string", "node value", __FILE__, __LINE__);
+         free(n->value);
+      }
+      if(n->attr != NULL) {
+         destroyXMLAttribute(n->attr);
+      }
+   }
+   n->name = name;
+   n->value = value;
+   n->attr = attr;
+   setXMLNodeShared(n, 1);
+
+   return 1;
+}
+
+
+/**
+ * \brief Check if a node can be pooled: its contents and children are, and
+ * it holds nothing proper to one occurrence.
+ */
+static int isXMLPoolNodeReadOnly(XML_Node* n)
+{
+   XML_Node** children;
+   int i;
+
+   if(!isXMLNodeShared(n) || isXMLNodePooled(n) ||
+      (getXMLNodeOffset(n) >= 0) || (getXMLNodeLength(n) >= 0) ||
+      ((n->data != NULL) && ((n->data->rawAttr != NULL) || (n->data->refs != 0) ||
+                             (getXMLSortedChildren(n) != NULL)))) {
+      return 0;
+   }
+   if(n->cc == 0) {
+      return 1;
+   }
+   if(!isXMLNodeFrozen(n)) {
+      return 0;
+   }
+   children = getXMLChildren(n);
+   for(i = 0; i < n->cc; i++) {
+      if(!isXMLNodePooled(children[i])) {
+         return 0;
+      }
+   }
+
+   return 1;
+}
+
+
+/**
+ * \brief Hash a node by its pooled contents and children, compared by address.
+ */
+static unsigned long long hashXMLPoolNode(XML_Node* n)
+{
+   unsigned long long hash;
+   int i;
+
+   hash = 0xcbf29ce484222325ULL;
+   hash = (hash ^ (uintptr_t)n->name) * 0x100000001b3ULL;
+   hash = (hash ^ (uintptr_t)n->value) * 0x100000001b3ULL;
+   hash = (hash ^ (uintptr_t)n->attr) * 0x100000001b3ULL;
+   hash = (hash ^ (unsigned int)getXMLNodeNamespace(n)) * 0x100000001b3ULL;
+   hash = (hash ^ (unsigned int)getXMLNodeLocalName(n)) * 0x100000001b3ULL;
+   for(i = 0; i < n->cc; i++) {
+      hash = (hash ^ (uintptr_t)getXMLChildren(n)[i]) * 0x100000001b3ULL;
+   }
+
+   /* addresses' low bits are always 0, and slots are taken from them */
+   return hash ^ (hash >> 32);
+}
+
+
+/**
+ * \brief Check if two nodes have the same pooled contents and children.
+ */
+static int isSameXMLPoolNode(XML_Node* a, XML_Node* b)
+{
+   int i;
+
+   if((a->name != b->name) || (a->value != b->value) || (a->attr != b->attr) ||
+      (a->cc != b->cc) || (getXMLNodeNamespace(a) != getXMLNodeNamespace(b)) ||
+      (getXMLNodeLocalName(a) != getXMLNodeLocalName(b))) {
+      return 0;
+   }
+   for(i = 0; i < a->cc; i++) {
+      if(getXMLChildren(a)[i] != getXMLChildren(b)[i]) {
+         return 0;
+      }
+   }
+
+   return 1;
+}
+
+
+/**
+ * \brief Replace a read-only child by its pooled copy.
+ * Node must be shared by shareXMLNode(), and its children pooled already, so
+ * subtrees are pooled from their leaves up. Its parent's children are frozen,
+ * see freezeXMLNodeChildren(), and node is replaced in them by the identical
+ * pooled node, or by its own copy in pool's chunks. Node is then freed, and
+ * mustn't be used anymore.
+ * Node is left unchanged if it has no parent, holds offsets, undecoded
+ * attributes or sorted children, or if an error happens.
+ *
+ * \param n     Pooled node.
+ * \param pool  Pool holding node's contents.
+ * \return      1 if node was pooled, 0 if it wasn't.
+ */
+int poolXMLNode(XML_Node* n, XML_Pool* pool)
+{
+   XML_Node *parent, *copy, **children;
+   unsigned long long hash;
+   size_t slot;
+   int i;
+
+   if((n == NULL) || (pool == NULL)) {
+      logError("Trying to pool a NULL node, or in a NULL pool", __FILE__, __LINE__);
+      return 0;
+   }
+   if(((parent = n->parent) == NULL) || !isXMLPoolNodeReadOnly(n) ||
+      !freezeXMLNodeChildren(parent) ||
+      !growXMLPoolTable(&pool->nodes, &pool->nodesLength, pool->nodesCount)) {
+      return 0;
+   }
+   children = getXMLChildren(parent);
+   for(i = parent->cc - 1; children[i] != n; i--);
+
+   hash = hashXMLPoolNode(n);
+   for(slot = hash & (pool->nodesLength - 1);
+       pool->nodes[slot].content != NULL;
+       slot = (slot + 1) & (pool->nodesLength - 1)) {
+      copy = pool->nodes[slot].content;
+      if((pool->nodes[slot].hash == hash) && isSameXMLPoolNode(copy, n)) {
+         replaceXMLNodeChild(parent, i, copy);
+         destroyXMLNode(n);
+         return 1;
+      }
+   }
+
+   /* node's data and children array move with it */
+   if((copy = allocXMLPoolMemory(sizeof(XML_Node), pool)) == NULL) {
+      return 0;
+   }
+   *copy = *n;
+   copy->parent = NULL;
+   setXMLNodeShared(copy, 2);
+   replaceXMLNodeChild(parent, i, copy);
+   logMem(LOG_FREE, n, "XML_Node", "node", __FILE__, __LINE__);
+   free(n);
+   pool->nodes[slot].content = copy;
+   pool->nodes[slot].hash = hash;
+   pool->nodesCount++;
+
+   return 1;
+}
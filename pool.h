@@ -0,0 +1,86 @@
+/**
+ * \file pool.h
+ * \brief Shared XML contents related definitions
+ *
+ * Definition of a XML_Pool structure, which stores identical strings and
+ * attributes lists once. Nodes parsed with a pool point to its contents
+ * instead of owning copies, so repetitive files take less memory. Pooled
+ * contents are allocated in large chunks, and freed with the pool only.
+ *
+ * Read-only subtrees are hash-consed the same way: a node whose contents and
+ * children are pooled is stored once, and identical subtrees of other parents
+ * are replaced by it. Such a node has no parent nor siblings, its parent
+ * linking its children through its frozen array only, see
+ * freezeXMLNodeChildren().
+ *
+ * \author François-Xavier Balu \<fx.balu@gmail.com\>
+ * \date 17 octobre 2026
+ */
+
+
+#ifndef POOL_H_INCLUDED
+#define POOL_H_INCLUDED
+
+
+#include <stddef.h>     /* size_t */
+
+#include "attribute.h"  /* XML_Attribute */
+#include "node.h"       /* XML_Node */
+
+
+/**
+ * \brief Length of a pool's memory chunk, in bytes.
+ */
+#ifndef XML_POOL_CHUNK_LENGTH
+#define XML_POOL_CHUNK_LENGTH  65536
+#endif /* XML_POOL_CHUNK_LENGTH */
+
+
+/**
+ * \brief Memory chunk, from which pooled contents are allocated.
+ */
+typedef struct XML_PoolChunk {
+   struct XML_PoolChunk* next;   /**< Previously allocated chunk. */
+   size_t used;                  /**< Used bytes in data. */
+   size_t length;                /**< Allocated bytes in data. */
+   char data[];                  /**< Pooled contents. */
+} XML_PoolChunk;
+
+
+/**
+ * \brief Slot of a pool's table.
+ */
+typedef struct XML_PoolEntry {
+   void* content;             /**< Pooled string, attributes or node, NULL if
+                                   free. */
+   unsigned long long hash;   /**< Content's hash. */
+} XML_PoolEntry;
+
+
+/**
+ * \brief Pool of shared strings, attributes lists and read-only nodes.
+ */
+typedef struct XML_Pool {
+   XML_PoolChunk* chunks;        /**< Last allocated chunk. */
+   XML_PoolEntry* strings;       /**< Pooled strings, open addressing table. */
+   size_t stringsLength;         /**< Slots in strings, power of 2. */
+   size_t stringsCount;          /**< Used slots in strings. */
+   XML_PoolEntry* attributes;    /**< Pooled attributes lists, same way. */
+   size_t attributesLength;      /**< Slots in attributes, power of 2. */
+   size_t attributesCount;       /**< Used slots in attributes. */
+   XML_PoolEntry* nodes;         /**< Pooled nodes, same way. */
+   size_t nodesLength;           /**< Slots in nodes, power of 2. */
+   size_t nodesCount;            /**< Used slots in nodes. */
+} XML_Pool;
+
+
+XML_Pool* createXMLPool(void);
+void destroyXMLPool(XML_Pool* pool);
+
+char* poolXMLString(const char* str, size_t length, XML_Pool* pool);
+XML_Attribute* poolXMLAttributes(XML_Attribute* attr, XML_Pool* pool);
+int shareXMLNode(XML_Node* n, XML_Pool* pool);
+int poolXMLNode(XML_Node* n, XML_Pool* pool);
+
+
+#endif /* POOL_H_INCLUDED */
@@ -0,0 +1,466 @@
+/**
+ * \file projection.c
+ * \brief XML parsing projections related functions
+ *
+ * Functions to use a XML_Projection structure.
+ *
+ * A skipped element is read character by character up to its closing tag,
+ * only names of tags being read to check that they match. It can be read
+ * over several calls, skipped elements' names being kept in the projection. When some names are
+ * kept at any depth, names of skipped elements are stacked, so the parser can
+ * create the ancestors of a kept element found inside them.
+ *
+ * \author François-Xavier Balu \<fx.balu@gmail.com\>
+ * \date 17 octobre 2026
+ */
+
+
+#include <stdio.h>      /* getc(), ungetc(), fseek(), ftell() */
+#include <stdlib.h>     /* malloc(), calloc(), realloc(), free() */
+#include <string.h>     /* strlen(), strchr(), strcmp(), memcpy() */
+
+#include "../log.h"     /* logError(), logMem() */
+#include "error.h"      /* logXMLError() */
+#include "name.h"       /* internXMLName(), findXMLName() */
+#include "projection.h"
+
+
+/**
+ * \brief Read a path's names into identifiers.
+ *
+ * \param[out] length  Number of names.
+ * \return             Identifiers, NULL if an error happened.
+ */
+static int* readXMLProjectionPath(const char* path, int* length)
+{
+   const char* end;
+   int* ids;
+   int count;
+
+   count = 1;
+   for(end = path; (end = strchr(end, '/')) != NULL; end++) {
+      count++;
+   }
+   if((ids = malloc(count * sizeof(int))) == NULL) {
+      logError("Can't allocate memory for projected path", __FILE__, __LINE__);
+      return NULL;
+   }
+
+   /* empty names, as in "a//b", are ignored */
+   *length = 0;
+   while(*path != '\0') {
+      if((end = strchr(path, '/')) == NULL) {
+         end = path + strlen(path);
+      }
+      if(end > path) {
+         if((ids[*length] = internXMLName(path, end - path)) == XML_NO_NAME) {
+            free(ids);
+            return NULL;
+         }
+         (*length)++;
+      }
+      path = (*end == '/') ? end + 1 : end;
+   }
+
+   return ids;
+}
+
+
+/**
+ * \brief Create a projection.
+ *
+ * \param[in] keep   Kept elements, each one a path from the root such as
+ *                   "foo/bar", or a name without '/' kept at any depth.
+ * \param     count  Number of kept elements.
+ * \return           Created projection, NULL if an error happened.
+ */
+XML_Projection* createXMLProjection(const char** keep, int count)
+{
+   XML_Projection* p;
+   int i, length;
+
+   if((keep == NULL) && (count > 0)) {
+      logError("Trying to create a projection from NULL elements", __FILE__, __LINE__);
+      return NULL;
+   }
+   if((p = calloc(1, sizeof(XML_Projection))) == NULL) {
+      logError("Can't allocate memory for XML_Projection", __FILE__, __LINE__);
+      return NULL;
+   }
+   logMem(LOG_ALLOC, p, "XML_Projection", "projection", __FILE__, __LINE__);
+
+   if((count > 0) &&
+      (((p->paths = calloc(count, sizeof(int*))) == NULL) ||
+       ((p->pathLengths = malloc(count * sizeof(int))) == NULL) ||
+       ((p->names = malloc(count * sizeof(int))) == NULL))) {
+      logError("Can't allocate memory for projected elements", __FILE__, __LINE__);
+      destroyXMLProjection(p);
+      return NULL;
+   }
+
+   for(i = 0; i < count; i++) {
+      if(strchr(keep[i], '/') == NULL) {
+         if((p->names[p->nameCount] = internXMLName(keep[i], strlen(keep[i]))) ==
+            XML_NO_NAME) {
+            destroyXMLProjection(p);
+            return NULL;
+         }
+         p->nameCount++;
+      }
+      else {
+         if((p->paths[p->pathCount] = readXMLProjectionPath(keep[i], &length)) == NULL) {
+            destroyXMLProjection(p);
+            return NULL;
+         }
+         p->pathLengths[p->pathCount] = length;
+         p->pathCount++;
+      }
+   }
+
+   return p;
+}
+
+
+/**
+ * \brief Destroy a projection.
+ *
+ * \param p  Destroyed projection.
+ */
+void destroyXMLProjection(XML_Projection* p)
+{
+   int i;
+
+   if(p == NULL) {
+      logError("Trying to destroy a NULL XML_Projection", __FILE__, __LINE__);
+   }
+   else {
+      for(i = 0; i < p->pathCount; i++) {
+         free(p->paths[i]);
+      }
+      free(p->paths);
+      free(p->pathLengths);
+      free(p->names);
+      free(p->pending);
+      logMem(LOG_FREE, p, "XML_Projection", "projection", __FILE__, __LINE__);
+      free(p);
+   }
+}
+
+
+/**
+ * \brief Match an element against a projection.
+ * The root is always kept, at least to hold elements kept by name.
+ *
+ * \param p       Projection.
+ * \param parent  Element's parent, NULL for the root.
+ * \param id      Element's name identifier.
+ * \return        Whether element is skipped, kept, or kept with only some of
+ *                its children.
+ */
+XML_ProjectionMatch matchXMLProjection(XML_Projection* p, XML_Node* parent, int id)
+{
+   XML_ProjectionMatch match;
+   XML_Node* n;
+   int i, depth, k;
+
+   for(i = 0; i < p->nameCount; i++) {
+      if(p->names[i] == id) {
+         return XML_PROJECTION_KEEP;
+      }
+   }
+
+   depth = 0;
+   for(n = parent; n != NULL; n = n->parent) {
+      depth++;
+   }
+
+   match = (parent == NULL) ? XML_PROJECTION_FILTER : XML_PROJECTION_SKIP;
+   for(i = 0; i < p->pathCount; i++) {
+      if((p->pathLengths[i] <= depth) || (p->paths[i][depth] != id)) {
+         continue;
+      }
+      for(n = parent, k = depth - 1; (n != NULL) && (p->paths[i][k] == n->id);
+          n = n->parent, k--);
+      if(n != NULL) {
+         continue;
+      }
+      if(p->pathLengths[i] == depth + 1) {
+         return XML_PROJECTION_KEEP;
+      }
+      match = XML_PROJECTION_FILTER;
+   }
+
+   return match;
+}
+
+
+/**
+ * \brief Stack a skipped element's name.
+ *
+ * \return  1 on success, 0 if an error happened.
+ */
+static int pushXMLProjectionName(XML_Projection* p, const char* name, size_t length)
+{
+   size_t capacity;
+   char* pending;
+
+   if(p->pendingLength + length + 1 > p->pendingCapacity) {
+      capacity = (p->pendingCapacity > 0) ? 2 * p->pendingCapacity : 256;
+      while(p->pendingLength + length + 1 > capacity) {
+         capacity *= 2;
+      }
+      if((pending = realloc(p->pending, capacity)) == NULL) {
+         logError("Can't reallocate memory for skipped names", __FILE__, __LINE__);
+         return 0;
+      }
+      p->pending = pending;
+      p->pendingCapacity = capacity;
+   }
+   memcpy(p->pending + p->pendingLength, name, length);
+   p->pending[p->pendingLength + length] = '\0';
+   p->pendingLength += length + 1;
+   p->depth++;
+
+   return 1;
+}
+
+
+/**
+ * \brief Get the innermost skipped element's name.
+ */
+static const char* getXMLProjectionTop(XML_Projection* p)
+{
+   size_t i;
+
+   for(i = p->pendingLength - 1; (i > 0) && (p->pending[i - 1] != '\0'); i--);
+
+   return p->pending + i;
+}
+
+
+/**
+ * \brief Read characters up to a tag's '>', skipping quoted values.
+ *
+ * \param c  Last read character.
+ * \return   Character before '>', EOF if it wasn't reached.
+ */
+static int skipXMLTagEnd(FILE* file, int c)
+{
+   int previous, quote;
+
+   previous = quote = 0;
+   while((c != '>') || quote) {
+      if(c == EOF) {
+         return EOF;
+      }
+      if(quote) {
+         if(c == quote) {
+            quote = 0;
+         }
+      }
+      else if((c == '"') || (c == '\'')) {
+         quote = c;
+      }
+      previous = c;
+      c = getc(file);
+   }
+
+   return previous;
+}
+
+
+/**
+ * \brief Check if a name is kept at any depth.
+ */
+static int isXMLProjectionName(XML_Projection* p, const char* name, size_t length)
+{
+   int i, id;
+
+   if((p->nameCount == 0) || ((id = findXMLName(name, length)) == XML_NO_NAME)) {
+      return 0;
+   }
+   for(i = 0; i < p->nameCount; i++) {
+      if(p->names[i] == id) {
+         return 1;
+      }
+   }
+
+   return 0;
+}
+
+
+/**
+ * \brief Start skipping an element, whose start tag was just read.
+ * Element is then read by continueXMLSkip(), the projection holding the
+ * skipped elements between calls.
+ *
+ * \param tag  Skipped element's start tag.
+ * \param p    Projection.
+ * \return     1 on success, 0 if an error happened.
+ */
+int startXMLSkip(XML_Tag* tag, XML_Projection* p)
+{
+   p->pendingLength = 0;
+   p->depth = 0;
+
+   return pushXMLProjectionName(p, tag->name, tag->nameLength);
+}
+
+
+/**
+ * \brief Go on skipping an element started by startXMLSkip(), within a budget.
+ * Reading stops after element's closing tag, or before the start tag of a
+ * descendant kept by name. In the latter case, getXMLProjectionPending()
+ * gives the names of the skipped elements holding it. It also stops before a
+ * tag once \p bytes were read, or XML_SKIP_EVERY tags, so a huge element is
+ * skipped over several calls.
+ *
+ * \param      file   Read file.
+ * \param      p      Projection.
+ * \param      bytes  Bytes read before returning, 0 for no limit.
+ * \param[out] read   Bytes read by this call.
+ * \return            0 if element was skipped, the number of skipped elements
+ *                    holding a kept one, XML_PROJECTION_AGAIN if the budget
+ *                    ran out, XML_PROJECTION_ERROR if an error happened.
+ */
+int continueXMLSkip(FILE* file, XML_Projection* p, long bytes, long* read)
+{
+   char name[XML_BUFFER_LENGTH];
+   const char* top;
+   size_t length;
+   long start;
+   int c, closing, tags, result;
+
+   start = ftell(file);
+   tags = 0;
+   result = XML_PROJECTION_ERROR;
+   while((c = getc(file)) != EOF) {
+      if(c != '<') {
+         continue;
+      }
+
+      /* budget is checked between tags, '<' being read again next call */
+      if((++tags > XML_SKIP_EVERY) || ((bytes > 0) && (ftell(file) - 1 - start >= bytes))) {
+         ungetc(c, file);
+         result = XML_PROJECTION_AGAIN;
+         break;
+      }
+
+      /* declarations, comments and processing instructions */
+      c = getc(file);
+      if((c == '!') || (c == '?')) {
+         if(skipXMLTagEnd(file, c) == EOF) {
+            c = EOF;
+            break;
+         }
+         continue;
+      }
+
+      /* reads tag's name */
+      closing = (c == '/');
+      if(closing) {
+         c = getc(file);
+      }
+      for(length = 0; (c != EOF) && (c != '>') && (c != '/') && (c != ' ') &&
+                      (c != '\t') && (c != '\n') && (c != '\r'); length++) {
+         if(length + 1 >= XML_BUFFER_LENGTH) {
+            logXMLError("XML reading buffer name is full", file);
+            length = XML_BUFFER_LENGTH;
+            break;
+         }
+         name[length] = c;
+         c = getc(file);
+      }
+      if(length >= XML_BUFFER_LENGTH) {
+         break;
+      }
+      name[length] = '\0';
+
+      /* closing tag, checked against the innermost skipped element */
+      if(closing) {
+         top = getXMLProjectionTop(p);
+         if(strcmp(name, top) != 0) {
+            logXMLError("Closing tag doesn't match skipped element", file);
+            break;
+         }
+         if((c = skipXMLTagEnd(file, c)) == EOF) {
+            break;
+         }
+         p->pendingLength = top - p->pending;
+         p->depth--;
+         if(p->depth == 0) {
+            result = 0;
+            break;
+         }
+      }
+      /* start tag of a kept element, to be read again by the parser */
+      else if(isXMLProjectionName(p, name, length)) {
+         if(fseek(file, -(long)(length + 2), SEEK_CUR) != 0) {
+            logError("Can't go back to a kept element", __FILE__, __LINE__);
+            break;
+         }
+         result = p->depth;
+         break;
+      }
+      /* start tag, or empty element tag */
+      else {
+         if((c = skipXMLTagEnd(file, c)) == EOF) {
+            break;
+         }
+         if((c != '/') && !pushXMLProjectionName(p, name, length)) {
+            break;
+         }
+      }
+   }
+
+   if(c == EOF) {
+      logXMLError("Reached EOF while skipping an element", file);
+   }
+   *read = ftell(file) - start;
+
+   return result;
+}
+
+
+/**
+ * \brief Skip an element, whose start tag was just read.
+ * Element is read in a single call, as by startXMLSkip() and continueXMLSkip()
+ * without budget.
+ *
+ * \param file  Read file.
+ * \param tag   Skipped element's start tag.
+ * \param p     Projection.
+ * \return      0 if element was skipped, the number of skipped elements
+ *              holding a kept one, XML_PROJECTION_ERROR if an error happened.
+ */
+int skipXMLElement(FILE* file, XML_Tag* tag, XML_Projection* p)
+{
+   long read;
+   int skipped;
+
+   if(!startXMLSkip(tag, p)) {
+      return XML_PROJECTION_ERROR;
+   }
+   while((skipped = continueXMLSkip(file, p, 0, &read)) == XML_PROJECTION_AGAIN);
+
+   return skipped;
+}
+
+
+/**
+ * \brief Get the name of a skipped element holding a kept one.
+ *
+ * \param p  Projection.
+ * \param i  Element's depth, from 0 for the outermost skipped element.
+ * \return   Element's name.
+ */
+const char* getXMLProjectionPending(XML_Projection* p, int i)
+{
+   const char* name;
+
+   for(name = p->pending; i > 0; i--) {
+      name += strlen(name) + 1;
+   }
+
+   return name;
+}
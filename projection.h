@@ -0,0 +1,82 @@
+/**
+ * \file projection.h
+ * \brief XML parsing projections related definitions
+ *
+ * Definition of a XML_Projection structure, the elements a parsing keeps.
+ * Elements are kept by path from the root, as for getXMLNode(), or by name at
+ * any depth. A kept element comes with its whole subtree and its ancestors,
+ * and any other element is skipped by only matching its tags, without
+ * creating nodes or reading attributes and values.
+ *
+ * \author François-Xavier Balu \<fx.balu@gmail.com\>
+ * \date 17 octobre 2026
+ */
+
+
+#ifndef PROJECTION_H_INCLUDED
+#define PROJECTION_H_INCLUDED
+
+
+#include <stdio.h>   /* FILE */
+#include <stddef.h>  /* size_t */
+
+#include "node.h"    /* XML_Node */
+#include "tag.h"     /* XML_Tag */
+
+
+/**
+ * \brief Matching of an element against a projection.
+ */
+typedef enum XML_ProjectionMatch {
+   XML_PROJECTION_SKIP,    /**< Element and its subtree are skipped. */
+   XML_PROJECTION_FILTER,  /**< Element is kept, its children are matched. */
+   XML_PROJECTION_KEEP     /**< Element and its subtree are kept. */
+} XML_ProjectionMatch;
+
+
+/**
+ * \brief Result of skipping an element, when an error happened.
+ */
+#define XML_PROJECTION_ERROR  (-1)
+
+/**
+ * \brief Result of skipping an element, when the call's budget ran out.
+ */
+#define XML_PROJECTION_AGAIN  (-2)
+
+
+/**
+ * \brief Default number of tags read by a call skipping an element.
+ */
+#ifndef XML_SKIP_EVERY
+#define XML_SKIP_EVERY  4096
+#endif /* XML_SKIP_EVERY */
+
+
+/**
+ * \brief Elements kept by a parsing.
+ */
+typedef struct XML_Projection {
+   int** paths;         /**< Kept paths, as name identifiers. */
+   int* pathLengths;    /**< Number of names in each path. */
+   int pathCount;       /**< Number of kept paths. */
+   int* names;          /**< Names kept at any depth. */
+   int nameCount;       /**< Number of names kept at any depth. */
+   char* pending;       /**< Names of skipped elements holding a kept one. */
+   size_t pendingLength;   /**< Used bytes in pending. */
+   size_t pendingCapacity; /**< Allocated bytes in pending. */
+   int depth;           /**< Number of names in pending. */
+} XML_Projection;
+
+
+XML_Projection* createXMLProjection(const char** keep, int count);
+void destroyXMLProjection(XML_Projection* p);
+
+XML_ProjectionMatch matchXMLProjection(XML_Projection* p, XML_Node* parent, int id);
+int startXMLSkip(XML_Tag* tag, XML_Projection* p);
+int continueXMLSkip(FILE* file, XML_Projection* p, long bytes, long* read);
+int skipXMLElement(FILE* file, XML_Tag* tag, XML_Projection* p);
+const char* getXMLProjectionPending(XML_Projection* p, int i);
+
+
+#endif /* PROJECTION_H_INCLUDED */
@@ -0,0 +1,176 @@
+/**
+ * \file reclaim.c
+ * \brief Background destruction of XML files related functions
+ *
+ * Files waiting for destruction are queued under a mutex, the reclaimer thread
+ * destroying them in order. Draining waits for the queue to be empty, then
+ * joins the thread.
+ *
+ * \author François-Xavier Balu \<fx.balu@gmail.com\>
+ * \date 17 octobre 2026
+ */
+
+
+#include <pthread.h>    /* pthread_create(), pthread_join(), pthread_mutex_*(),
+                           pthread_cond_*() */
+#include <stdlib.h>     /* malloc(), free() */
+
+#include "../log.h"     /* logError(), logMem() */
+#include "reclaim.h"
+
+
+/**
+ * \brief A file waiting for destruction.
+ */
+typedef struct XML_Reclaimed {
+   XML_File* xml;               /**< Destroyed file. */
+   struct XML_Reclaimed* next;  /**< Next file in queue. */
+} XML_Reclaimed;
+
+
+static pthread_mutex_t reclaimLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t reclaimQueued = PTHREAD_COND_INITIALIZER;
+static XML_Reclaimed* reclaimFirst = NULL;  /* oldest queued file */
+static XML_Reclaimed* reclaimLast = NULL;   /* newest queued file */
+static int reclaimCount = 0;                /* queued files, and the one being destroyed */
+static int reclaimStopping = 0;             /* 1 once thread must stop when drained */
+static int reclaimStarted = 0;              /* 1 if thread must be joined */
+static pthread_t reclaimThread;
+
+
+/**
+ * \brief Destroy queued files until drained and asked to stop.
+ */
+static void* runXMLReclaimer(void* unused)
+{
+   XML_Reclaimed* r;
+
+   (void)unused;
+   pthread_mutex_lock(&reclaimLock);
+   for(;;) {
+      while((reclaimFirst == NULL) && !reclaimStopping) {
+         pthread_cond_wait(&reclaimQueued, &reclaimLock);
+      }
+      if(reclaimFirst == NULL) {
+         break;
+      }
+      r = reclaimFirst;
+      reclaimFirst = r->next;
+      if(reclaimFirst == NULL) {
+         reclaimLast = NULL;
+      }
+
+      /* destroyed without the lock, queueing goes on meanwhile */
+      pthread_mutex_unlock(&reclaimLock);
+      destroyXMLFile(r->xml);
+      logMem(LOG_FREE, r, "XML_Reclaimed", "reclaimed file", __FILE__, __LINE__);
+      free(r);
+      pthread_mutex_lock(&reclaimLock);
+      reclaimCount--;
+   }
+   pthread_mutex_unlock(&reclaimLock);
+
+   return NULL;
+}
+
+
+/**
+ * \brief Hand a XML_File to the reclaimer thread, which destroys it.
+ * The file mustn't be used anymore once given. If it can't be queued, it is
+ * destroyed by the calling thread instead.
+ *
+ * \param xml  Destroyed XML_File.
+ * \return     1 if file was queued, 0 if it was destroyed synchronously.
+ */
+int destroyXMLFileAsync(XML_File* xml)
+{
+   XML_Reclaimed* r;
+
+   if(xml == NULL) {
+      logError("Trying to destroy a NULL XML_File", __FILE__, __LINE__);
+      return 0;
+   }
+   if((r = malloc(sizeof(XML_Reclaimed))) == NULL) {
+      logError("Can't allocate memory for XML_Reclaimed", __FILE__, __LINE__);
+      destroyXMLFile(xml);
+      return 0;
+   }
+   logMem(LOG_ALLOC, r, "XML_Reclaimed", "reclaimed file", __FILE__, __LINE__);
+   r->xml = xml;
+   r->next = NULL;
+
+   pthread_mutex_lock(&reclaimLock);
+   /* thread may already have stopped, while being drained */
+   if(reclaimStarted && reclaimStopping) {
+      pthread_mutex_unlock(&reclaimLock);
+      logMem(LOG_FREE, r, "XML_Reclaimed", "reclaimed file", __FILE__, __LINE__);
+      free(r);
+      destroyXMLFile(xml);
+      return 0;
+   }
+   if(!reclaimStarted) {
+      reclaimStopping = 0;
+      if(pthread_create(&reclaimThread, NULL, runXMLReclaimer, NULL) != 0) {
+         pthread_mutex_unlock(&reclaimLock);
+         logError("Can't start reclaimer thread", __FILE__, __LINE__);
+         logMem(LOG_FREE, r, "XML_Reclaimed", "reclaimed file", __FILE__, __LINE__);
+         free(r);
+         destroyXMLFile(xml);
+         return 0;
+      }
+      reclaimStarted = 1;
+   }
+   if(reclaimLast != NULL) {
+      reclaimLast->next = r;
+   }
+   else {
+      reclaimFirst = r;
+   }
+   reclaimLast = r;
+   reclaimCount++;
+   pthread_cond_signal(&reclaimQueued);
+   pthread_mutex_unlock(&reclaimLock);
+
+   return 1;
+}
+
+
+/**
+ * \brief Count files not destroyed yet by the reclaimer thread.
+ *
+ * \return  Number of queued files, and of the one being destroyed.
+ */
+int countXMLReclaimed(void)
+{
+   int count;
+
+   pthread_mutex_lock(&reclaimLock);
+   count = reclaimCount;
+   pthread_mutex_unlock(&reclaimLock);
+
+   return count;
+}
+
+
+/**
+ * \brief Wait for every given file to be destroyed, and stop the reclaimer
+ * thread, as at shutdown. A later destroyXMLFileAsync() starts it again,
+ * files given while draining being destroyed synchronously.
+ */
+void drainXMLReclaimer(void)
+{
+   pthread_mutex_lock(&reclaimLock);
+   if(!reclaimStarted) {
+      pthread_mutex_unlock(&reclaimLock);
+      return;
+   }
+   reclaimStopping = 1;
+   pthread_cond_signal(&reclaimQueued);
+   pthread_mutex_unlock(&reclaimLock);
+
+   pthread_join(reclaimThread, NULL);
+
+   pthread_mutex_lock(&reclaimLock);
+   reclaimStarted = 0;
+   pthread_mutex_unlock(&reclaimLock);
+}
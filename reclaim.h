@@ -0,0 +1,26 @@
+/**
+ * \file reclaim.h
+ * \brief Background destruction of XML files related definitions
+ *
+ * A reclaimer thread destroys XML files handed to it, so that the thread
+ * releasing a big tree doesn't wait for every node to be freed. The thread is
+ * started with the first file it gets, and stops once drained.
+ *
+ * \author François-Xavier Balu \<fx.balu@gmail.com\>
+ * \date 17 octobre 2026
+ */
+
+
+#ifndef RECLAIM_H_INCLUDED
+#define RECLAIM_H_INCLUDED
+
+
+#include "xml.h"  /* XML_File */
+
+
+int destroyXMLFileAsync(XML_File* xml);
+int countXMLReclaimed(void);
+void drainXMLReclaimer(void);
+
+
+#endif /* RECLAIM_H_INCLUDED */
@@ -0,0 +1,331 @@
+/**
+ * \file reload.c
+ * \brief Hot reloaded XML files related functions
+ *
+ * Functions to use a XML_Reload structure.
+ *
+ * A reader stores the current epoch in its slot, then loads the current
+ * version. A writer swaps the current version, increments the epoch, then
+ * waits until no reader is still in an older epoch before destroying the
+ * replaced version. All these accesses are sequentially consistent, so a
+ * reader the writer didn't see in an older epoch can only load the new
+ * version.
+ *
+ * \author François-Xavier Balu \<fx.balu@gmail.com\>
+ * \date 17 octobre 2026
+ */
+
+
+#include <stdlib.h>     /* malloc(), free() */
+#include <string.h>     /* strlen(), strcpy() */
+#include <sched.h>      /* sched_yield() */
+
+#include "../log.h"     /* logError(), logMem() */
+#include "xml.h"        /* loadXMLFile(), destroyXMLFile() */
+#include "reload.h"
+
+
+/**
+ * \brief Load a version of a reloaded file.
+ *
+ * \return  Loaded file, NULL if it can't be parsed.
+ */
+static XML_File* loadXMLReloadVersion(XML_Reload* reload)
+{
+   XML_File* xml;
+
+   if((xml = loadXMLFile(reload->path)) == NULL) {
+      return NULL;
+   }
+   if(xml->root == NULL) {
+      logError("Can't parse new version of reloaded file", __FILE__, __LINE__);
+      destroyXMLFile(xml);
+      return NULL;
+   }
+   /* file isn't needed anymore, and readers must not share it */
+   if(xml->file != NULL) {
+      closeXMLFile(xml);
+   }
+   /* hashed before being shared, as hashing writes to nodes */
+   getXMLNodeHash(xml->root);
+
+   return xml;
+}
+
+
+/**
+ * \brief Create a hot reloaded XML file.
+ * First version is loaded immediately.
+ *
+ * \param[in] path  Path of reloaded file.
+ * \return          Created structure, NULL if file can't be loaded.
+ */
+XML_Reload* createXMLReload(const char* path)
+{
+   XML_Reload* reload;
+   XML_File* xml;
+   int i;
+
+   if(path == NULL) {
+      logError("Trying to reload a NULL path", __FILE__, __LINE__);
+      return NULL;
+   }
+   if((reload = malloc(sizeof(XML_Reload))) == NULL) {
+      logError("Can't allocate memory for XML_Reload", __FILE__, __LINE__);
+      return NULL;
+   }
+   logMem(LOG_ALLOC, reload, "XML_Reload", "reload", __FILE__, __LINE__);
+   if((reload->path = malloc((strlen(path) + 1) * sizeof(char))) == NULL) {
+      logError("Can't allocate memory for reload path", __FILE__, __LINE__);
+      free(reload);
+      return NULL;
+   }
+   strcpy(reload->path, path);
+
+   atomic_init(&reload->current, NULL);
+   atomic_init(&reload->epoch, 1);
+   for(i = 0; i < XML_RELOAD_MAX_READERS; i++) {
+      atomic_init(&reload->readers[i].epoch, 0);
+      atomic_init(&reload->readers[i].used, 0);
+   }
+   pthread_mutex_init(&reload->writer, NULL);
+   reload->threadStarted = 0;
+
+   if((xml = loadXMLReloadVersion(reload)) == NULL) {
+      destroyXMLReload(reload);
+      return NULL;
+   }
+   atomic_store(&reload->current, xml);
+
+   return reload;
+}
+
+
+/**
+ * \brief Destroy a hot reloaded file and its current version.
+ * Waits for background reloading, but readers must have stopped.
+ *
+ * \param reload  Destroyed structure.
+ */
+void destroyXMLReload(XML_Reload* reload)
+{
+   XML_File* xml;
+
+   if(reload == NULL) {
+      logError("Trying to destroy a NULL XML_Reload", __FILE__, __LINE__);
+   }
+   else {
+      waitXMLReload(reload);
+      if((xml = atomic_load(&reload->current)) != NULL) {
+         destroyXMLFile(xml);
+      }
+      pthread_mutex_destroy(&reload->writer);
+      free(reload->path);
+      logMem(LOG_FREE, reload, "XML_Reload", "reload", __FILE__, __LINE__);
+      free(reload);
+   }
+}
+
+
+/**
+ * \brief Register a reader thread.
+ * Each thread reading a reloaded file needs its own slot.
+ *
+ * \param reload  Read structure.
+ * \return        Reader's slot, NULL if all slots are used.
+ */
+XML_ReloadReader* registerXMLReloadReader(XML_Reload* reload)
+{
+   int i, unused;
+
+   if(reload == NULL) {
+      logError("Trying to register a reader of a NULL XML_Reload", __FILE__, __LINE__);
+      return NULL;
+   }
+
+   for(i = 0; i < XML_RELOAD_MAX_READERS; i++) {
+      unused = 0;
+      if(atomic_compare_exchange_strong(&reload->readers[i].used, &unused, 1)) {
+         return &reload->readers[i];
+      }
+   }
+
+   logError("No free reader slot in XML_Reload", __FILE__, __LINE__);
+   return NULL;
+}
+
+
+/**
+ * \brief Unregister a reader thread, outside of any read section.
+ *
+ * \param reader  Freed slot.
+ */
+void unregisterXMLReloadReader(XML_ReloadReader* reader)
+{
+   if(reader == NULL) {
+      logError("Trying to unregister a NULL reader", __FILE__, __LINE__);
+   }
+   else {
+      atomic_store(&reader->epoch, 0);
+      atomic_store(&reader->used, 0);
+   }
+}
+
+
+/**
+ * \brief Enter a read section.
+ * Returned version stays valid until leaveXMLReload(), even if a newer one is
+ * published meanwhile. Read sections can't be nested.
+ *
+ * \param reload  Read structure.
+ * \param reader  Calling thread's slot.
+ * \return        Current version.
+ */
+XML_File* enterXMLReload(XML_Reload* reload, XML_ReloadReader* reader)
+{
+   atomic_store(&reader->epoch, atomic_load(&reload->epoch));
+   return atomic_load(&reload->current);
+}
+
+
+/**
+ * \brief Leave a read section.
+ * Version returned by enterXMLReload() mustn't be used anymore.
+ *
+ * \param reader  Calling thread's slot.
+ */
+void leaveXMLReload(XML_ReloadReader* reader)
+{
+   atomic_store_explicit(&reader->epoch, 0, memory_order_release);
+}
+
+
+/**
+ * \brief Publish a new version of a reloaded file.
+ * Replaced version is destroyed once all readers that could see it have left
+ * their read section, so this call waits for them. A version with the same
+ * tree hash as current one is destroyed instead, without disturbing readers.
+ *
+ * \param xml     New version, owned by \p reload afterwards.
+ * \param reload  Modified structure.
+ * \return        1 if \p xml was published, 0 otherwise.
+ */
+int publishXMLReload(XML_File* xml, XML_Reload* reload)
+{
+   XML_File* old;
+   unsigned long target, epoch;
+   int i;
+
+   if((xml == NULL) || (reload == NULL)) {
+      logError("Trying to publish with NULL XML_File or XML_Reload",
+               __FILE__, __LINE__);
+      return 0;
+   }
+
+   if(xml->root != NULL) {
+      getXMLNodeHash(xml->root);
+   }
+
+   pthread_mutex_lock(&reload->writer);
+
+   /* current version's hash was computed before it was published */
+   old = atomic_load(&reload->current);
+   if((old != NULL) && (old->root != NULL) && (xml->root != NULL) &&
+      (getXMLNodeHash(old->root) == getXMLNodeHash(xml->root))) {
+      pthread_mutex_unlock(&reload->writer);
+      destroyXMLFile(xml);
+      return 0;
+   }
+
+   old = atomic_exchange(&reload->current, xml);
+   target = atomic_fetch_add(&reload->epoch, 1) + 1;
+
+   /* wait for readers still in an older epoch */
+   for(i = 0; i < XML_RELOAD_MAX_READERS; i++) {
+      while(atomic_load(&reload->readers[i].used) &&
+            ((epoch = atomic_load(&reload->readers[i].epoch)) != 0) &&
+            (epoch < target)) {
+         sched_yield();
+      }
+   }
+
+   pthread_mutex_unlock(&reload->writer);
+
+   if(old != NULL) {
+      destroyXMLFile(old);
+   }
+
+   return 1;
+}
+
+
+/**
+ * \brief Parse reloaded file again, and publish it.
+ * If the file can't be parsed, current version is kept.
+ *
+ * \param reload  Reloaded structure.
+ * \return        1 if a new version was published, 0 otherwise.
+ */
+int reloadXMLFile(XML_Reload* reload)
+{
+   XML_File* xml;
+
+   if(reload == NULL) {
+      logError("Trying to reload a NULL XML_Reload", __FILE__, __LINE__);
+      return 0;
+   }
+   if((xml = loadXMLReloadVersion(reload)) == NULL) {
+      return 0;
+   }
+
+   return publishXMLReload(xml, reload);
+}
+
+
+static void* runXMLReload(void* reload)
+{
+   reloadXMLFile(reload);
+   return NULL;
+}
+
+
+/**
+ * \brief Parse and publish reloaded file in a background thread.
+ * A previous background reloading is waited for first.
+ *
+ * \param reload  Reloaded structure.
+ * \return        1 if thread was started, 0 otherwise.
+ */
+int reloadXMLFileAsync(XML_Reload* reload)
+{
+   if(reload == NULL) {
+      logError("Trying to reload a NULL XML_Reload", __FILE__, __LINE__);
+      return 0;
+   }
+
+   waitXMLReload(reload);
+   if(pthread_create(&reload->thread, NULL, runXMLReload, reload) != 0) {
+      logError("Can't start reloading thread", __FILE__, __LINE__);
+      return 0;
+   }
+   reload->threadStarted = 1;
+
+   return 1;
+}
+
+
+/**
+ * \brief Wait for background reloading to finish.
+ *
+ * \param reload  Reloaded structure.
+ */
+void waitXMLReload(XML_Reload* reload)
+{
+   if(reload == NULL) {
+      logError("Trying to wait for a NULL XML_Reload", __FILE__, __LINE__);
+   }
+   else if(reload->threadStarted) {
+      pthread_join(reload->thread, NULL);
+      reload->threadStarted = 0;
+   }
+}
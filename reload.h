@@ -0,0 +1,70 @@
+/**
+ * \file reload.h
+ * \brief Hot reloaded XML files related definitions
+ *
+ * Definition of a XML_Reload structure, which holds the current version of a
+ * XML file while newer versions are parsed and published. Readers never lock:
+ * they announce the epoch they read in, and an old version is destroyed only
+ * once every reader has left the epochs where it was visible.
+ *
+ * \author François-Xavier Balu \<fx.balu@gmail.com\>
+ * \date 17 octobre 2026
+ */
+
+
+#ifndef RELOAD_H_INCLUDED
+#define RELOAD_H_INCLUDED
+
+
+#include <pthread.h>    /* pthread_t, pthread_mutex_t */
+#include <stdatomic.h>  /* atomic types */
+
+#include "xml.h"        /* XML_File */
+
+
+/**
+ * \brief Maximum number of registered reader threads.
+ */
+#ifndef XML_RELOAD_MAX_READERS
+#define XML_RELOAD_MAX_READERS  64
+#endif /* XML_RELOAD_MAX_READERS */
+
+
+/**
+ * \brief A reader thread's slot.
+ */
+typedef struct XML_ReloadReader {
+   atomic_ulong epoch;  /**< Epoch read in, 0 outside read sections. */
+   atomic_int used;     /**< 1 if a thread registered this slot. */
+} XML_ReloadReader;
+
+
+/**
+ * \brief Hot reloaded XML file.
+ */
+typedef struct XML_Reload {
+   char* path;                         /**< Path of reloaded file. */
+   _Atomic(XML_File*) current;         /**< Current version. */
+   atomic_ulong epoch;                 /**< Incremented at each publication. */
+   XML_ReloadReader readers[XML_RELOAD_MAX_READERS];  /**< Readers' slots. */
+   pthread_mutex_t writer;             /**< Serializes publications. */
+   pthread_t thread;                   /**< Background reloading thread. */
+   int threadStarted;                  /**< 1 if thread must be joined. */
+} XML_Reload;
+
+
+XML_Reload* createXMLReload(const char* path);
+void destroyXMLReload(XML_Reload* reload);
+
+XML_ReloadReader* registerXMLReloadReader(XML_Reload* reload);
+void unregisterXMLReloadReader(XML_ReloadReader* reader);
+XML_File* enterXMLReload(XML_Reload* reload, XML_ReloadReader* reader);
+void leaveXMLReload(XML_ReloadReader* reader);
+
+int publishXMLReload(XML_File* xml, XML_Reload* reload);
+int reloadXMLFile(XML_Reload* reload);
+int reloadXMLFileAsync(XML_Reload* reload);
+void waitXMLReload(XML_Reload* reload);
+
+
+#endif /* RELOAD_H_INCLUDED */
@@ -0,0 +1,525 @@
+/**
+ * \file reparse.c
+ * \brief Incremental reparsing related functions
+ *
+ * Functions to parse again only the edited part of a XML file. Blocks are
+ * compared from the beginning of the file until the first changed one, then
+ * from the end, old blocks being compared with new bytes shifted by the size
+ * difference. Bytes in between are the edit. Only the edited blocks are
+ * hashed again, so blocks have their own lengths.
+ *
+ * Nodes' offsets are relative to their previous sibling, or to their parent,
+ * so an edit only changes the lengths of the nodes enclosing it.
+ *
+ * \author François-Xavier Balu \<fx.balu@gmail.com\>
+ * \date 17 octobre 2026
+ */
+
+
+#include <stdio.h>      /* FILE, fopen(), fseek(), fread() */
+#include <stdlib.h>     /* malloc(), realloc(), free() */
+#include <string.h>     /* memmove() */
+
+#include "../log.h"     /* logError() */
+#include "name.h"       /* hashXMLString() */
+#include "namespace.h"  /* XML_NamespaceStack */
+#include "node.h"       /* XML_Node, getXMLNodeOffset(), getXMLNodeLength() */
+#include "xml.h"        /* parseXMLElement(), parseXMLFileAgain() */
+#include "reparse.h"
+
+
+/**
+ * \brief Hash a block of a file.
+ *
+ * \return  1 on success, 0 if the block can't be read entirely.
+ */
+static int hashXMLFileBlock(FILE* file, long offset, size_t length,
+                            unsigned long long* hash)
+{
+   char buffer[XML_REPARSE_BLOCK_LENGTH];
+
+   if((fseek(file, offset, SEEK_SET) != 0) ||
+      (fread(buffer, sizeof(char), length, file) != length)) {
+      return 0;
+   }
+   *hash = hashXMLString(buffer, length);
+
+   return 1;
+}
+
+
+/**
+ * \brief Hash a range of a file, as blocks of at most XML_REPARSE_BLOCK_LENGTH
+ * bytes.
+ *
+ * \param[out] hashes   Blocks' hashes.
+ * \param[out] lengths  Blocks' lengths.
+ * \return              1 on success, 0 if the range can't be read entirely.
+ */
+static int hashXMLFileRange(FILE* file, long start, long end,
+                            unsigned long long* hashes, size_t* lengths)
+{
+   size_t i;
+   long offset;
+
+   for(i = 0, offset = start; offset < end; offset += lengths[i++]) {
+      lengths[i] = ((end - offset) < XML_REPARSE_BLOCK_LENGTH) ?
+                   (size_t)(end - offset) : XML_REPARSE_BLOCK_LENGTH;
+      if(!hashXMLFileBlock(file, offset, lengths[i], &hashes[i])) {
+         logError("Can't read a block of XML file", __FILE__, __LINE__);
+         return 0;
+      }
+   }
+
+   return 1;
+}
+
+
+/**
+ * \brief Count blocks hashing a range.
+ */
+static size_t countXMLFileBlocks(long start, long end)
+{
+   return (end - start + XML_REPARSE_BLOCK_LENGTH - 1) / XML_REPARSE_BLOCK_LENGTH;
+}
+
+
+/**
+ * \brief Forget file's blocks, so it is parsed entirely next time.
+ */
+static void dropXMLFileBlocks(XML_File* xml)
+{
+   free(xml->blocks);
+   free(xml->blockLengths);
+   xml->blocks = NULL;
+   xml->blockLengths = NULL;
+   xml->blockCount = 0;
+}
+
+
+/**
+ * \brief Hash all blocks of a XML file, so it can be reparsed incrementally.
+ * Called once after loading the file; reparseXMLFile() keeps hashes up to
+ * date afterwards.
+ *
+ * \param xml  Indexed file.
+ * \return     1 on success, 0 if an error happened.
+ */
+int indexXMLFileBlocks(XML_File* xml)
+{
+   FILE* file;
+   size_t count;
+   long size;
+   int success;
+
+   if((xml == NULL) || (xml->path == NULL)) {
+      logError("Trying to index a NULL XML_File or path", __FILE__, __LINE__);
+      return 0;
+   }
+   if((file = fopen(xml->path, "r")) == NULL) {
+      logError("Can't open file with XML_File's path", __FILE__, __LINE__);
+      return 0;
+   }
+   if((fseek(file, 0, SEEK_END) != 0) || ((size = ftell(file)) < 0)) {
+      logError("Can't get size of XML file", __FILE__, __LINE__);
+      fclose(file);
+      return 0;
+   }
+
+   dropXMLFileBlocks(xml);
+   count = countXMLFileBlocks(0, size);
+   xml->blocks = malloc((count + 1) * sizeof(unsigned long long));
+   xml->blockLengths = malloc((count + 1) * sizeof(size_t));
+   success = (xml->blocks != NULL) && (xml->blockLengths != NULL);
+   if(!success) {
+      logError("Can't allocate memory for file blocks", __FILE__, __LINE__);
+   }
+   else if((success = hashXMLFileRange(file, 0, size, xml->blocks, xml->blockLengths))) {
+      xml->blockCount = count;
+      xml->size = size;
+   }
+   if(!success) {
+      dropXMLFileBlocks(xml);
+   }
+   fclose(file);
+
+   return success;
+}
+
+
+/**
+ * \brief Hash again the blocks of an edit, keeping the other ones.
+ * Blocks from \p start to \p oldEnd are replaced by blocks hashing bytes from
+ * \p start to \p newEnd, both ends being ends of blocks.
+ *
+ * \return  1 on success, 0 if an error happened.
+ */
+static int rehashXMLFileBlocks(XML_File* xml, FILE* file, long start, long oldEnd,
+                               long newEnd)
+{
+   unsigned long long* blocks;
+   size_t *lengths, first, last, count, total;
+   long offset;
+
+   /* old blocks of the edit */
+   for(first = 0, offset = 0; (first < xml->blockCount) && (offset < start); first++) {
+      offset += xml->blockLengths[first];
+   }
+   for(last = first; (last < xml->blockCount) && (offset < oldEnd); last++) {
+      offset += xml->blockLengths[last];
+   }
+   count = countXMLFileBlocks(start, newEnd);
+   total = xml->blockCount - (last - first) + count;
+
+   if(count > last - first) {
+      if((blocks = realloc(xml->blocks, (total + 1) * sizeof(unsigned long long))) == NULL) {
+         logError("Can't allocate memory for file blocks", __FILE__, __LINE__);
+         return 0;
+      }
+      xml->blocks = blocks;
+      if((lengths = realloc(xml->blockLengths, (total + 1) * sizeof(size_t))) == NULL) {
+         logError("Can't allocate memory for file blocks", __FILE__, __LINE__);
+         return 0;
+      }
+      xml->blockLengths = lengths;
+   }
+   memmove(xml->blocks + first + count, xml->blocks + last,
+           (xml->blockCount - last) * sizeof(unsigned long long));
+   memmove(xml->blockLengths + first + count, xml->blockLengths + last,
+           (xml->blockCount - last) * sizeof(size_t));
+   xml->blockCount = total;
+   xml->size += newEnd - oldEnd;
+
+   return hashXMLFileRange(file, start, newEnd, xml->blocks + first,
+                           xml->blockLengths + first);
+}
+
+
+/**
+ * \brief Find which bytes of a XML file changed since it was indexed.
+ * Bytes from \p start to \p oldEnd in indexed file were replaced by bytes
+ * from \p start to \p newEnd in current file. Range is accurate to a block.
+ *
+ * \param[in]  xml     Indexed file.
+ * \param[out] start   First changed byte.
+ * \param[out] oldEnd  End of changed bytes in indexed file.
+ * \param[out] newEnd  End of changed bytes in current file.
+ * \return             1 if file changed, 0 if it didn't, -1 on error.
+ */
+int findXMLFileEdit(XML_File* xml, long* start, long* oldEnd, long* newEnd)
+{
+   unsigned long long hash;
+   size_t first, last;
+   long size, delta, offset;
+   FILE* file;
+
+   if((xml == NULL) || (xml->path == NULL) || (xml->blocks == NULL)) {
+      logError("Trying to compare a XML_File which wasn't indexed",
+               __FILE__, __LINE__);
+      return -1;
+   }
+   if((file = fopen(xml->path, "r")) == NULL) {
+      logError("Can't open file with XML_File's path", __FILE__, __LINE__);
+      return -1;
+   }
+   if((fseek(file, 0, SEEK_END) != 0) || ((size = ftell(file)) < 0)) {
+      logError("Can't get size of XML file", __FILE__, __LINE__);
+      fclose(file);
+      return -1;
+   }
+   delta = size - xml->size;
+
+   /* first changed block */
+   for(first = 0, offset = 0; first < xml->blockCount; first++) {
+      if(!hashXMLFileBlock(file, offset, xml->blockLengths[first], &hash) ||
+         (hash != xml->blocks[first])) {
+         break;
+      }
+      offset += xml->blockLengths[first];
+   }
+   if((first == xml->blockCount) && (delta == 0)) {
+      fclose(file);
+      return 0;
+   }
+   *start = offset;
+
+   /* last changed block, old blocks being moved by size difference */
+   *oldEnd = xml->size;
+   for(last = xml->blockCount; last > first; last--) {
+      offset = *oldEnd - xml->blockLengths[last - 1];
+      if((offset + delta < *start) ||
+         !hashXMLFileBlock(file, offset + delta, xml->blockLengths[last - 1], &hash) ||
+         (hash != xml->blocks[last - 1])) {
+         break;
+      }
+      *oldEnd = offset;
+   }
+   *newEnd = *oldEnd + delta;
+
+   fclose(file);
+   return 1;
+}
+
+
+/**
+ * \brief Open a namespace scope for each ancestor of a node, from the root.
+ *
+ * \return  1 on success, 0 if an error happened.
+ */
+static int openXMLAncestorsScopes(XML_Node* n, XML_NamespaceStack* namespaces)
+{
+   if(n == NULL) {
+      return 1;
+   }
+
+   return openXMLAncestorsScopes(n->parent, namespaces) &&
+          openXMLNamespaceScope(namespaces) &&
+          resolveXMLNodeNamespaces(n, namespaces);
+}
+
+
+/**
+ * \brief Parse consecutive elements, until a given offset.
+ * Parsed elements are added to \p holder, with offsets from file's start.
+ * Non blank text between them would be a value of their parent, so it makes
+ * parsing fail.
+ *
+ * \return  1 on success, 0 if elements don't end exactly at \p end.
+ */
+static int parseXMLElements(FILE* file, long end, XML_NamespaceStack* namespaces,
+                            XML_Pool* pool, XML_AttributeFilter* filter,
+                            XML_Node* holder)
+{
+   XML_Node* node;
+
+   while(1) {
+      if((node = parseXMLElement(file, namespaces, pool, NULL, filter, NULL)) == NULL) {
+         return 0;
+      }
+      addXMLNodeToParent(holder, node);
+      if((getXMLNodeLength(node) < 0) ||
+         (getXMLNodeOffset(node) + getXMLNodeLength(node) >= end)) {
+         return (getXMLNodeOffset(node) + getXMLNodeLength(node) == end);
+      }
+      readXMLNodeValue(holder, file);
+      if(holder->value != NULL) {
+         return 0;
+      }
+   }
+}
+
+
+/**
+ * \brief Parse again the elements covering an edit, and replace them in tree.
+ * These are the children of the smallest element strictly enclosing the edit
+ * which cover it, or this element itself when its own text or tags were
+ * edited. Replaced nodes are destroyed, so pointers to them mustn't be used
+ * anymore. Following nodes keep their offsets, and only the lengths of
+ * enclosing nodes change. Elements are decoded with the file's attributes
+ * filter. A file loaded without XML_PARSE_OFFSETS must be parsed entirely
+ * again, as well as a file loaded with a projection or limits, or which
+ * recovered from errors: kept elements and errors' offsets depend on what
+ * precedes the edit.
+ *
+ * \param xml     Reparsed file, whose tree matches file before edit.
+ * \param start   First changed byte.
+ * \param oldEnd  End of changed bytes before edit.
+ * \param newEnd  End of changed bytes after edit.
+ * \return        1 on success, 0 if the tree must be parsed entirely again.
+ */
+int reparseXMLFileRange(XML_File* xml, long start, long oldEnd, long newEnd)
+{
+   XML_NamespaceStack* namespaces;
+   XML_Node *n, *child, *first, *last, *holder, *next;
+   long delta, nStart, childStart, firstStart, lastEnd, previous;
+   FILE* file;
+   int success;
+
+   if((xml == NULL) || (xml->path == NULL) || (xml->root == NULL)) {
+      logError("Trying to reparse a XML_File without path or tree",
+               __FILE__, __LINE__);
+      return 0;
+   }
+   if((xml->projection != NULL) || (xml->limits.maxRecords > 0) ||
+      (xml->limits.sampleEvery > 1) || (xml->limits.maxDepth > 0) ||
+      (xml->errorCount > 0)) {
+      return 0;
+   }
+   delta = newEnd - oldEnd;
+
+   /* smallest element strictly enclosing the edit, offsets being summed */
+   n = xml->root;
+   nStart = getXMLNodeOffset(n);
+   if((nStart < 0) || (getXMLNodeLength(n) < 0) ||
+      (nStart >= start) || (nStart + getXMLNodeLength(n) <= oldEnd)) {
+      return 0;
+   }
+   child = n->first;
+   childStart = nStart;
+   while(child != NULL) {
+      if((getXMLNodeOffset(child) < 0) || (getXMLNodeLength(child) < 0)) {
+         return 0;
+      }
+      childStart += getXMLNodeOffset(child);
+      if((childStart < start) && (childStart + getXMLNodeLength(child) > oldEnd)) {
+         n = child;
+         nStart = childStart;
+         child = n->first;
+      }
+      else {
+         childStart += getXMLNodeLength(child);
+         child = child->next;
+      }
+   }
+
+   /* its children covering the edit, if they do */
+   first = last = NULL;
+   firstStart = lastEnd = -1;
+   childStart = nStart;
+   for(child = n->first; child != NULL; child = child->next) {
+      childStart += getXMLNodeOffset(child);
+      if((first == NULL) && (childStart + getXMLNodeLength(child) > start)) {
+         first = child;
+         firstStart = childStart;
+      }
+      if(childStart < oldEnd) {
+         last = child;
+         lastEnd = childStart + getXMLNodeLength(child);
+      }
+      childStart += getXMLNodeLength(child);
+   }
+   /* edit ending between children, the text between them is read again with
+      their siblings */
+   if((first != NULL) && (firstStart > start) && (first->previous != NULL)) {
+      firstStart -= getXMLNodeOffset(first);
+      first = first->previous;
+      firstStart -= getXMLNodeLength(first);
+   }
+   if((last != NULL) && (lastEnd < oldEnd) && (last->next != NULL)) {
+      last = last->next;
+      lastEnd += getXMLNodeOffset(last) + getXMLNodeLength(last);
+   }
+   if((first == NULL) || (last == NULL) || (firstStart > lastEnd - getXMLNodeLength(last)) ||
+      (firstStart > start) || (lastEnd < oldEnd)) {
+      first = last = n;
+      firstStart = nStart;
+      lastEnd = nStart + getXMLNodeLength(n);
+   }
+
+   /* parse them again, with namespaces bound by their ancestors */
+   if((namespaces = createXMLNamespaceStack()) == NULL) {
+      return 0;
+   }
+   holder = createXMLNode();
+   success = 0;
+   if(!openXMLAncestorsScopes(first->parent, namespaces)) {
+      logError("Can't bind namespaces of reparsed node", __FILE__, __LINE__);
+   }
+   else if((file = fopen(xml->path, "r")) == NULL) {
+      logError("Can't open file with XML_File's path", __FILE__, __LINE__);
+   }
+   else {
+      if(fseek(file, firstStart, SEEK_SET) == 0) {
+         success = parseXMLElements(file, lastEnd + delta, namespaces,
+                                    xml->pool, xml->filter, holder);
+      }
+      fclose(file);
+   }
+   destroyXMLNamespaceStack(namespaces);
+
+   /* root must stay a single element */
+   if(success && (first->parent == NULL) && (holder->cc != 1)) {
+      success = 0;
+   }
+   if(!success) {
+      destroyXMLNode(holder);
+      return 0;
+   }
+
+   /* new elements' offsets from the end of the node before them; the node
+      after them is still as far from their end */
+   previous = firstStart - getXMLNodeOffset(first);
+   for(child = holder->first; child != NULL; child = child->next) {
+      childStart = getXMLNodeOffset(child);
+      setXMLNodeOffset(child, childStart - previous);
+      previous = childStart + getXMLNodeLength(child);
+   }
+   for(n = first->parent; n != NULL; n = n->parent) {
+      setXMLNodeLength(n, getXMLNodeLength(n) + delta);
+   }
+
+   /* replace old elements */
+   while(holder->first != NULL) {
+      child = holder->first;
+      deleteXMLNodeFromParent(child);
+      if(first->parent == NULL) {
+         xml->root = child;
+      }
+      else {
+         insertXMLNodeBefore(first, child);
+      }
+   }
+   do {
+      next = (first == last) ? NULL : first->next;
+      destroyXMLNode(first);
+      first = next;
+   } while(first != NULL);
+   destroyXMLNode(holder);
+
+   if(xml->flat != NULL) {
+      flattenXMLFile(xml, xml->flat->flags);
+   }
+
+   return 1;
+}
+
+
+/**
+ * \brief Update a XML file's tree after the file was edited.
+ * Only the element enclosing the edit is parsed again when possible, and the
+ * whole file otherwise, with the options it was loaded with. If the file
+ * can't be parsed, its tree is kept.
+ *
+ * \param xml  Reparsed file, indexed by indexXMLFileBlocks().
+ * \return     1 if tree matches file, 0 if an error happened.
+ */
+int reparseXMLFile(XML_File* xml)
+{
+   long start, oldEnd, newEnd;
+   FILE* file;
+   int edit;
+
+   if(xml == NULL) {
+      logError("Trying to reparse a NULL XML_File", __FILE__, __LINE__);
+      return 0;
+   }
+
+   edit = -1;
+   file = NULL;
+   if((xml->blocks != NULL) && (xml->root != NULL)) {
+      edit = findXMLFileEdit(xml, &start, &oldEnd, &newEnd);
+   }
+   if(edit == 0) {
+      return 1;
+   }
+   if((edit < 0) || !reparseXMLFileRange(xml, start, oldEnd, newEnd)) {
+      if(!parseXMLFileAgain(xml)) {
+         return 0;
+      }
+   }
+
+   /* only the edited blocks changed */
+   if(edit < 0) {
+      indexXMLFileBlocks(xml);
+   }
+   else if(((file = fopen(xml->path, "r")) == NULL) ||
+           !rehashXMLFileBlocks(xml, file, start, oldEnd, newEnd)) {
+      logError("Can't hash edited blocks of XML file", __FILE__, __LINE__);
+      dropXMLFileBlocks(xml);
+   }
+   if(file != NULL) {
+      fclose(file);
+   }
+
+   return 1;
+}
@@ -0,0 +1,37 @@
+/**
+ * \file reparse.h
+ * \brief Incremental reparsing related definitions
+ *
+ * An edited XML file is compared block by block with the hashes kept from its
+ * last parsing. Only the smallest element enclosing the changed bytes is
+ * parsed again and spliced into the tree; nodes after it keep their offsets,
+ * which are relative to their previous sibling, and only the lengths of the
+ * nodes enclosing it change.
+ *
+ * \author François-Xavier Balu \<fx.balu@gmail.com\>
+ * \date 17 octobre 2026
+ */
+
+
+#ifndef REPARSE_H_INCLUDED
+#define REPARSE_H_INCLUDED
+
+
+#include "xml.h"     /* XML_File */
+
+
+/**
+ * \brief Length of hashed file blocks, in bytes.
+ */
+#ifndef XML_REPARSE_BLOCK_LENGTH
+#define XML_REPARSE_BLOCK_LENGTH  4096
+#endif /* XML_REPARSE_BLOCK_LENGTH */
+
+
+int indexXMLFileBlocks(XML_File* xml);
+int findXMLFileEdit(XML_File* xml, long* start, long* oldEnd, long* newEnd);
+int reparseXMLFileRange(XML_File* xml, long start, long oldEnd, long newEnd);
+int reparseXMLFile(XML_File* xml);
+
+
+#endif /* REPARSE_H_INCLUDED */
@@ -0,0 +1,1037 @@
+/**
+ * \file succinct.c
+ * \brief Succinct XML trees related functions
+ *
+ * Functions to load and read a XML_Succinct.
+ *
+ * The excess of a position is the number of opening parentheses minus the
+ * number of closing ones up to it, included. An element closes at the first
+ * following position where excess drops by one, and its parent opens right
+ * after the last previous position where excess is two less. These positions
+ * are searched byte by byte inside a block, using tables of bytes' excesses,
+ * and a min tree of blocks' minimal excesses finds the block to search in.
+ *
+ * \author François-Xavier Balu \<fx.balu@gmail.com\>
+ * \date 17 octobre 2026
+ */
+
+
+#include <stdlib.h>     /* malloc(), calloc(), realloc(), free() */
+#include <string.h>     /* strlen(), strncmp(), strcspn(), memchr(), memcmp(), memcpy() */
+#include <limits.h>     /* INT_MAX */
+#include <pthread.h>    /* pthread_once() */
+#include <fcntl.h>      /* open() */
+#include <unistd.h>     /* close() */
+#include <sys/mman.h>   /* mmap(), munmap() */
+#include <sys/stat.h>   /* fstat() */
+
+#include "../log.h"     /* logError(), logMem() */
+#include "name.h"       /* internXMLName(), findXMLName() */
+#include "xml.h"        /* XML_BUFFER_LENGTH */
+#include "succinct.h"
+
+
+static signed char byteMins[256];   /**< Minimal excess in a byte's prefixes. */
+static signed char byteSums[256];   /**< Excess of a whole byte. */
+static pthread_once_t byteTablesOnce = PTHREAD_ONCE_INIT;  /**< Tables' init. */
+
+
+/**
+ * \brief Fill bytes' excess tables. Bits are read from lowest to highest.
+ */
+static void initXMLSuccinctTables(void)
+{
+   int byte, bit, excess, min;
+
+   for(byte = 0; byte < 256; byte++) {
+      excess = 0;
+      min = 8;
+      for(bit = 0; bit < 8; bit++) {
+         excess += ((byte >> bit) & 1) ? 1 : -1;
+         if(excess < min) {
+            min = excess;
+         }
+      }
+      byteMins[byte] = min;
+      byteSums[byte] = excess;
+   }
+}
+
+
+/**
+ * \brief Read a parenthesis, 1 if it opens an element.
+ */
+static int getXMLSuccinctBit(XML_Succinct* s, long i)
+{
+   return (s->bits[i >> 6] >> (i & 63)) & 1;
+}
+
+
+/**
+ * \brief Read the byte holding parentheses 8 * i to 8 * i + 7.
+ */
+static unsigned getXMLSuccinctByte(XML_Succinct* s, long i)
+{
+   return (s->bits[i >> 3] >> ((i & 7) << 3)) & 0xff;
+}
+
+
+/**
+ * \brief Count opening parentheses before a position.
+ */
+static long rankXMLSuccinct(XML_Succinct* s, long i)
+{
+   unsigned long long rank;
+   long word;
+
+   rank = s->ranks[i / XML_SUCCINCT_BLOCK_LENGTH];
+   for(word = (i / XML_SUCCINCT_BLOCK_LENGTH) * (XML_SUCCINCT_BLOCK_LENGTH / 64);
+       word < (i >> 6); word++) {
+      rank += __builtin_popcountll(s->bits[word]);
+   }
+   if(i & 63) {
+      rank += __builtin_popcountll(s->bits[i >> 6] & ((1ULL << (i & 63)) - 1));
+   }
+
+   return (long)rank;
+}
+
+
+/**
+ * \brief Get the excess at a position, 0 before the first one.
+ */
+static long getXMLSuccinctExcess(XML_Succinct* s, long i)
+{
+   return 2 * rankXMLSuccinct(s, i + 1) - (i + 1);
+}
+
+
+/**
+ * \brief Read a field of a packed array.
+ */
+static unsigned long long getXMLPackedField(unsigned long long* words, long i, int width)
+{
+   unsigned long long value;
+   long bit;
+   int shift;
+
+   bit = i * width;
+   shift = bit & 63;
+   value = words[bit >> 6] >> shift;
+   if(shift + width > 64) {
+      value |= words[(bit >> 6) + 1] << (64 - shift);
+   }
+
+   return (width == 64) ? value : value & ((1ULL << width) - 1);
+}
+
+
+/**
+ * \brief Write a field of a packed array, which must still be 0.
+ */
+static void setXMLPackedField(unsigned long long* words, long i, int width,
+                              unsigned long long value)
+{
+   long bit;
+   int shift;
+
+   bit = i * width;
+   shift = bit & 63;
+   words[bit >> 6] |= value << shift;
+   if(shift + width > 64) {
+      words[(bit >> 6) + 1] |= value >> (64 - shift);
+   }
+}
+
+
+/**
+ * \brief Allocate a zeroed packed array.
+ */
+static unsigned long long* createXMLPackedArray(long count, int width)
+{
+   return calloc((count * width + 63) / 64 + 1, sizeof(unsigned long long));
+}
+
+
+/**
+ * \brief Get the number of bits needed to write a value.
+ */
+static int getXMLBitWidth(unsigned long long value)
+{
+   int width;
+
+   for(width = 1; (width < 64) && (value >> width); width++);
+
+   return width;
+}
+
+
+/**
+ * \brief Store an element's name identifier, widening the array if needed.
+ *
+ * \return  1 on success, 0 if an error happened.
+ */
+static int setXMLSuccinctName(XML_Succinct* s, long i, int id, long capacity)
+{
+   unsigned long long* names;
+   int width;
+   long j;
+
+   if((width = getXMLBitWidth(id)) > s->nameWidth) {
+      if((names = createXMLPackedArray(capacity, width)) == NULL) {
+         logError("Can't allocate memory for succinct names", __FILE__, __LINE__);
+         return 0;
+      }
+      for(j = 0; j < i; j++) {
+         setXMLPackedField(names, j, width, getXMLPackedField(s->names, j, s->nameWidth));
+      }
+      free(s->names);
+      s->names = names;
+      s->nameWidth = width;
+   }
+   setXMLPackedField(s->names, i, s->nameWidth, id);
+
+   return 1;
+}
+
+
+/**
+ * \brief Find the '>' ending a tag, skipping quoted attribute values.
+ *
+ * \return  Position of '>', NULL if tag isn't closed.
+ */
+static const char* findXMLSuccinctTagEnd(const char* p, const char* end)
+{
+   char quote;
+
+   for(quote = 0; p < end; p++) {
+      if(quote) {
+         if(*p == quote) {
+            quote = 0;
+         }
+      }
+      else if((*p == '"') || (*p == '\'')) {
+         quote = *p;
+      }
+      else if(*p == '>') {
+         return p;
+      }
+   }
+
+   return NULL;
+}
+
+
+/**
+ * \brief Get the length of a name, ended by a space, '>', '/' or '='.
+ */
+static size_t getXMLSuccinctNameLength(const char* p, const char* end)
+{
+   const char* name;
+
+   for(name = p; (p < end) && (*p != '>') && (*p != '/') && (*p != '=') &&
+                 (*p != ' ') && (*p != '\t') && (*p != '\n') && (*p != '\r'); p++);
+
+   return p - name;
+}
+
+
+/**
+ * \brief Skip a markup up to and including its terminator.
+ *
+ * \return  Position following terminator, NULL if it wasn't found.
+ */
+static const char* skipXMLSuccinctMarkup(const char* p, const char* end,
+                                         const char* terminator)
+{
+   size_t length;
+
+   length = strlen(terminator);
+   while((p = memchr(p, terminator[0], end - p)) != NULL) {
+      if((size_t)(end - p) < length) {
+         return NULL;
+      }
+      if(memcmp(p, terminator, length) == 0) {
+         return p + length;
+      }
+      p++;
+   }
+
+   return NULL;
+}
+
+
+/**
+ * \brief Read file's elements into parentheses, names and tag offsets.
+ *
+ * \param capacity  Maximal number of elements, the number of '<'.
+ * \return          1 on success, 0 if file isn't well formed or an error
+ *                  happened.
+ */
+static int scanXMLSuccinct(XML_Succinct* s, long capacity)
+{
+   const char *p, *end, *tagEnd, *open;
+   long *stack, *grown, depth, stackLength;
+   size_t length;
+   int id, error;
+
+   /* open elements, grown with depth rather than sized by the '<' count */
+   stackLength = 16;
+   if((stack = malloc(stackLength * sizeof(long))) == NULL) {
+      logError("Can't allocate memory for succinct stack", __FILE__, __LINE__);
+      return 0;
+   }
+
+   depth = 0;
+   error = 0;
+   end = s->buffer + s->length;
+   for(p = s->buffer; !error && ((p = memchr(p, '<', end - p)) != NULL); ) {
+      if(end - p < 2) {
+         p = NULL;
+      }
+      /* declarations, processing instructions, comments and CDATA */
+      else if(p[1] == '?') {
+         p = skipXMLSuccinctMarkup(p, end, "?>");
+      }
+      else if((end - p >= 4) && (strncmp(p, "<!--", 4) == 0)) {
+         p = skipXMLSuccinctMarkup(p, end, "-->");
+      }
+      else if((end - p >= 9) && (strncmp(p, "<![CDATA[", 9) == 0)) {
+         p = skipXMLSuccinctMarkup(p, end, "]]>");
+      }
+      else if(p[1] == '!') {
+         tagEnd = memchr(p, '[', end - p);
+         if((tagEnd != NULL) && (tagEnd < findXMLSuccinctTagEnd(p, end))) {
+            p = skipXMLSuccinctMarkup(p, end, "]>");
+         }
+         else {
+            p = skipXMLSuccinctMarkup(p, end, ">");
+         }
+      }
+      /* closing tag, checked against the open element */
+      else if(p[1] == '/') {
+         if(depth == 0) {
+            logError("Closing tag without open element", __FILE__, __LINE__);
+            error = 1;
+            continue;
+         }
+         depth--;
+         open = s->buffer + getXMLPackedField(s->tags, stack[depth], s->tagWidth) + 1;
+         length = getXMLSuccinctNameLength(p + 2, end);
+         if((length != getXMLSuccinctNameLength(open, end)) ||
+            (memcmp(p + 2, open, length) != 0)) {
+            logError("Closing tag doesn't match open element", __FILE__, __LINE__);
+            error = 1;
+            continue;
+         }
+         s->bitCount++;
+         p = skipXMLSuccinctMarkup(p, end, ">");
+      }
+      /* start tag, or empty element tag */
+      else {
+         if((depth == 0) && (s->count > 0)) {
+            logError("Several root elements", __FILE__, __LINE__);
+            error = 1;
+            continue;
+         }
+         if((tagEnd = findXMLSuccinctTagEnd(p, end)) == NULL) {
+            p = NULL;
+         }
+         else {
+            length = getXMLSuccinctNameLength(p + 1, end);
+            if(((id = internXMLName(p + 1, length)) == XML_NO_NAME) ||
+               !setXMLSuccinctName(s, s->count, id, capacity)) {
+               error = 1;
+               continue;
+            }
+            setXMLPackedField(s->tags, s->count, s->tagWidth, p - s->buffer);
+            s->bits[s->bitCount >> 6] |= 1ULL << (s->bitCount & 63);
+            s->bitCount++;
+            if(tagEnd[-1] == '/') {
+               s->bitCount++;
+            }
+            else {
+               if(depth == stackLength) {
+                  stackLength *= 2;
+                  if((grown = realloc(stack, stackLength * sizeof(long))) == NULL) {
+                     logError("Can't reallocate memory for succinct stack",
+                              __FILE__, __LINE__);
+                     error = 1;
+                     continue;
+                  }
+                  stack = grown;
+               }
+               stack[depth] = s->count;
+               depth++;
+            }
+            s->count++;
+            p = tagEnd + 1;
+         }
+      }
+
+      if(p == NULL) {
+         logError("Reached end of file inside a markup", __FILE__, __LINE__);
+         error = 1;
+      }
+   }
+   free(stack);
+
+   if(!error && ((depth != 0) || (s->count == 0))) {
+      logError("File doesn't hold a single closed root element", __FILE__, __LINE__);
+      error = 1;
+   }
+
+   return !error;
+}
+
+
+/**
+ * \brief Build rank directory and min tree of blocks' excesses.
+ *
+ * \return  1 on success, 0 if an error happened.
+ */
+static int indexXMLSuccinct(XML_Succinct* s)
+{
+   long blocks, b, i, end;
+   unsigned long long ones;
+   unsigned byte;
+   int excess, min;
+
+   blocks = (s->bitCount + XML_SUCCINCT_BLOCK_LENGTH - 1) / XML_SUCCINCT_BLOCK_LENGTH;
+   for(s->leaves = 1; s->leaves < blocks; s->leaves *= 2);
+   s->ranks = malloc((blocks + 1) * sizeof(unsigned long long));
+   s->mins = malloc(2 * s->leaves * sizeof(int));
+   if((s->ranks == NULL) || (s->mins == NULL)) {
+      logError("Can't allocate memory for succinct directories", __FILE__, __LINE__);
+      return 0;
+   }
+
+   ones = 0;
+   excess = 0;
+   for(b = 0; b < blocks; b++) {
+      s->ranks[b] = ones;
+      min = INT_MAX;
+      end = (b + 1) * XML_SUCCINCT_BLOCK_LENGTH;
+      if(end > s->bitCount) {
+         end = s->bitCount;
+      }
+      for(i = b * XML_SUCCINCT_BLOCK_LENGTH; i < end; ) {
+         /* whole bytes through tables, last partial one bit by bit */
+         if(i + 8 <= end) {
+            byte = getXMLSuccinctByte(s, i >> 3);
+            if(excess + byteMins[byte] < min) {
+               min = excess + byteMins[byte];
+            }
+            excess += byteSums[byte];
+            ones += __builtin_popcount(byte);
+            i += 8;
+         }
+         else {
+            if(getXMLSuccinctBit(s, i)) {
+               excess++;
+               ones++;
+            }
+            else {
+               excess--;
+            }
+            if(excess < min) {
+               min = excess;
+            }
+            i++;
+         }
+      }
+      s->mins[s->leaves + b] = min;
+   }
+   s->ranks[blocks] = ones;
+
+   for(b = s->leaves + blocks; b < 2 * s->leaves; b++) {
+      s->mins[b] = INT_MAX;
+   }
+   for(b = s->leaves - 1; b > 0; b--) {
+      s->mins[b] = (s->mins[2 * b] < s->mins[2 * b + 1]) ? s->mins[2 * b] : s->mins[2 * b + 1];
+   }
+
+   return 1;
+}
+
+
+/**
+ * \brief Find the first block after a block, whose minimal excess is at most
+ * target.
+ *
+ * \return  Found block, -1 if there is none.
+ */
+static long findXMLSuccinctBlockForward(XML_Succinct* s, long b, long target)
+{
+   long i;
+
+   /* climbs until a right sibling holds such a block, then descends to it */
+   for(i = s->leaves + b; i > 1; i >>= 1) {
+      if(!(i & 1) && (s->mins[i + 1] <= target)) {
+         break;
+      }
+   }
+   if(i <= 1) {
+      return -1;
+   }
+   for(i++; i < s->leaves; ) {
+      i = (s->mins[2 * i] <= target) ? 2 * i : 2 * i + 1;
+   }
+
+   return i - s->leaves;
+}
+
+
+/**
+ * \brief Find the last block before a block, whose minimal excess is at most
+ * target.
+ *
+ * \return  Found block, -1 if there is none.
+ */
+static long findXMLSuccinctBlockBackward(XML_Succinct* s, long b, long target)
+{
+   long i;
+
+   for(i = s->leaves + b; i > 1; i >>= 1) {
+      if((i & 1) && (s->mins[i - 1] <= target)) {
+         break;
+      }
+   }
+   if(i <= 1) {
+      return -1;
+   }
+   for(i--; i < s->leaves; ) {
+      i = (s->mins[2 * i + 1] <= target) ? 2 * i + 1 : 2 * i;
+   }
+
+   return i - s->leaves;
+}
+
+
+/**
+ * \brief Find the first position after p whose excess is at most target.
+ *
+ * \return  Found position, -1 if there is none.
+ */
+static long searchXMLSuccinctForward(XML_Succinct* s, long p, long target)
+{
+   long i, end, excess, b;
+   unsigned byte;
+
+   excess = getXMLSuccinctExcess(s, p);
+   i = p + 1;
+   while(i < s->bitCount) {
+      end = (i / XML_SUCCINCT_BLOCK_LENGTH + 1) * XML_SUCCINCT_BLOCK_LENGTH;
+      if(end > s->bitCount) {
+         end = s->bitCount;
+      }
+      while(i < end) {
+         /* skips whole bytes that don't reach target */
+         if(!(i & 7) && (i + 8 <= end)) {
+            byte = getXMLSuccinctByte(s, i >> 3);
+            if(excess + byteMins[byte] > target) {
+               excess += byteSums[byte];
+               i += 8;
+               continue;
+            }
+         }
+         excess += getXMLSuccinctBit(s, i) ? 1 : -1;
+         if(excess <= target) {
+            return i;
+         }
+         i++;
+      }
+
+      if((i >= s->bitCount) ||
+         ((b = findXMLSuccinctBlockForward(s, (i - 1) / XML_SUCCINCT_BLOCK_LENGTH,
+                                           target)) < 0)) {
+         return -1;
+      }
+      i = b * XML_SUCCINCT_BLOCK_LENGTH;
+      excess = 2 * (long)s->ranks[b] - i;
+   }
+
+   return -1;
+}
+
+
+/**
+ * \brief Find the last position before p whose excess is at most target.
+ *
+ * \return  Found position, -1 if only the start of the sequence, which excess
+ *          is 0, is, -2 if there is none.
+ */
+static long searchXMLSuccinctBackward(XML_Succinct* s, long p, long target)
+{
+   long i, start, excess, base, b;
+   unsigned byte;
+
+   i = p - 1;
+   excess = (i < 0) ? 0 : getXMLSuccinctExcess(s, i);
+   while(i >= 0) {
+      start = (i / XML_SUCCINCT_BLOCK_LENGTH) * XML_SUCCINCT_BLOCK_LENGTH;
+      while(i >= start) {
+         /* skips whole bytes that don't reach target */
+         if(((i & 7) == 7) && (i - 7 >= start)) {
+            byte = getXMLSuccinctByte(s, i >> 3);
+            base = excess - byteSums[byte];
+            if(base + byteMins[byte] > target) {
+               excess = base;
+               i -= 8;
+               continue;
+            }
+         }
+         if(excess <= target) {
+            return i;
+         }
+         excess -= getXMLSuccinctBit(s, i) ? 1 : -1;
+         i--;
+      }
+
+      if((i < 0) ||
+         ((b = findXMLSuccinctBlockBackward(s, start / XML_SUCCINCT_BLOCK_LENGTH,
+                                            target)) < 0)) {
+         break;
+      }
+      i = (b + 1) * XML_SUCCINCT_BLOCK_LENGTH - 1;
+      excess = getXMLSuccinctExcess(s, i);
+   }
+
+   return (target >= 0) ? -1 : -2;
+}
+
+
+/**
+ * \brief Load a XML file as a succinct tree.
+ * File is mapped in memory, and must not be modified while the tree is used.
+ * Values aren't copied: they are read in the file when asked for.
+ *
+ * \param[in] path  Path of the XML file.
+ * \return          Loaded tree, NULL if an error happened.
+ */
+XML_Succinct* loadXMLSuccinct(const char* path)
+{
+   XML_Succinct* s;
+   struct stat status;
+   const char *p, *end;
+   long capacity;
+   int fd;
+
+   pthread_once(&byteTablesOnce, initXMLSuccinctTables);
+
+   if(path == NULL) {
+      logError("Trying to load a succinct tree from a NULL path", __FILE__, __LINE__);
+      return NULL;
+   }
+   if((s = calloc(1, sizeof(XML_Succinct))) == NULL) {
+      logError("Can't allocate memory for XML_Succinct", __FILE__, __LINE__);
+      return NULL;
+   }
+   logMem(LOG_ALLOC, s, "XML_Succinct", "succinct tree", __FILE__, __LINE__);
+
+   /* maps file */
+   if((fd = open(path, O_RDONLY)) < 0) {
+      logError("Can't open XML file", __FILE__, __LINE__);
+      destroyXMLSuccinct(s);
+      return NULL;
+   }
+   if((fstat(fd, &status) < 0) || (status.st_size == 0) ||
+      ((s->buffer = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0)) ==
+       MAP_FAILED)) {
+      logError("Can't map XML file", __FILE__, __LINE__);
+      s->buffer = NULL;
+      close(fd);
+      destroyXMLSuccinct(s);
+      return NULL;
+   }
+   close(fd);
+   s->length = status.st_size;
+
+   /* each element has at least one '<' */
+   capacity = 0;
+   end = s->buffer + s->length;
+   for(p = s->buffer; (p = memchr(p, '<', end - p)) != NULL; p++) {
+      capacity++;
+   }
+   s->nameWidth = 1;
+   s->tagWidth = getXMLBitWidth(s->length);
+   s->bits = calloc(2 * capacity / 64 + 2, sizeof(unsigned long long));
+   s->names = createXMLPackedArray(capacity, s->nameWidth);
+   s->tags = createXMLPackedArray(capacity, s->tagWidth);
+   if((s->bits == NULL) || (s->names == NULL) || (s->tags == NULL)) {
+      logError("Can't allocate memory for succinct tree", __FILE__, __LINE__);
+      destroyXMLSuccinct(s);
+      return NULL;
+   }
+
+   if(!scanXMLSuccinct(s, capacity) || !indexXMLSuccinct(s)) {
+      destroyXMLSuccinct(s);
+      return NULL;
+   }
+
+   return s;
+}
+
+
+/**
+ * \brief Destroy a succinct tree, and unmap its file.
+ *
+ * \param s  Destroyed tree.
+ */
+void destroyXMLSuccinct(XML_Succinct* s)
+{
+   if(s == NULL) {
+      logError("Trying to destroy a NULL XML_Succinct", __FILE__, __LINE__);
+   }
+   else {
+      if(s->buffer != NULL) {
+         munmap(s->buffer, s->length);
+      }
+      free(s->bits);
+      free(s->ranks);
+      free(s->mins);
+      free(s->names);
+      free(s->tags);
+      logMem(LOG_FREE, s, "XML_Succinct", "succinct tree", __FILE__, __LINE__);
+      free(s);
+   }
+}
+
+
+/**
+ * \brief Get a node's parent.
+ *
+ * \param n  Node.
+ * \param s  Node's tree.
+ * \return   Parent, -1 for the root.
+ */
+long getXMLSuccinctParent(long n, XML_Succinct* s)
+{
+   long excess, found;
+
+   if((s == NULL) || (n <= 0) || (n >= s->bitCount)) {
+      return -1;
+   }
+   if((excess = getXMLSuccinctExcess(s, n)) <= 1) {
+      return -1;
+   }
+   found = searchXMLSuccinctBackward(s, n, excess - 2);
+
+   return (found < -1) ? -1 : found + 1;
+}
+
+
+/**
+ * \brief Get a node's first child.
+ *
+ * \param n  Node.
+ * \param s  Node's tree.
+ * \return   First child, -1 if node has no children.
+ */
+long getXMLSuccinctFirst(long n, XML_Succinct* s)
+{
+   if((s == NULL) || (n < 0) || (n + 1 >= s->bitCount)) {
+      return -1;
+   }
+
+   return getXMLSuccinctBit(s, n + 1) ? n + 1 : -1;
+}
+
+
+/**
+ * \brief Get a node's next sibling.
+ *
+ * \param n  Node.
+ * \param s  Node's tree.
+ * \return   Next sibling, -1 if node is the last child.
+ */
+long getXMLSuccinctNext(long n, XML_Succinct* s)
+{
+   long close;
+
+   if((s == NULL) || (n < 0) || (n >= s->bitCount)) {
+      return -1;
+   }
+   if(((close = searchXMLSuccinctForward(s, n, getXMLSuccinctExcess(s, n) - 1)) < 0) ||
+      (close + 1 >= s->bitCount)) {
+      return -1;
+   }
+
+   return getXMLSuccinctBit(s, close + 1) ? close + 1 : -1;
+}
+
+
+/**
+ * \brief Get a node's index in document order.
+ *
+ * \param n  Node.
+ * \param s  Node's tree.
+ * \return   Index, from 0 for the root to s->count - 1.
+ */
+long getXMLSuccinctIndex(long n, XML_Succinct* s)
+{
+   if((s == NULL) || (n < 0) || (n >= s->bitCount)) {
+      return -1;
+   }
+
+   return rankXMLSuccinct(s, n);
+}
+
+
+/**
+ * \brief Get a node's name identifier, for getXMLName().
+ *
+ * \param n  Node.
+ * \param s  Node's tree.
+ * \return   Name's identifier, XML_NO_NAME if node doesn't exist.
+ */
+int getXMLSuccinctNameId(long n, XML_Succinct* s)
+{
+   if((s == NULL) || (n < 0) || (n >= s->bitCount)) {
+      return XML_NO_NAME;
+   }
+
+   return getXMLPackedField(s->names, rankXMLSuccinct(s, n), s->nameWidth);
+}
+
+
+/**
+ * \brief Get a node's start tag in the mapped file.
+ *
+ * \param[out] tagEnd  Position of tag's '>'.
+ * \return             Position of tag's '<'.
+ */
+static const char* getXMLSuccinctTag(long n, XML_Succinct* s, const char** tagEnd)
+{
+   const char* tag;
+
+   tag = s->buffer + getXMLPackedField(s->tags, rankXMLSuccinct(s, n), s->tagWidth);
+   *tagEnd = findXMLSuccinctTagEnd(tag, s->buffer + s->length);
+
+   return tag;
+}
+
+
+/**
+ * \brief Get a node's value, in the mapped file.
+ * Value is read as by the parser: from the first printable character after
+ * the start tag, to the end of line or the next tag.
+ *
+ * \param      n       Node.
+ * \param      s       Node's tree.
+ * \param[out] length  Value's length, as it isn't ended by '\\0'.
+ * \return             Value, NULL if node has none.
+ */
+const char* getXMLSuccinctValue(long n, XML_Succinct* s, size_t* length)
+{
+   const char *p, *end, *value;
+
+   *length = 0;
+   if((s == NULL) || (n < 0) || (n >= s->bitCount)) {
+      return NULL;
+   }
+   getXMLSuccinctTag(n, s, &p);
+   if(p[-1] == '/') {
+      return NULL;
+   }
+
+   end = s->buffer + s->length;
+   for(p++; (p < end) && (*p != '<') && ((*p < '!') || (*p > '~')); p++);
+   if((p == end) || (*p == '<')) {
+      return NULL;
+   }
+   for(value = p; (p < end) && (*p != '<') && (*p != '\n') && (*p != '\r'); p++);
+   *length = p - value;
+
+   return value;
+}
+
+
+/**
+ * \brief Get a node's attribute value, in the mapped file.
+ *
+ * \param      n       Node.
+ * \param[in]  name    Attribute's name.
+ * \param      s       Node's tree.
+ * \param[out] length  Value's length, as it isn't ended by '\\0'.
+ * \return             Value, NULL if node has no such attribute.
+ */
+const char* getXMLSuccinctAttribute(long n, const char* name, XML_Succinct* s,
+                                    size_t* length)
+{
+   const char *p, *tagEnd, *attr, *value;
+   size_t nameLength, attrLength;
+   char quote;
+
+   *length = 0;
+   if((s == NULL) || (name == NULL) || (n < 0) || (n >= s->bitCount)) {
+      return NULL;
+   }
+   p = getXMLSuccinctTag(n, s, &tagEnd);
+   nameLength = strlen(name);
+
+   /* skips element's name, then reads name="value" pairs */
+   p += 1 + getXMLSuccinctNameLength(p + 1, tagEnd);
+   while(p < tagEnd) {
+      if((*p == ' ') || (*p == '\t') || (*p == '\n') || (*p == '\r') || (*p == '/')) {
+         p++;
+         continue;
+      }
+      attr = p;
+      attrLength = getXMLSuccinctNameLength(p, tagEnd);
+      for(p += attrLength; (p < tagEnd) && (*p != '"') && (*p != '\''); p++);
+      if(p == tagEnd) {
+         break;
+      }
+      quote = *p;
+      for(value = ++p; (p < tagEnd) && (*p != quote); p++);
+      if((attrLength == nameLength) && (memcmp(attr, name, nameLength) == 0)) {
+         *length = p - value;
+         return value;
+      }
+      p++;
+   }
+
+   return NULL;
+}
+
+
+/**
+ * \brief Find the first sibling with a name, and an attribute value.
+ *
+ * \param n      First sibling.
+ * \param id     Name's identifier.
+ * \param attr   Attribute's name, NULL not to check attributes.
+ * \param value  Attribute's value.
+ * \return       Found node, -1 if there is none.
+ */
+static long findXMLSuccinctSibling(long n, int id, const char* attr,
+                                   const char* value, XML_Succinct* s)
+{
+   const char* found;
+   size_t length;
+
+   for(; n >= 0; n = getXMLSuccinctNext(n, s)) {
+      if(getXMLSuccinctNameId(n, s) != id) {
+         continue;
+      }
+      if(attr == NULL) {
+         return n;
+      }
+      found = getXMLSuccinctAttribute(n, attr, s, &length);
+      if((found != NULL) && (length == strlen(value)) &&
+         (memcmp(found, value, length) == 0)) {
+         return n;
+      }
+   }
+
+   return -1;
+}
+
+
+/**
+ * \brief Finds a particular node in a succinct tree.
+ *
+ * \param[in] path  Node path in the tree, as for getXMLNode().
+ *                  eg. "foo/bar", "foo/bar?attr=value/lel"
+ * \param     s     Searched tree.
+ * \return          Found node, -1 if such a node wasn't found.
+ */
+long getXMLSuccinctNode(char* path, XML_Succinct* s)
+{
+   char name[XML_BUFFER_LENGTH], attr[XML_BUFFER_LENGTH];
+   char value[XML_BUFFER_LENGTH];
+   size_t length;
+   long n;
+   int id;
+
+   if((path == NULL) || (s == NULL)) {
+      return -1;
+   }
+
+   for(n = 0; ; n = getXMLSuccinctFirst(n, s)) {
+      /* reads "name" or "name?attr=value" */
+      length = strcspn(path, "/?");
+      if(length >= sizeof(name)) {
+         return -1;
+      }
+      memcpy(name, path, length);
+      name[length] = '\0';
+      path += length;
+      attr[0] = '\0';
+      if(*path == '?') {
+         path++;
+         length = strcspn(path, "=");
+         if((path[length] != '=') || (length >= sizeof(attr))) {
+            logError("Attribute's name is not followed by a value.", __FILE__, __LINE__);
+            return -1;
+         }
+         memcpy(attr, path, length);
+         attr[length] = '\0';
+         path += length + 1;
+         length = strcspn(path, "/");
+         if(length >= sizeof(value)) {
+            return -1;
+         }
+         memcpy(value, path, length);
+         value[length] = '\0';
+         path += length;
+      }
+
+      if(((id = findXMLName(name, strlen(name))) == XML_NO_NAME) ||
+         ((n = findXMLSuccinctSibling(n, id, (attr[0] != '\0') ? attr : NULL,
+                                      value, s)) < 0)) {
+         return -1;
+      }
+      if(*path == '\0') {
+         return n;
+      }
+      path++;
+   }
+}
+
+
+/**
+ * \brief Finds a value or an attribute's value in a succinct tree.
+ *
+ * \param[in]  path    Value path in the tree, as for findXMLValue().
+ *                     eg. "foo/bar$", "foo/bar:attr"
+ * \param      s       Searched tree.
+ * \param[out] length  Value's length, as it isn't ended by '\\0'.
+ * \return             Found value, in the mapped file, NULL if it wasn't found.
+ */
+const char* findXMLSuccinctValue(char* path, XML_Succinct* s, size_t* length)
+{
+   char name[XML_BUFFER_LENGTH];
+   size_t nameLength;
+   long n;
+   int id;
+
+   *length = 0;
+   if((path == NULL) || (s == NULL)) {
+      return NULL;
+   }
+
+   for(n = 0; ; n = getXMLSuccinctFirst(n, s)) {
+      nameLength = strcspn(path, "/:$");
+      if((path[nameLength] == '\0') || (nameLength >= sizeof(name))) {
+         logError("Reached end of path without ':' or '$'.", __FILE__, __LINE__);
+         return NULL;
+      }
+      memcpy(name, path, nameLength);
+      name[nameLength] = '\0';
+      if(((id = findXMLName(name, nameLength)) == XML_NO_NAME) ||
+         ((n = findXMLSuccinctSibling(n, id, NULL, NULL, s)) < 0)) {
+         return NULL;
+      }
+
+      path += nameLength;
+      if(*path == '$') {
+         return getXMLSuccinctValue(n, s, length);
+      }
+      if(*path == ':') {
+         return getXMLSuccinctAttribute(n, path + 1, s, length);
+      }
+      path++;
+   }
+}
@@ -0,0 +1,68 @@
+/**
+ * \file succinct.h
+ * \brief Succinct XML trees related definitions
+ *
+ * Definition of a XML_Succinct structure, a read-only XML tree taking a few
+ * bytes per element. Tree's shape is a sequence of balanced parentheses, two
+ * bits per element, names are packed identifiers from the names dictionary,
+ * and values and attributes are read in place from the mapped file.
+ *
+ * A node is the position of its opening parenthesis, the root being 0. There
+ * is no node structure: navigation functions compute positions, in constant
+ * time for a first child and logarithmic time otherwise.
+ *
+ * \author François-Xavier Balu \<fx.balu@gmail.com\>
+ * \date 17 octobre 2026
+ */
+
+
+#ifndef SUCCINCT_H_INCLUDED
+#define SUCCINCT_H_INCLUDED
+
+
+#include <stddef.h>     /* size_t */
+
+
+/**
+ * \brief Number of parentheses in a block of rank and excess directories.
+ */
+#define XML_SUCCINCT_BLOCK_LENGTH  512
+
+
+/**
+ * \brief Succinct read-only XML tree.
+ */
+typedef struct XML_Succinct {
+   char* buffer;                 /**< Mapped file. */
+   size_t length;                /**< File's length. */
+   unsigned long long* bits;     /**< Parentheses, 1 opens an element, 0 closes it. */
+   long bitCount;                /**< Number of parentheses. */
+   unsigned long long* ranks;    /**< Opening parentheses before each block. */
+   int* mins;                    /**< Min tree of blocks' minimal excesses. */
+   long leaves;                  /**< Leaves in mins, power of 2. */
+   unsigned long long* names;    /**< Elements' name identifiers, packed. */
+   int nameWidth;                /**< Bits per name identifier. */
+   unsigned long long* tags;     /**< Elements' start tag offsets, packed. */
+   int tagWidth;                 /**< Bits per offset. */
+   long count;                   /**< Number of elements. */
+} XML_Succinct;
+
+
+XML_Succinct* loadXMLSuccinct(const char* path);
+void destroyXMLSuccinct(XML_Succinct* s);
+
+long getXMLSuccinctParent(long n, XML_Succinct* s);
+long getXMLSuccinctFirst(long n, XML_Succinct* s);
+long getXMLSuccinctNext(long n, XML_Succinct* s);
+long getXMLSuccinctIndex(long n, XML_Succinct* s);
+
+int getXMLSuccinctNameId(long n, XML_Succinct* s);
+const char* getXMLSuccinctValue(long n, XML_Succinct* s, size_t* length);
+const char* getXMLSuccinctAttribute(long n, const char* name, XML_Succinct* s,
+                                    size_t* length);
+
+long getXMLSuccinctNode(char* path, XML_Succinct* s);
+const char* findXMLSuccinctValue(char* path, XML_Succinct* s, size_t* length);
+
+
+#endif /* SUCCINCT_H_INCLUDED */
@@ -10,9 +10,11 @@
 
 #include <stdio.h>      /* FILE */
 #include <stdlib.h>     /* malloc(), realloc(), free() */
-#include <string.h>     /* strlen(), strcpy() */
+#include <string.h>     /* strlen(), strcpy(), memcpy(), memcmp() */
 
 #include "../log.h"     /* logError() */
+#include "error.h"      /* logXMLError() */
+#include "name.h"       /* hashXMLString() */
 #include "attribute.h"
 #include "tag.h"
 
@@ -94,7 +96,7 @@ void freeXMLTag(XML_Tag* tag)
    if(tag == NULL) {
       logError("Trying to free a NULL tag",  __FILE__ ,  __LINE__ );
    }
-   else if((tag->name != NULL) || (tag->attr != NULL)) {
+   else if((tag->name != NULL) || (tag->attr != NULL) || (tag->raw != NULL)) {
       logError("Trying to free a non initialized tag",  __FILE__ ,  __LINE__ );
    }
    else {
@@ -119,8 +121,12 @@ void initXMLTag(XML_Tag* tag)
    }
    else {
       tag->name = NULL;
+      tag->nameLength = 0;
       tag->attr = NULL;
+      tag->raw = NULL;
       tag->type = UNKNOWN;
+      tag->start = -1;
+      tag->end = -1;
    }
 }
 
@@ -152,6 +158,10 @@ void resetXMLTag(XML_Tag* tag)
       if(tag->attr != NULL) {
          destroyXMLAttribute(tag->attr);
       }
+      if(tag->raw != NULL) {
+         logMem(LOG_FREE, tag->raw, "string", "tag attributes", __FILE__ , __LINE__ );
+         free(tag->raw);
+      }
       initXMLTag(tag);
    }
 }
@@ -183,6 +193,7 @@ void setXMLTagName(const char* name, XML_Tag* tag)
       else {
          printf("   >>> realloc tag.c:184 <<<\n");
          strcpy(tag->name, name);
+         tag->nameLength = strlen(name);
       }
    }
    /* tag doesn't have a name */
@@ -193,6 +204,7 @@ void setXMLTagName(const char* name, XML_Tag* tag)
       else {
          logMem(LOG_ALLOC, tag->name, "string", "tag name",  __FILE__  ,  __LINE__ );
          strcpy(tag->name, name);
+         tag->nameLength = strlen(name);
       }
    }
 }
@@ -254,6 +266,82 @@ XML_Attribute* deleteAttributeFromXMLTag(XML_Tag* tag)
 }
 
 
+/**
+ * \brief Check that a XML tag has no duplicate attribute.
+ * Attributes are compared with their name identifiers. Few attributes are
+ * compared two by two, and an open addressing table of identifiers is used
+ * above XML_ATTRIBUTE_SCAN_LIMIT, so checking a tag stays linear with its
+ * attributes count.
+ *
+ * \param tag  Checked tag.
+ * \return     1 if all attributes have different names, 0 otherwise.
+ */
+int checkXMLTagAttributes(XML_Tag* tag)
+{
+   int stackTable[8 * XML_ATTRIBUTE_SCAN_LIMIT];
+   int* table;
+   XML_Attribute *attr, *other;
+   size_t count, length, slot;
+   int unique;
+
+   if(tag == NULL) {
+      logError("Trying to check attributes of a NULL tag",  __FILE__ ,  __LINE__ );
+      return 0;
+   }
+
+   count = 0;
+   for(attr = tag->attr; attr != NULL; attr = attr->next) {
+      count++;
+   }
+
+   /* few attributes, compare them two by two */
+   if(count <= XML_ATTRIBUTE_SCAN_LIMIT) {
+      for(attr = tag->attr; attr != NULL; attr = attr->next) {
+         for(other = attr->next; other != NULL; other = other->next) {
+            if(other->id == attr->id) {
+               return 0;
+            }
+         }
+      }
+      return 1;
+   }
+
+   /* many attributes, use a table at most half full */
+   length = 1;
+   while(length < count * 2) {
+      length *= 2;
+   }
+   if(length <= sizeof(stackTable) / sizeof(int)) {
+      table = stackTable;
+   }
+   else if((table = malloc(length * sizeof(int))) == NULL) {
+      logError("Can't allocate memory for attributes table",  __FILE__ ,  __LINE__ );
+      return 0;
+   }
+   for(slot = 0; slot < length; slot++) {
+      table[slot] = XML_NO_NAME;
+   }
+
+   unique = 1;
+   for(attr = tag->attr; (attr != NULL) && unique; attr = attr->next) {
+      slot = ((unsigned)attr->id * 2654435761u) & (length - 1);
+      while((table[slot] != XML_NO_NAME) && (table[slot] != attr->id)) {
+         slot = (slot + 1) & (length - 1);
+      }
+      if(table[slot] == attr->id) {
+         unique = 0;
+      }
+      table[slot] = attr->id;
+   }
+
+   if(table != stackTable) {
+      free(table);
+   }
+
+   return unique;
+}
+
+
 /**
  * \brief Read and parse a tag in a XML file.
  * Read characters in a XML file until '>' is reached, and store informations in
@@ -263,10 +351,252 @@ XML_Attribute* deleteAttributeFromXMLTag(XML_Tag* tag)
  * \return         Read and parsed XML_Tag, \c NULL if an error happened.
  */
 XML_Tag* readXMLTag(FILE* file)
+{
+   return readXMLTagFiltered(file, NULL);
+}
+
+
+/**
+ * \brief Check if a character separates a tag's name and attributes.
+ */
+static int isXMLTagSpace(int c)
+{
+   return (c == (int)' ') || (c == (int)'\t') || (c == (int)'\n') || (c == (int)'\r');
+}
+
+
+/**
+ * \brief A name read in a tag's bytes, in a duplicates table.
+ */
+typedef struct XML_RawName {
+   const char* name;          /**< Name, not ended by '\\0', NULL for a free slot. */
+   size_t length;             /**< Name's length. */
+   unsigned long long hash;   /**< Name's hash. */
+} XML_RawName;
+
+
+/**
+ * \brief Check that a tag's bytes hold no duplicate attribute.
+ * Names are compared as bytes, since undecoded attributes have no name
+ * identifier. As in checkXMLTagAttributes(), few attributes are compared two
+ * by two, and a table is used above XML_ATTRIBUTE_SCAN_LIMIT.
+ *
+ * \param[in] raw  Tag's attributes bytes, ended by '\\0'.
+ * \return         1 if all attributes have different names, 0 otherwise.
+ */
+static int checkXMLRawAttributes(const char* raw)
+{
+   XML_RawName stackTable[8 * XML_ATTRIBUTE_SCAN_LIMIT];
+   XML_RawName* table;
+   const char *p, *q, *name, *other, *value;
+   size_t count, length, slot, nameLength, otherLength, valueLength;
+   unsigned long long hash;
+   int unique;
+
+   count = 0;
+   for(p = raw; (p = readXMLRawAttribute(p, &name, &nameLength, &value,
+                                         &valueLength)) != NULL; count++);
+
+   /* few attributes, compare them two by two */
+   if(count <= XML_ATTRIBUTE_SCAN_LIMIT) {
+      for(p = raw; (p = readXMLRawAttribute(p, &name, &nameLength, &value,
+                                            &valueLength)) != NULL; ) {
+         for(q = p; (q = readXMLRawAttribute(q, &other, &otherLength, &value,
+                                             &valueLength)) != NULL; ) {
+            if((otherLength == nameLength) && (memcmp(other, name, nameLength) == 0)) {
+               return 0;
+            }
+         }
+      }
+      return 1;
+   }
+
+   /* many attributes, use a table at most half full */
+   length = 1;
+   while(length < count * 2) {
+      length *= 2;
+   }
+   if(length <= sizeof(stackTable) / sizeof(XML_RawName)) {
+      table = stackTable;
+   }
+   else if((table = malloc(length * sizeof(XML_RawName))) == NULL) {
+      logError("Can't allocate memory for attributes table",  __FILE__ ,  __LINE__ );
+      return 0;
+   }
+   for(slot = 0; slot < length; slot++) {
+      table[slot].name = NULL;
+   }
+
+   unique = 1;
+   for(p = raw; unique && ((p = readXMLRawAttribute(p, &name, &nameLength, &value,
+                                                    &valueLength)) != NULL); ) {
+      hash = hashXMLString(name, nameLength);
+      slot = (size_t)hash & (length - 1);
+      while((table[slot].name != NULL) &&
+            ((table[slot].hash != hash) || (table[slot].length != nameLength) ||
+             (memcmp(table[slot].name, name, nameLength) != 0))) {
+         slot = (slot + 1) & (length - 1);
+      }
+      if(table[slot].name != NULL) {
+         unique = 0;
+      }
+      table[slot].name = name;
+      table[slot].length = nameLength;
+      table[slot].hash = hash;
+   }
+
+   if(table != stackTable) {
+      free(table);
+   }
+
+   return unique;
+}
+
+
+/**
+ * \brief Read a tag's attributes as bytes, then decode them.
+ * Bytes are read up to the tag's '>', which is consumed, and tag's type is
+ * set from the character before it. Read bytes are added to \p read. Every
+ * attribute is decoded without a filter, else only the filtered ones, and
+ * other ones are checked for duplicates as bytes.
+ *
+ * \return  1 on success, 0 if an error happened.
+ */
+static int readXMLTagRawAttributes(FILE* file, XML_Tag* tag, XML_AttributeFilter* filter,
+                                   long* read)
+{
+   const char *p, *next, *name, *value;
+   size_t length, capacity, nameLength, valueLength, end;
+   XML_Attribute* attr;
+   char stackRaw[XML_BUFFER_LENGTH];
+   char *raw, *grown;
+   int charBuffer, quote, others, status;
+
+   /* tags' bytes fit on stack, unless attributes are long or kept */
+   raw = stackRaw;
+   capacity = sizeof(stackRaw);
+
+   /* reads up to '>', out of quoted values */
+   length = 0;
+   quote = 0;
+   status = 1;
+   while(status && (((charBuffer = fgetc(file)) != (int)'>') || quote)) {
+      if(charBuffer == EOF) {
+         logXMLError("Reached EOF while reading XML tag", file);
+         status = 0;
+      }
+      else {
+         if(quote) {
+            quote = (charBuffer == quote) ? 0 : quote;
+         }
+         else if((charBuffer == (int)'"') || (charBuffer == (int)'\'')) {
+            quote = charBuffer;
+         }
+         if(length + 1 >= capacity) {
+            grown = (raw == stackRaw) ? malloc(2 * capacity) : realloc(raw, 2 * capacity);
+            if(grown == NULL) {
+               logError("Can't reallocate memory for tag's attributes",  __FILE__ ,  __LINE__ );
+               status = 0;
+            }
+            else {
+               if(raw == stackRaw) {
+                  memcpy(grown, stackRaw, length);
+               }
+               raw = grown;
+               capacity *= 2;
+            }
+         }
+         raw[length++] = (char)charBuffer;
+      }
+   }
+   if(!status) {
+      if(raw != stackRaw) {
+         free(raw);
+      }
+      return 0;
+   }
+   *read += length + 1;
+
+   /* a '/' before '>' makes the tag a unique one */
+   for(end = length; (end > 0) && isXMLTagSpace(raw[end - 1]); end--);
+   if((end > 0) && (raw[end - 1] == '/')) {
+      tag->type = UNIQUE;
+      end--;
+   }
+   else {
+      tag->type = OPENING;
+   }
+   raw[end] = '\0';
+
+   /* decodes filtered attributes, and counts other ones */
+   others = 0;
+   for(p = raw; status && ((next = readXMLRawAttribute(p, &name, &nameLength, &value,
+                                                       &valueLength)) != NULL); p = next) {
+      if((filter != NULL) && !isXMLAttributeDecoded(filter, name, nameLength)) {
+         others++;
+      }
+      else if((attr = createXMLRawAttribute(name, nameLength, value, valueLength)) == NULL) {
+         status = 0;
+      }
+      else {
+         addAttributeToXMLTag(attr, tag);
+      }
+   }
+   if(status) {
+      for(; isXMLTagSpace(*p); p++);
+      if(*p != '\0') {
+         logXMLError("Badly parsed XML file.", file);
+         status = 0;
+      }
+      else if((others > 0) && !checkXMLRawAttributes(raw)) {
+         logXMLError("Duplicate attribute in XML tag", file);
+         status = 0;
+      }
+   }
+
+   /* undecoded bytes are kept by a lazy filter */
+   if(status && (others > 0) && filter->lazy) {
+      if(raw == stackRaw) {
+         if((tag->raw = malloc(end + 1)) == NULL) {
+            logError("Can't allocate memory for tag's attributes",  __FILE__ ,  __LINE__ );
+            return 0;
+         }
+         memcpy(tag->raw, raw, end + 1);
+      }
+      else {
+         tag->raw = raw;
+      }
+      logMem(LOG_ALLOC, tag->raw, "string", "tag attributes", __FILE__ , __LINE__ );
+   }
+   else if(raw != stackRaw) {
+      free(raw);
+   }
+
+   return status;
+}
+
+
+/**
+ * \brief Read and parse a tag in a XML file, decoding only some attributes.
+ * Attributes are first read as bytes, with or without a filter, so they
+ * follow one grammar: name="value" or name='value', spaces allowed around
+ * '='. Without a filter, every attribute is decoded. With one, only the
+ * filtered ones and namespace declarations are, other ones being dropped,
+ * or kept in tag's raw bytes when the filter is lazy. Duplicates are
+ * rejected among all of them.
+ * Read bytes are counted in tag's start and end, so the parser knows tags'
+ * offsets without asking the stream.
+ *
+ * \param[in] file    Read XML file. Need to be opened.
+ * \param     filter  Decoded attributes, NULL to decode them all.
+ * \return            Read and parsed XML_Tag, \c NULL if an error happened.
+ */
+XML_Tag* readXMLTagFiltered(FILE* file, XML_AttributeFilter* filter)
 {
    XML_Tag* tag;
    int charBuffer, i;
    char strBuffer[XML_BUFFER_LENGTH];
+   long length;
 
    /* create a tag structure where informations will be stored */
    tag = createXMLTag();
@@ -274,9 +604,15 @@ XML_Tag* readXMLTag(FILE* file)
    /* pre name parsing, check the closing tag character '/' */
    i = 0;
    charBuffer = fgetc(file);
-   /* ignore opening chevron '<' */
+   length = 1;
+   /* ignore opening chevron '<', that may have been read with a node's value */
    if(charBuffer == (char)'<') {
+      tag->start = 0;
       charBuffer = fgetc(file);
+      length++;
+   }
+   else {
+      tag->start = -1;
    }
    /* detect closing tag character '/' */
    if(charBuffer == (char)'/') {
@@ -290,16 +626,18 @@ XML_Tag* readXMLTag(FILE* file)
 
    /* get tag's name */
    charBuffer = fgetc(file);
-   while((charBuffer != (int)' ') &&
+   length++;
+   while(!isXMLTagSpace(charBuffer) &&
          (charBuffer != (int)'>') &&
          (charBuffer != (int)'/') &&
          (charBuffer != EOF))
    {
       strBuffer[i] = (char)charBuffer;
       charBuffer = fgetc(file);
+      length++;
       i++;
       if(i >= XML_BUFFER_LENGTH) {
-         logError("XML reading buffer strBuffer is full",  __FILE__ ,  __LINE__ );
+         logXMLError("XML reading buffer strBuffer is full", file);
          freeXMLTag(tag);
          return NULL;
       }
@@ -324,61 +662,66 @@ XML_Tag* readXMLTag(FILE* file)
          if(tag->type == UNKNOWN) {
             tag->type = UNIQUE;
             /* check implied following '>' */
+            length++;
             if((charBuffer = fgetc(file)) != (int)'>') {
-               logError("Badly parsed XML file.",  __FILE__ ,  __LINE__ );
+               logXMLError("Badly parsed XML file.", file);
                destroyXMLTag(tag);
                return NULL;
             }
          }
          else {
-            logError("XML parser found a closing unique tag !",
-                      __FILE__ ,  __LINE__ );
+            logXMLError("XML parser found a closing unique tag !", file);
             destroyXMLTag(tag);
             return NULL;
          }
          break;
 
-      /* attribute separation character ' ' */
+      /* attribute separation characters */
       case (int)' ':
+      case (int)'\t':
+      case (int)'\n':
+      case (int)'\r':
          /* tag has attribute, and can be opening or unique */
          break;
 
       /* End Of File character EOF, who shouldn't be here */
       case EOF:
-         logError("Reached EOF while reading XML tag",  __FILE__ ,  __LINE__ );
+         logXMLError("Reached EOF while reading XML tag", file);
          destroyXMLTag(tag);
          return NULL;
 
       /* Any other character, who shouldn't be here either */
       default:
-         logError("Unknown character after tag's name.",  __FILE__ ,  __LINE__ );
+         logXMLError("Unknown character after tag's name.", file);
          destroyXMLTag(tag);
          return NULL;
    }
 
    /* try reading attribute if tag isn't a closing one or a closed unique one */
    if(tag->type == UNKNOWN) {
-      while(charBuffer == (int)' ') {
-         addAttributeToXMLTag(readXMLAttribute(file), tag);
-         charBuffer = fgetc(file);
-      }
-      /* check character after attributes */
-      if(charBuffer == (int)'>') {
-         tag->type = OPENING;
+      /* attributes are read as bytes first */
+      if(!readXMLTagRawAttributes(file, tag, filter, &length)) {
+         destroyXMLTag(tag);
+         return NULL;
       }
-      else if(charBuffer == (int)'/') {
-         tag->type = UNIQUE;
-         charBuffer = fgetc(file);
+      charBuffer = (int)'>';
+      /* check decoded attributes' names are unique */
+      if(!checkXMLTagAttributes(tag)) {
+         logXMLError("Duplicate attribute in XML tag", file);
+         destroyXMLTag(tag);
+         return NULL;
       }
    }
 
    /* check tag closing character '>' */
    if(charBuffer != (int)'>') {
-      logError("Badly parsed XML file.",  __FILE__ ,  __LINE__ );
+      logXMLError("Badly parsed XML file.", file);
       destroyXMLTag(tag);
       return NULL;
    }
 
+   tag->end = length;
+
    return tag;
 }
 
@@ -392,7 +735,6 @@ void reachNextXMLTag(FILE* file)
    } while((charBuffer != (char)'<') && (charBuffer != EOF));
 
    if(charBuffer == EOF) {
-      logError("Reached End Of File while searching for next tag",
-                __FILE__ ,  __LINE__ );
+      logXMLError("Reached End Of File while searching for next tag", file);
    }
 }
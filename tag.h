@@ -19,6 +19,15 @@
 #ifndef XML_BUFFER_LENGTH
 #define XML_BUFFER_LENGTH  200
 #endif /* XML_BUFFER_LENGTH */
+
+/**
+ * \brief Attributes count above which duplicates are found with a hash table.
+ * Under this count, attributes are compared two by two, which is faster for
+ * the few attributes most tags have.
+ */
+#ifndef XML_ATTRIBUTE_SCAN_LIMIT
+#define XML_ATTRIBUTE_SCAN_LIMIT  8
+#endif /* XML_ATTRIBUTE_SCAN_LIMIT */
 
 
 /**
@@ -42,8 +51,13 @@ typedef enum XML_TagType {
  */
 typedef struct XML_Tag {
    char* name;             /**< Tag's name. */
+   size_t nameLength;      /**< Tag's name length, without '\\0'. */
    XML_Attribute* attr;    /**< Last added attribute. */
+   char* raw;              /**< Undecoded attributes' bytes, NULL if none. */
    XML_TagType type;       /**< Tag type (opening, closing, unique) */
+   long start;             /**< Offset of tag's '<' from where reading
+                                started, -1 if it was read before. */
+   long end;               /**< Bytes read up to tag's '>', included. */
 } XML_Tag;
 
 
@@ -59,8 +73,10 @@ void resetXMLTag(XML_Tag* tag);
 void setXMLTagName(const char* name, XML_Tag* tag);
 void addAttributeToXMLTag(XML_Attribute* attr, XML_Tag* tag);
 XML_Attribute* deleteAttributeFromXMLTag(XML_Tag* tag);
+int checkXMLTagAttributes(XML_Tag* tag);
 
 XML_Tag* readXMLTag(FILE* file);
+XML_Tag* readXMLTagFiltered(FILE* file, XML_AttributeFilter* filter);
 
 void reachNextXMLTag(FILE* file);
 
@@ -0,0 +1,133 @@
+/**
+ * \file version.c
+ * \brief Persistent XML trees' tests
+ *
+ * Diffs and patches between versions, whose nodes are only reached through
+ * their parents' children arrays. Built with the library's sources, returns
+ * 0 when every check passes.
+ *
+ * \author François-Xavier Balu \<fx.balu@gmail.com\>
+ * \date 17 octobre 2026
+ */
+
+
+#include <stdio.h>      /* printf(), fopen(), fprintf(), fclose(), remove() */
+#include <string.h>     /* strcmp() */
+
+#include "../xml.h"     /* XML_File, loadXMLFile(), getXMLValue(), getXMLNode() */
+#include "../patch.h"   /* XML_Patch, diffXMLNode(), destroyXMLPatch() */
+#include "../version.h" /* XML_Version, createXMLVersion(), applyXMLVersionPatch() */
+
+
+/**
+ * \brief Number of failed checks.
+ */
+static int failures = 0;
+
+
+/**
+ * \brief Check a condition, reporting it when it fails.
+ */
+static void checkXMLVersionTest(int condition, const char* what)
+{
+   if(!condition) {
+      printf("FAILED: %s\n", what);
+      failures++;
+   }
+}
+
+
+/**
+ * \brief Create a version from a document.
+ *
+ * \return  Version, NULL if document can't be parsed.
+ */
+static XML_Version* loadXMLVersionTest(const char* body)
+{
+   XML_Version* version;
+   XML_File* xml;
+   FILE* file;
+
+   if((file = fopen("version_test.xml", "w")) == NULL) {
+      return NULL;
+   }
+   fprintf(file, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n%s\n", body);
+   fclose(file);
+
+   version = NULL;
+   if(((xml = loadXMLFile("version_test.xml")) != NULL) && (xml->root != NULL)) {
+      version = createXMLVersion(xml);
+   }
+   destroyXMLFile(xml);
+   remove("version_test.xml");
+
+   return version;
+}
+
+
+/**
+ * \brief Patch a version into another one, and check they then match.
+ *
+ * \return  Patched version, NULL if patching failed.
+ */
+static XML_Version* patchXMLVersionTest(XML_Version* from, XML_Version* to, const char* what)
+{
+   XML_Version* patched;
+   XML_Patch *patch, *residual;
+
+   patched = NULL;
+   if((patch = diffXMLNode(from->file.root, to->file.root)) != NULL) {
+      patched = applyXMLVersionPatch(from, patch);
+      destroyXMLPatch(patch);
+   }
+   checkXMLVersionTest(patched != NULL, what);
+   if(patched != NULL) {
+      residual = diffXMLNode(patched->file.root, to->file.root);
+      checkXMLVersionTest((residual != NULL) && (residual->count == 0), what);
+      destroyXMLPatch(residual);
+   }
+
+   return patched;
+}
+
+
+int main(void)
+{
+   XML_Version *a, *b, *patched, *back;
+   XML_Node* n;
+   char* value;
+
+   a = loadXMLVersionTest("<root><a>1</a><b/></root>");
+   b = loadXMLVersionTest("<root><a>2</a><b/><c><d/><e>5</e></c></root>");
+   checkXMLVersionTest((a != NULL) && (b != NULL), "versions are loaded");
+   if((a == NULL) || (b == NULL)) {
+      return 1;
+   }
+
+   /* inserted subtree keeps all its children */
+   if((patched = patchXMLVersionTest(a, b, "insert a subtree between versions")) != NULL) {
+      n = getXMLNode("root/c", patched->file.root);
+      checkXMLVersionTest((n != NULL) && (n->cc == 2), "inserted node has its 2 children");
+      value = getXMLValue("root/c/e$", &patched->file);
+      checkXMLVersionTest((value != NULL) && (strcmp(value, "5") == 0), "root/c/e is patched");
+      value = getXMLValue("root/a$", &patched->file);
+      checkXMLVersionTest((value != NULL) && (strcmp(value, "2") == 0), "root/a is patched");
+
+      /* and back, edited version being left as it was */
+      if((back = patchXMLVersionTest(patched, a, "delete a subtree between versions")) != NULL) {
+         checkXMLVersionTest(getXMLNode("root/c", back->file.root) == NULL, "root/c is deleted");
+         destroyXMLVersion(back);
+      }
+      checkXMLVersionTest(getXMLNode("root/c/e", patched->file.root) != NULL,
+                          "patched version is unchanged");
+      destroyXMLVersion(patched);
+   }
+   value = getXMLValue("root/a$", &a->file);
+   checkXMLVersionTest((value != NULL) && (strcmp(value, "1") == 0), "first version is unchanged");
+
+   destroyXMLVersion(a);
+   destroyXMLVersion(b);
+
+   printf("%s\n", (failures == 0) ? "All version tests passed" : "Some version tests failed");
+   return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,661 @@
+/**
+ * \file version.c
+ * \brief Persistent XML trees related functions
+ *
+ * Functions to create and edit a XML_Version.
+ *
+ * A node's refs, in its XML_NodeData, counts the links to it: version roots
+ * and entries of children arrays. A node with a single link is private to the
+ * version being built and is edited in place, a node with more links is
+ * copied first.
+ * Copying a node copies its children array only, adding a link to each
+ * child, so an edit copies the nodes on the edited path and one array per
+ * level, never their siblings.
+ * Pooled nodes, see poolXMLNode(), belong to the pool: their links aren't
+ * counted, and they are always copied before an edit.
+ *
+ * \author François-Xavier Balu \<fx.balu@gmail.com\>
+ * \date 17 octobre 2026
+ */
+
+
+#include <stdlib.h>     /* malloc(), free() */
+#include <string.h>     /* memset(), memmove(), strlen(), strcmp(), strchr(), memcpy() */
+
+#include "../log.h"     /* logError(), logMem() */
+#include "attribute.h"  /* XML_Attribute */
+#include "node.h"       /* XML_Node, createXMLNode(), copyXMLNode(), getXMLChildren(),
+                           freezeXMLNodeChildren(), isXMLNodePooled() */
+#include "pool.h"       /* poolXMLString(), poolXMLAttributes(), shareXMLNode() */
+#include "version.h"
+
+
+/**
+ * \brief Add a link to a node.
+ */
+static void retainXMLVersionNode(XML_Node* n)
+{
+   if((n != NULL) && !isXMLNodePooled(n)) {
+      n->data->refs++;
+   }
+}
+
+
+/**
+ * \brief Remove a link to a node.
+ * A node without links is freed, with the links it held.
+ */
+static void releaseXMLVersionNode(XML_Node* n)
+{
+   int i;
+
+   if((n != NULL) && !isXMLNodePooled(n) && (--n->data->refs == 0)) {
+      for(i = 0; i < n->cc; i++) {
+         releaseXMLVersionNode(getXMLChildren(n)[i]);
+      }
+      freeXMLNodeData(n);
+      logMem(LOG_FREE, n, "XML_Node", "node", __FILE__, __LINE__);
+      free(n);
+   }
+}
+
+
+/**
+ * \brief Turn a mutable tree into version nodes, with pooled contents.
+ * Children are frozen, so they are only reached through their parent's
+ * children array. Pooled subtrees already are version nodes.
+ *
+ * \return  1 on success, 0 if an error happened.
+ */
+static int adoptXMLVersionTree(XML_Node* n, XML_Pool* pool)
+{
+   XML_NodeData* data;
+   XML_Node** children;
+   int i;
+
+   if(isXMLNodePooled(n)) {
+      return 1;
+   }
+   if(!shareXMLNode(n, pool) || !freezeXMLNodeChildren(n) ||
+      ((data = getXMLNodeData(n)) == NULL)) {
+      return 0;
+   }
+   data->refs = 1;
+   n->current = NULL;
+   children = getXMLChildren(n);
+   for(i = 0; i < n->cc; i++) {
+      if(!adoptXMLVersionTree(children[i], pool)) {
+         return 0;
+      }
+   }
+
+   return 1;
+}
+
+
+/**
+ * \brief Copy a version node, sharing its contents and children.
+ * Only the children array is copied, each child getting one more link.
+ *
+ * \return  Copy, with a single link, NULL if an error happened.
+ */
+static XML_Node* copyXMLVersionNode(XML_Node* n)
+{
+   XML_NodeData* data;
+   XML_NodeIndex* index;
+   XML_Node* copy;
+   int i;
+
+   decodeXMLNodeAttributes(n);
+   if((copy = createXMLNode()) == NULL) {
+      return NULL;
+   }
+   /* node's data is copied, but not its children arrays */
+   index = NULL;
+   if((data = getXMLNodeData(copy)) != NULL) {
+      *data = *n->data;
+      data->index = NULL;
+      data->shared = 1;
+      data->refs = 1;
+   }
+   if((data == NULL) ||
+      ((n->cc > 0) && (((index = getXMLNodeIndex(copy)) == NULL) ||
+                       ((index->children = malloc(n->cc * sizeof(XML_Node*))) == NULL)))) {
+      logError("Can't allocate memory for children array", __FILE__, __LINE__);
+      freeXMLNodeData(copy);
+      logMem(LOG_FREE, copy, "XML_Node", "node", __FILE__, __LINE__);
+      free(copy);
+      return NULL;
+   }
+   copy->name = n->name;
+   copy->id = n->id;
+   copy->value = n->value;
+   copy->attr = n->attr;
+   copy->first = n->first;
+   copy->last = n->last;
+   copy->cc = n->cc;
+   if(index != NULL) {
+      index->childrenLength = n->cc;
+      index->frozen = 1;
+      for(i = 0; i < n->cc; i++) {
+         index->children[i] = getXMLChildren(n)[i];
+         retainXMLVersionNode(index->children[i]);
+      }
+   }
+
+   return copy;
+}
+
+
+/**
+ * \brief Make a linked node private, copying it if it's shared.
+ *
+ * \param link    Link to the node, replaced by the copy.
+ * \param parent  Node's private parent, NULL for a root.
+ * \return        Private node, NULL if an error happened.
+ */
+static XML_Node* thawXMLVersionLink(XML_Node** link, XML_Node* parent)
+{
+   XML_Node *n, *copy;
+
+   n = *link;
+   if(isXMLNodePooled(n) || (n->data->refs > 1)) {
+      if((copy = copyXMLVersionNode(n)) == NULL) {
+         return NULL;
+      }
+      if(parent != NULL) {
+         if(parent->first == n) {
+            parent->first = copy;
+         }
+         if(parent->last == n) {
+            parent->last = copy;
+         }
+         unsortXMLNodeChildren(parent);
+      }
+      releaseXMLVersionNode(n);
+      *link = n = copy;
+   }
+   n->parent = parent;
+
+   return n;
+}
+
+
+/**
+ * \brief Make the nodes from root to a patch target private.
+ * Only the nodes of the path are copied, with their children arrays. Their
+ * hashes are reset, as the target is about to change.
+ *
+ * \param root   Private root.
+ * \param path   Children's indexes from root to target.
+ * \param depth  Number of indexes in path.
+ * \return       Private target, NULL if it doesn't exist or an error happened.
+ */
+static XML_Node* thawXMLVersionPath(XML_Node* root, int* path, int depth)
+{
+   XML_Node* n;
+   int d;
+
+   n = root;
+   n->data->hash = 0;
+   for(d = 0; d < depth; d++) {
+      if((path[d] < 0) || (path[d] >= n->cc) ||
+         ((n = thawXMLVersionLink(&getXMLChildren(n)[path[d]], n)) == NULL)) {
+         return NULL;
+      }
+      n->data->hash = 0;
+   }
+
+   return n;
+}
+
+
+/**
+ * \brief Make room for one more child in a private node's children array.
+ *
+ * \return  1 on success, 0 if an error happened.
+ */
+static int growXMLVersionChildren(XML_Node* n)
+{
+   XML_NodeIndex* index;
+   XML_Node** children;
+   int length;
+
+   if((index = getXMLNodeIndex(n)) == NULL) {
+      return 0;
+   }
+   index->frozen = 1;
+   if(n->cc < index->childrenLength) {
+      return 1;
+   }
+   length = (index->childrenLength > 0) ? 2 * index->childrenLength : 4;
+   if((children = realloc(index->children, length * sizeof(XML_Node*))) == NULL) {
+      logError("Can't reallocate memory for children array", __FILE__, __LINE__);
+      return 0;
+   }
+   index->children = children;
+   index->childrenLength = length;
+
+   return 1;
+}
+
+
+/**
+ * \brief Set a private node's first and last children from its array.
+ */
+static void linkXMLVersionChildren(XML_Node* n)
+{
+   n->first = (n->cc > 0) ? getXMLChildren(n)[0] : NULL;
+   n->last = (n->cc > 0) ? getXMLChildren(n)[n->cc - 1] : NULL;
+}
+
+
+/**
+ * \brief Change, add or delete an attribute of a private node.
+ *
+ * \param value  New value, NULL to delete the attribute.
+ * \return       1 on success, 0 if a deleted attribute doesn't exist or an
+ *               error happened.
+ */
+static int setXMLVersionAttribute(XML_Node* n, const char* name,
+                                  const char* value, XML_Pool* pool)
+{
+   XML_Attribute *attr, *list, **tail;
+   int found;
+
+   /* edit a private copy of the list, then pool it */
+   list = NULL;
+   tail = &list;
+   found = 0;
+   for(attr = n->attr; attr != NULL; attr = attr->next) {
+      if(strcmp(attr->name, name) == 0) {
+         found = 1;
+         if(value == NULL) {
+            continue;
+         }
+      }
+      *tail = createXMLAttribute();
+      copyXMLAttribute(*tail, attr);
+      if(strcmp(attr->name, name) == 0) {
+         setXMLAttributeValue(value, *tail);
+      }
+      tail = &(*tail)->next;
+   }
+   if(!found && (value != NULL)) {
+      *tail = createXMLAttribute();
+      setXMLAttributeName(name, *tail);
+      setXMLAttributeValue(value, *tail);
+   }
+
+   if(!found && (value == NULL)) {
+      return 0;
+   }
+   if(list == NULL) {
+      n->attr = NULL;
+   }
+   else {
+      attr = poolXMLAttributes(list, pool);
+      destroyXMLAttribute(list);
+      if(attr == NULL) {
+         return 0;
+      }
+      n->attr = attr;
+   }
+
+   return 1;
+}
+
+
+/**
+ * \brief Get a patch's subtree as a new version node.
+ *
+ * \return  Private copy, NULL if an error happened.
+ */
+static XML_Node* copyXMLVersionTree(XML_Node* n, XML_Pool* pool)
+{
+   XML_Node* copy;
+
+   if((n == NULL) || ((copy = copyXMLNode(n)) == NULL)) {
+      return NULL;
+   }
+   if(!adoptXMLVersionTree(copy, pool)) {
+      destroyXMLNode(copy);
+      return NULL;
+   }
+
+   return copy;
+}
+
+
+/**
+ * \brief Apply a patch operation to a version being built.
+ *
+ * \return  1 on success, 0 if operation doesn't match tree or an error happened.
+ */
+static int applyXMLVersionOp(XML_Version* version, XML_PatchOp* op)
+{
+   XML_Pool* pool;
+   XML_Node *n, *child, **children;
+   int index;
+
+   pool = version->store->pool;
+   index = 0;
+   if(thawXMLVersionLink(&version->file.root, NULL) == NULL) {
+      return 0;
+   }
+
+   switch(op->type)
+   {
+      case XML_PATCH_VALUE:
+      case XML_PATCH_SET_ATTRIBUTE:
+      case XML_PATCH_DELETE_ATTRIBUTE:
+      case XML_PATCH_INSERT:
+         if((n = thawXMLVersionPath(version->file.root, op->path, op->depth)) == NULL) {
+            return 0;
+         }
+         break;
+
+      default:
+         /* other operations edit target's parent, or replace the root */
+         if(op->depth == 0) {
+            if((op->type != XML_PATCH_REPLACE) ||
+               ((child = copyXMLVersionTree(op->node, pool)) == NULL)) {
+               return 0;
+            }
+            releaseXMLVersionNode(version->file.root);
+            version->file.root = child;
+            return 1;
+         }
+         if((n = thawXMLVersionPath(version->file.root, op->path, op->depth - 1)) == NULL) {
+            return 0;
+         }
+         index = op->path[op->depth - 1];
+         if((index < 0) || (index >= n->cc)) {
+            return 0;
+         }
+         break;
+   }
+
+   switch(op->type)
+   {
+      case XML_PATCH_VALUE:
+         n->value = NULL;
+         if((op->value != NULL) &&
+            ((n->value = poolXMLString(op->value, strlen(op->value), pool)) == NULL)) {
+            return 0;
+         }
+         return 1;
+
+      case XML_PATCH_SET_ATTRIBUTE:
+         return setXMLVersionAttribute(n, op->name, op->value, pool);
+
+      case XML_PATCH_DELETE_ATTRIBUTE:
+         return setXMLVersionAttribute(n, op->name, NULL, pool);
+
+      case XML_PATCH_INSERT:
+         if((op->index < 0) || (op->index > n->cc) || !growXMLVersionChildren(n) ||
+            ((child = copyXMLVersionTree(op->node, pool)) == NULL)) {
+            return 0;
+         }
+         children = getXMLChildren(n);
+         memmove(&children[op->index + 1], &children[op->index],
+                 (n->cc - op->index) * sizeof(XML_Node*));
+         children[op->index] = child;
+         child->parent = n;
+         n->cc++;
+         break;
+
+      case XML_PATCH_DELETE:
+         children = getXMLChildren(n);
+         releaseXMLVersionNode(children[index]);
+         memmove(&children[index], &children[index + 1],
+                 (n->cc - index - 1) * sizeof(XML_Node*));
+         n->cc--;
+         break;
+
+      case XML_PATCH_MOVE:
+         if((op->index < 0) || (op->index >= n->cc)) {
+            return 0;
+         }
+         /* links are only moved, children stay shared */
+         children = getXMLChildren(n);
+         child = children[index];
+         if(op->index > index) {
+            memmove(&children[index], &children[index + 1],
+                    (op->index - index) * sizeof(XML_Node*));
+         }
+         else {
+            memmove(&children[op->index + 1], &children[op->index],
+                    (index - op->index) * sizeof(XML_Node*));
+         }
+         children[op->index] = child;
+         break;
+
+      case XML_PATCH_REPLACE:
+         if((child = copyXMLVersionTree(op->node, pool)) == NULL) {
+            return 0;
+         }
+         children = getXMLChildren(n);
+         releaseXMLVersionNode(children[index]);
+         children[index] = child;
+         child->parent = n;
+         break;
+
+      default:
+         return 0;
+   }
+
+   linkXMLVersionChildren(n);
+   unsortXMLNodeChildren(n);
+
+   return 1;
+}
+
+
+/**
+ * \brief Create the first version of a tree, from a parsed XML file.
+ * File's tree and pool are taken by the version, and the file is left empty:
+ * it can be destroyed or loaded again.
+ *
+ * \param xml  File holding the tree.
+ * \return     Created version, NULL if an error happened.
+ */
+XML_Version* createXMLVersion(XML_File* xml)
+{
+   XML_Version* version;
+   XML_VersionStore* store;
+
+   if((xml == NULL) || (xml->root == NULL)) {
+      logError("Trying to create a version of a NULL tree", __FILE__, __LINE__);
+      return NULL;
+   }
+
+   /* file keeps a consistent tree if something fails */
+   if((xml->pool == NULL) && ((xml->pool = createXMLPool()) == NULL)) {
+      return NULL;
+   }
+   if(!adoptXMLVersionTree(xml->root, xml->pool)) {
+      return NULL;
+   }
+
+   if((store = malloc(sizeof(XML_VersionStore))) == NULL) {
+      logError("Can't allocate memory for XML_VersionStore", __FILE__, __LINE__);
+      return NULL;
+   }
+   logMem(LOG_ALLOC, store, "XML_VersionStore", "version store", __FILE__, __LINE__);
+   if((version = malloc(sizeof(XML_Version))) == NULL) {
+      logError("Can't allocate memory for XML_Version", __FILE__, __LINE__);
+      logMem(LOG_FREE, store, "XML_VersionStore", "version store", __FILE__, __LINE__);
+      free(store);
+      return NULL;
+   }
+   logMem(LOG_ALLOC, version, "XML_Version", "version", __FILE__, __LINE__);
+
+   /* flattened values point into the taken tree */
+   unflattenXMLFile(xml);
+   store->pool = xml->pool;
+   store->count = 1;
+   memset(&version->file, 0, sizeof(XML_File));
+   version->file.root = xml->root;
+   version->file.pool = store->pool;
+   version->store = store;
+   xml->root = NULL;
+   xml->pool = NULL;
+
+   return version;
+}
+
+
+/**
+ * \brief Destroy a version.
+ * Nodes shared with other versions are kept, and the pool is destroyed with
+ * the last version.
+ *
+ * \param version  Destroyed version.
+ */
+void destroyXMLVersion(XML_Version* version)
+{
+   if(version == NULL) {
+      logError("Trying to destroy a NULL XML_Version", __FILE__, __LINE__);
+   }
+   else {
+      unflattenXMLFile(&version->file);
+      releaseXMLVersionNode(version->file.root);
+      if(--version->store->count == 0) {
+         destroyXMLPool(version->store->pool);
+         logMem(LOG_FREE, version->store, "XML_VersionStore", "version store",
+                __FILE__, __LINE__);
+         free(version->store);
+      }
+      logMem(LOG_FREE, version, "XML_Version", "version", __FILE__, __LINE__);
+      free(version);
+   }
+}
+
+
+/**
+ * \brief Create a new version by applying a patch to a version.
+ * Given version isn't modified. A patch computed by diffXMLNode() from a
+ * version's tree gives a version sharing all unchanged subtrees with it.
+ *
+ * \param version  Edited version.
+ * \param patch    Applied patch.
+ * \return         New version, NULL if the patch doesn't match the tree or an
+ *                 error happened.
+ */
+XML_Version* applyXMLVersionPatch(XML_Version* version, XML_Patch* patch)
+{
+   XML_Version* copy;
+   int i;
+
+   if((version == NULL) || (patch == NULL)) {
+      logError("Trying to patch a NULL version, or with a NULL patch", __FILE__, __LINE__);
+      return NULL;
+   }
+
+   if((copy = malloc(sizeof(XML_Version))) == NULL) {
+      logError("Can't allocate memory for XML_Version", __FILE__, __LINE__);
+      return NULL;
+   }
+   logMem(LOG_ALLOC, copy, "XML_Version", "version", __FILE__, __LINE__);
+   memset(&copy->file, 0, sizeof(XML_File));
+   copy->file.root = version->file.root;
+   copy->file.pool = version->file.pool;
+   copy->store = version->store;
+   copy->store->count++;
+   retainXMLVersionNode(copy->file.root);
+
+   for(i = 0; i < patch->count; i++) {
+      if(!applyXMLVersionOp(copy, &patch->ops[i])) {
+         logError("Patch doesn't match version", __FILE__, __LINE__);
+         destroyXMLVersion(copy);
+         return NULL;
+      }
+   }
+
+   return copy;
+}
+
+
+/**
+ * \brief Create a new version with a node's value changed.
+ * Given version isn't modified.
+ *
+ * \param[in] path     Node path in the tree, as for getXMLNode().
+ * \param[in] value    New value, NULL to remove it.
+ * \param     version  Edited version.
+ * \return             New version, NULL if there is no such node or an error
+ *                     happened.
+ */
+XML_Version* setXMLVersionValue(char* path, const char* value, XML_Version* version)
+{
+   char segment[XML_BUFFER_LENGTH];
+   XML_PatchOp op;
+   XML_Patch patch;
+   XML_Version* edited;
+   XML_Node *n, *found;
+   char* end;
+   size_t length;
+   int depth, i;
+
+   if((path == NULL) || (version == NULL)) {
+      logError("Trying to edit a NULL path, or a NULL version", __FILE__, __LINE__);
+      return NULL;
+   }
+
+   /* one index per '/', root isn't in a patch path */
+   depth = 0;
+   for(end = path; (end = strchr(end, '/')) != NULL; end++) {
+      depth++;
+   }
+   memset(&op, 0, sizeof(XML_PatchOp));
+   op.type = XML_PATCH_VALUE;
+   op.value = (char*)value;
+   if((depth > 0) && ((op.path = malloc(depth * sizeof(int))) == NULL)) {
+      logError("Can't allocate memory for version path", __FILE__, __LINE__);
+      return NULL;
+   }
+
+   /* finds each node of path in its parent's children array, to get its
+      index: version nodes aren't linked to their siblings, so getXMLNode()
+      only checks the given one */
+   n = NULL;
+   for(;;) {
+      if((end = strchr(path, '/')) == NULL) {
+         end = path + strlen(path);
+      }
+      if((length = end - path) >= XML_BUFFER_LENGTH) {
+         n = NULL;
+         break;
+      }
+      memcpy(segment, path, length);
+      segment[length] = '\0';
+      if(n == NULL) {
+         found = getXMLNode(segment, version->file.root);
+      }
+      else {
+         for(i = 0, found = NULL; (i < n->cc) && (found == NULL); i++) {
+            found = getXMLNode(segment, getXMLChildren(n)[i]);
+         }
+         op.path[op.depth++] = i - 1;
+      }
+      if((n = found) == NULL) {
+         break;
+      }
+      if(*end == '\0') {
+         break;
+      }
+      path = end + 1;
+   }
+
+   edited = NULL;
+   if(n != NULL) {
+      patch.ops = &op;
+      patch.count = 1;
+      patch.capacity = 1;
+      edited = applyXMLVersionPatch(version, &patch);
+   }
+   free(op.path);
+
+   return edited;
+}
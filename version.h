@@ -0,0 +1,58 @@
+/**
+ * \file version.h
+ * \brief Persistent XML trees related definitions
+ *
+ * Definition of a XML_Version structure, an immutable version of a XML tree.
+ * Editing a version gives a new one: only the edited nodes and their ancestors
+ * are copied, with their children arrays, every other subtree is shared with
+ * the edited version. Each version stays valid until it is destroyed, and is
+ * read with getXMLValue() and getXMLNode() like a XML_File.
+ *
+ * Nodes of a version must not be modified. As they may belong to several
+ * versions, only their name, value, attributes and children array, with the
+ * first and last children, are meaningful; parent may be that of another
+ * version, and previous and next siblings are NULL. Children are iterated
+ * with getXMLNextChild().
+ * Versions can be read by several threads, but creating and destroying them
+ * must be serialized.
+ *
+ * \author François-Xavier Balu \<fx.balu@gmail.com\>
+ * \date 17 octobre 2026
+ */
+
+
+#ifndef VERSION_H_INCLUDED
+#define VERSION_H_INCLUDED
+
+
+#include "xml.h"     /* XML_File */
+#include "patch.h"   /* XML_Patch */
+#include "pool.h"    /* XML_Pool */
+
+
+/**
+ * \brief Contents shared by all versions of a tree.
+ */
+typedef struct XML_VersionStore {
+   XML_Pool* pool;   /**< Names, values and attributes of all versions. */
+   int count;        /**< Number of living versions. */
+} XML_VersionStore;
+
+
+/**
+ * \brief Immutable version of a XML tree.
+ */
+typedef struct XML_Version {
+   XML_File file;             /**< Version's tree, read through &version->file. */
+   XML_VersionStore* store;   /**< Contents shared with other versions. */
+} XML_Version;
+
+
+XML_Version* createXMLVersion(XML_File* xml);
+void destroyXMLVersion(XML_Version* version);
+
+XML_Version* applyXMLVersionPatch(XML_Version* version, XML_Patch* patch);
+XML_Version* setXMLVersionValue(char* path, const char* value, XML_Version* version);
+
+
+#endif /* VERSION_H_INCLUDED */
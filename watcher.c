@@ -0,0 +1,302 @@
+/**
+ * \file watcher.c
+ * \brief Watched XML files related functions
+ *
+ * Functions to use a XML_Watcher structure. Linux only, as it relies on
+ * inotify.
+ *
+ * \author François-Xavier Balu \<fx.balu@gmail.com\>
+ * \date 17 octobre 2026
+ */
+
+
+/* clock_gettime() and CLOCK_MONOTONIC are POSIX, not C99 */
+#define _POSIX_C_SOURCE  200809L
+
+#include <stdlib.h>        /* malloc(), calloc(), free() */
+#include <string.h>        /* strlen(), strcpy(), strrchr(), strcmp() */
+#include <unistd.h>        /* read(), write(), close(), pipe() */
+#include <poll.h>          /* poll() */
+#include <time.h>          /* clock_gettime() */
+#include <sys/inotify.h>   /* inotify_init1(), inotify_add_watch() */
+
+#include "../log.h"        /* logError(), logMem() */
+#include "xml.h"           /* loadXMLFile(), destroyXMLFile() */
+#include "watcher.h"
+
+
+/**
+ * \brief Events meaning a file was written or replaced.
+ */
+#define XML_WATCHER_EVENTS  (IN_CLOSE_WRITE | IN_MOVED_TO)
+
+
+/**
+ * \brief Start watching a file's directory.
+ *
+ * \return  1 on success, 0 if an error happened.
+ */
+static int watchXMLFile(XML_WatchedFile* file, const char* path, int fd)
+{
+   char* slash;
+
+   if((file->path = malloc((strlen(path) + 1) * sizeof(char))) == NULL) {
+      logError("Can't allocate memory for watched path", __FILE__, __LINE__);
+      return 0;
+   }
+   strcpy(file->path, path);
+
+   /* split path in place to watch directory, then restore it */
+   if((slash = strrchr(file->path, '/')) == NULL) {
+      file->name = file->path;
+      file->wd = inotify_add_watch(fd, ".", XML_WATCHER_EVENTS);
+   }
+   else {
+      file->name = slash + 1;
+      *slash = '\0';
+      file->wd = inotify_add_watch(fd, (slash == file->path) ? "/" : file->path,
+                                   XML_WATCHER_EVENTS);
+      *slash = '/';
+   }
+
+   if(file->wd < 0) {
+      logError("Can't watch directory of XML file", __FILE__, __LINE__);
+      return 0;
+   }
+
+   return 1;
+}
+
+
+/**
+ * \brief Mark files concerned by read inotify events as changed.
+ *
+ * \return  1 if a watched file changed, 0 otherwise.
+ */
+static int readXMLWatcherEvents(XML_Watcher* watcher)
+{
+   char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+   const struct inotify_event* event;
+   ssize_t length;
+   char* position;
+   int i, changed;
+
+   changed = 0;
+   while((length = read(watcher->fd, buffer, sizeof(buffer))) > 0) {
+      for(position = buffer;
+          position < buffer + length;
+          position += sizeof(struct inotify_event) + event->len) {
+         event = (const struct inotify_event*)position;
+         if(event->len == 0) {
+            continue;
+         }
+         for(i = 0; i < watcher->count; i++) {
+            if((watcher->files[i].wd == event->wd) &&
+               (strcmp(watcher->files[i].name, event->name) == 0)) {
+               watcher->files[i].changed = 1;
+               changed = 1;
+            }
+         }
+      }
+   }
+
+   return changed;
+}
+
+
+/**
+ * \brief Parse changed files again, and give them to callback.
+ * Versions identical to the previous one given are dropped.
+ */
+static void reloadXMLWatchedFiles(XML_Watcher* watcher)
+{
+   XML_File* xml;
+   int i;
+
+   for(i = 0; i < watcher->count; i++) {
+      if(watcher->files[i].changed) {
+         watcher->files[i].changed = 0;
+         if((xml = loadXMLFile(watcher->files[i].path)) == NULL) {
+            continue;
+         }
+         if(xml->root == NULL) {
+            logError("Can't parse changed XML file", __FILE__, __LINE__);
+            destroyXMLFile(xml);
+            continue;
+         }
+         closeXMLFile(xml);
+         /* saved again without any change */
+         if(getXMLNodeHash(xml->root) == watcher->files[i].hash) {
+            destroyXMLFile(xml);
+            continue;
+         }
+         watcher->files[i].hash = getXMLNodeHash(xml->root);
+         watcher->callback(watcher->files[i].path, xml, watcher->data);
+      }
+   }
+}
+
+
+/**
+ * \brief Monotonic clock, in milliseconds.
+ */
+static long long getXMLWatcherTime(void)
+{
+   struct timespec now;
+
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   return (long long)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+
+/**
+ * \brief Watching thread.
+ * Waits for events without timeout, then waits until no watched file was
+ * written during debounce delay before parsing changed files. Events about
+ * other files of watched directories don't delay reloading.
+ */
+static void* runXMLWatcher(void* data)
+{
+   XML_Watcher* watcher;
+   struct pollfd fds[2];
+   long long deadline, left;
+   int pending, ready, timeout;
+
+   watcher = data;
+   fds[0].fd = watcher->fd;
+   fds[0].events = POLLIN;
+   fds[1].fd = watcher->stop[0];
+   fds[1].events = POLLIN;
+   pending = 0;
+   deadline = 0;
+
+   while(1) {
+      timeout = -1;
+      if(pending) {
+         left = deadline - getXMLWatcherTime();
+         timeout = (left > 0) ? (int)left : 0;
+      }
+      ready = poll(fds, 2, timeout);
+      if(ready < 0) {
+         continue;
+      }
+      /* asked to stop */
+      if(fds[1].revents & POLLIN) {
+         break;
+      }
+      /* more writes to watched files, wait again for a quiet delay */
+      if(fds[0].revents & POLLIN) {
+         if(readXMLWatcherEvents(watcher)) {
+            pending = 1;
+            deadline = getXMLWatcherTime() + watcher->debounce;
+         }
+      }
+      /* quiet delay elapsed */
+      if(pending && (getXMLWatcherTime() >= deadline)) {
+         reloadXMLWatchedFiles(watcher);
+         pending = 0;
+      }
+   }
+
+   return NULL;
+}
+
+
+/**
+ * \brief Start watching XML files.
+ *
+ * \param[in] paths     Watched files' paths.
+ * \param     count     Number of watched files.
+ * \param     debounce  Milliseconds without writes before a changed file is
+ *                      parsed again.
+ * \param     callback  Called with each new version of a file.
+ * \param     data      Given to callback.
+ * \return              Created watcher, NULL if an error happened.
+ */
+XML_Watcher* createXMLWatcher(const char** paths, int count, int debounce,
+                              XML_WatcherCallback callback, void* data)
+{
+   XML_Watcher* watcher;
+   int i, success;
+
+   if((paths == NULL) || (count <= 0) || (callback == NULL)) {
+      logError("Trying to watch without paths or callback", __FILE__, __LINE__);
+      return NULL;
+   }
+   if((watcher = malloc(sizeof(XML_Watcher))) == NULL) {
+      logError("Can't allocate memory for XML_Watcher", __FILE__, __LINE__);
+      return NULL;
+   }
+   logMem(LOG_ALLOC, watcher, "XML_Watcher", "watcher", __FILE__, __LINE__);
+   watcher->count = count;
+   watcher->debounce = debounce;
+   watcher->callback = callback;
+   watcher->data = data;
+   watcher->threadStarted = 0;
+   watcher->stop[0] = watcher->stop[1] = -1;
+   watcher->files = calloc(count, sizeof(XML_WatchedFile));
+   watcher->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+   success = (watcher->files != NULL) && (watcher->fd >= 0);
+   if(!success) {
+      logError("Can't initialize XML_Watcher", __FILE__, __LINE__);
+   }
+   for(i = 0; (i < count) && success; i++) {
+      success = watchXMLFile(&watcher->files[i], paths[i], watcher->fd);
+   }
+   if(success && (pipe(watcher->stop) != 0)) {
+      logError("Can't create XML_Watcher stop pipe", __FILE__, __LINE__);
+      success = 0;
+   }
+   if(success && (pthread_create(&watcher->thread, NULL, runXMLWatcher, watcher) != 0)) {
+      logError("Can't start watching thread", __FILE__, __LINE__);
+      success = 0;
+   }
+
+   if(!success) {
+      destroyXMLWatcher(watcher);
+      return NULL;
+   }
+   watcher->threadStarted = 1;
+
+   return watcher;
+}
+
+
+/**
+ * \brief Stop watching XML files.
+ * Waits for watching thread, and a callback it may be running, to end.
+ *
+ * \param watcher  Destroyed watcher.
+ */
+void destroyXMLWatcher(XML_Watcher* watcher)
+{
+   int i;
+
+   if(watcher == NULL) {
+      logError("Trying to destroy a NULL XML_Watcher", __FILE__, __LINE__);
+   }
+   else {
+      if(watcher->threadStarted) {
+         if(write(watcher->stop[1], "", 1) != 1) {
+            logError("Can't wake watching thread up", __FILE__, __LINE__);
+         }
+         pthread_join(watcher->thread, NULL);
+      }
+      if(watcher->stop[0] >= 0) {
+         close(watcher->stop[0]);
+         close(watcher->stop[1]);
+      }
+      if(watcher->fd >= 0) {
+         close(watcher->fd);
+      }
+      if(watcher->files != NULL) {
+         for(i = 0; i < watcher->count; i++) {
+            free(watcher->files[i].path);
+         }
+         free(watcher->files);
+      }
+      logMem(LOG_FREE, watcher, "XML_Watcher", "watcher", __FILE__, __LINE__);
+      free(watcher);
+   }
+}
@@ -0,0 +1,71 @@
+/**
+ * \file watcher.h
+ * \brief Watched XML files related definitions
+ *
+ * Definition of a XML_Watcher structure, which watches some XML files with
+ * inotify and parses them again in a background thread when they change.
+ * Bursts of writes are coalesced: a file is parsed once it has been left
+ * untouched for a debounce delay.
+ *
+ * \author François-Xavier Balu \<fx.balu@gmail.com\>
+ * \date 17 octobre 2026
+ */
+
+
+#ifndef WATCHER_H_INCLUDED
+#define WATCHER_H_INCLUDED
+
+
+#include <pthread.h>    /* pthread_t */
+
+#include "xml.h"        /* XML_File */
+
+
+/**
+ * \brief Function called with each new version of a watched file.
+ * It runs in watcher's thread, and owns given XML_File, which it can give to
+ * publishXMLReload() for instance.
+ *
+ * \param path  Path of changed file, as given to watcher.
+ * \param xml   Newly parsed file.
+ * \param data  User data given to watcher.
+ */
+typedef void (*XML_WatcherCallback)(const char* path, XML_File* xml, void* data);
+
+
+/**
+ * \brief Watched XML file.
+ * Its directory is watched rather than the file itself, so files replaced by
+ * a rename, as most editors save them, are still seen.
+ */
+typedef struct XML_WatchedFile {
+   char* path;       /**< Path given to watcher. */
+   char* name;       /**< File name, in path. */
+   int wd;           /**< Watch descriptor of file's directory. */
+   int changed;      /**< 1 if file changed since last parsing. */
+   unsigned long long hash;   /**< Tree hash of last version, 0 if none. */
+} XML_WatchedFile;
+
+
+/**
+ * \brief Watcher of XML files.
+ */
+typedef struct XML_Watcher {
+   XML_WatchedFile* files;          /**< Watched files. */
+   int count;                       /**< Number of watched files. */
+   int fd;                          /**< inotify file descriptor. */
+   int stop[2];                     /**< Pipe waking thread up to stop it. */
+   int debounce;                    /**< Quiet delay before parsing, in ms. */
+   XML_WatcherCallback callback;    /**< Called with new versions. */
+   void* data;                      /**< Given to callback. */
+   pthread_t thread;                /**< Watching thread. */
+   int threadStarted;               /**< 1 if thread must be joined. */
+} XML_Watcher;
+
+
+XML_Watcher* createXMLWatcher(const char** paths, int count, int debounce,
+                              XML_WatcherCallback callback, void* data);
+void destroyXMLWatcher(XML_Watcher* watcher);
+
+
+#endif /* WATCHER_H_INCLUDED */
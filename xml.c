@@ -9,12 +9,20 @@
  */
 
 
-#include <stdio.h>   /* printf(), fopen(), fclose(), fgets() */
+/* clock_gettime() and CLOCK_MONOTONIC are POSIX, not C99 */
+#define _POSIX_C_SOURCE  200809L
+
+#include <stdio.h>   /* printf(), fopen(), fclose(), fgets(), ftell(), fseek() */
 #include <stdlib.h>  /* malloc(), free(), atoi(), strtod() */
-#include <string.h>  /* strlen(), strcpy(), strcmp() */
+#include <string.h>  /* strlen(), strcpy(), strcmp(), memcmp(), memset() */
+#include <time.h>    /* clock_gettime() */
 
 #include "../log.h"  /* logError() */
 #include "node.h"    /* XML_Node */
+#include "namespace.h"  /* XML_NamespaceStack */
+#include "pool.h"    /* XML_Pool, shareXMLNode(), poolXMLNode() */
+#include "projection.h" /* XML_Projection, matchXMLProjection(), startXMLSkip(), ... */
+#include "error.h"   /* XML_Error, logXMLError(), getXMLError(), locateXMLErrors() */
 #include "xml.h"
 
 
@@ -36,6 +44,19 @@ XML_File* createXMLFile(void)
       xml->path = NULL;
       xml->file = NULL;
       xml->root = NULL;
+      xml->flat = NULL;
+      xml->blocks = NULL;
+      xml->blockLengths = NULL;
+      xml->blockCount = 0;
+      xml->size = 0;
+      xml->pool = NULL;
+      xml->status = XML_STATUS_UNPARSED;
+      xml->errors = NULL;
+      xml->errorCount = 0;
+      xml->projection = NULL;
+      xml->filter = NULL;
+      memset(&xml->limits, 0, sizeof(XML_ParseLimits));
+      xml->flags = 0;
    }
 
    return xml;
@@ -63,10 +84,29 @@ void destroyXMLFile(XML_File* xml)
          logMem(LOG_FREE, xml->file, "file", "xml file", __FILE__, __LINE__);
          fclose(xml->file);
       }
+      /* destroy flattened tree, before the tree it points to */
+      if(xml->flat != NULL) {
+         destroyXMLFlat(xml->flat);
+      }
       /* destroy tree */
       if(xml->root != NULL) {
          destroyXMLNode(xml->root);
       }
+      /* free blocks' hashes and recovered errors */
+      free(xml->blocks);
+      free(xml->blockLengths);
+      free(xml->errors);
+      /* destroy pool, after the nodes sharing its contents */
+      if(xml->pool != NULL) {
+         destroyXMLPool(xml->pool);
+      }
+      /* destroy options kept for reparsing */
+      if(xml->projection != NULL) {
+         destroyXMLProjection(xml->projection);
+      }
+      if(xml->filter != NULL) {
+         destroyXMLAttributeFilter(xml->filter);
+      }
       /* free XML_File */
       logMem(LOG_FREE, xml, "XML_File", "xml file", __FILE__, __LINE__);
       free(xml);
@@ -173,75 +213,378 @@ int checkFirstLineXMLFile(XML_File* xml)
 
 XML_Node* parseXMLFile(FILE* file)
 {
-   XML_Node *current, *child, *root;
-   XML_Tag* tag;
-   int endOfParsing;
+   XML_NamespaceStack* namespaces;
+   XML_Node* root;
+
+   if((namespaces = createXMLNamespaceStack()) == NULL) {
+      return NULL;
+   }
+   root = parseXMLElement(file, namespaces, NULL, NULL, NULL, NULL);
+   destroyXMLNamespaceStack(namespaces);
+
+   return root;
+}
+
+
+/**
+ * \brief Create skipped elements holding an element kept by name.
+ * They only get their names, as their tags weren't read.
+ *
+ * \return  Innermost created element, NULL if an error happened.
+ */
+static XML_Node* openXMLSkippedElements(XML_Node* current, int count,
+                                        XML_Projection* projection,
+                                        XML_NamespaceStack* namespaces)
+{
+   XML_Node* child;
+   int i;
+
+   for(i = 0; i < count; i++) {
+      child = createXMLNode();
+      setXMLNodeName(getXMLProjectionPending(projection, i), child);
+      addXMLNodeToParent(current, child);
+      if(!openXMLNamespaceScope(namespaces) ||
+         !resolveXMLNodeNamespaces(child, namespaces)) {
+         return NULL;
+      }
+      current = child;
+   }
+
+   return current;
+}
+
+
+/**
+ * \brief Check if an opened node is within parsing's limits.
+ * A record within them is only counted as kept once its node is added, see
+ * countXMLKeptRecord(), as projection or recovery may still drop it.
+ *
+ * \param record  1 if node is a record, a child of the root.
+ * \param level   Level of node's parent, root's being 1.
+ * \return        1 if node is kept, 0 if it's skipped.
+ */
+static int isXMLNodeWithinLimits(XML_ParseLimits* limits, int record, int level)
+{
+   if((limits->maxDepth > 0) && (level >= limits->maxDepth)) {
+      return 0;
+   }
+   if(record) {
+      limits->records++;
+      if((limits->sampleEvery > 1) && ((limits->records - 1) % limits->sampleEvery != 0)) {
+         return 0;
+      }
+   }
+
+   return 1;
+}
+
+
+/**
+ * \brief Count a record node added under the root, for maxRecords.
+ */
+static void countXMLKeptRecord(XML_Parser* p, XML_Node* parent)
+{
+   if((p->limits != NULL) && (parent == p->root)) {
+      p->limits->kept++;
+   }
+}
+
+
+/**
+ * \brief Share a closed node's contents in parser's pool, if it has one.
+ * Node itself is then pooled, unless it holds offsets, which differ between
+ * identical subtrees: it mustn't be used anymore.
+ */
+static void shareXMLParserNode(XML_Parser* p, XML_Node* n)
+{
+   if((p->pool != NULL) && shareXMLNode(n, p->pool) && !p->offsets &&
+      (n->parent != NULL)) {
+      poolXMLNode(n, p->pool);
+   }
+}
 
-   current = child = root = NULL;
-   tag = NULL;
-   endOfParsing = 0;
+
+/**
+ * \brief Go on skipping the parser's skipped element, within call's budget.
+ * A huge element is thus skipped over several steps, between which budget
+ * and progress are checked.
+ */
+static void skipXMLParserElement(XML_Parser* p)
+{
+   XML_Projection* projection;
+   long bytes, read;
+   int skipped;
+
+   /* a spent budget still skips up to the next tag, so each step progresses */
+   bytes = 0;
+   if(p->until > 0) {
+      bytes = (p->until > p->offset) ? p->until - p->offset : 1;
+   }
+   projection = p->skipping;
+   skipped = continueXMLSkip(p->file, projection, bytes, &read);
+   p->offset += read;
+   /* elements being skipped are kept on error, for recovery */
+   if(skipped == XML_PROJECTION_ERROR) {
+      p->error = 1;
+      return;
+   }
+   if(skipped == XML_PROJECTION_AGAIN) {
+      return;
+   }
+   p->skipping = NULL;
+   /* skipped elements hold one kept by name, read next */
+   if(skipped > 0) {
+      countXMLKeptRecord(p, p->current);
+      if((p->current = openXMLSkippedElements(p->current, skipped, projection,
+                                              p->namespaces)) == NULL) {
+         p->error = 1;
+      }
+      else {
+         p->level += skipped;
+      }
+      /* skipped elements' nodes have no known range */
+      p->last = -1;
+   }
+}
+
+
+/**
+ * \brief Read the first tag of a parsed element, and create its node.
+ *
+ * \return  1 on success, 0 if an error happened.
+ */
+static int beginXMLParser(XML_Parser* p)
+{
+   XML_Tag* tag;
+   long start;
+
+   p->current = p->root = p->kept = NULL;
+   p->skipper = p->skipping = NULL;
+   p->unmatched = XML_NO_NAME;
+   p->endOfParsing = p->error = 0;
+   p->depth = p->namespaces->depth;
+   p->level = 1;
+   p->match = XML_PROJECTION_KEEP;
+   /* asked once, tokenizer counting read bytes afterwards */
+   p->offset = ftell(p->file);
 
    /* read first tag */
-   if((tag = readXMLTag(file)) == NULL) {
+   if((tag = readXMLTagFiltered(p->file, p->filter)) == NULL) {
       logError("Nothing to parse", __FILE__, __LINE__);
       destroyXMLTag(tag);
-      return NULL;
+      p->error = 1;
+      return 0;
    }
    else if(tag->type == CLOSING) {
-      logError("First tag is a closing tag", __FILE__, __LINE__);
+      logXMLError("First tag is a closing tag", p->file);
       destroyXMLTag(tag);
-      return NULL;
+      p->error = 1;
+      return 0;
+   }
+
+   /* create root, that is the only node if tag is a unique one */
+   start = p->offset + tag->start;
+   p->offset += tag->end;
+   p->current = p->root = createXMLNode();
+   initXMLNodeFromXMLTag(p->root, tag);
+   if(p->offsets) {
+      setXMLNodeOffset(p->root, start);
+      /* an open node's length holds its start until it's closed */
+      setXMLNodeLength(p->root, (tag->type == UNIQUE) ? (p->offset - start) : start);
+   }
+   p->last = p->recordEnd = start;
+   if((p->projection == NULL) ||
+      (matchXMLProjection(p->projection, NULL, p->root->id) == XML_PROJECTION_KEEP)) {
+      p->kept = p->root;
+   }
+   if(!openXMLNamespaceScope(p->namespaces) ||
+      !resolveXMLNodeNamespaces(p->root, p->namespaces)) {
+      p->error = 1;
    }
    else if(tag->type == UNIQUE) {
-      root = createXMLNode();
-      initXMLNodeFromXMLTag(root, tag);
-      destroyXMLTag(tag);
-      return root;
+      p->endOfParsing = 1;
+      shareXMLParserNode(p, p->root);
    }
-   else /* tag->type == OPENING */ {
-      current = root = createXMLNode();
-      initXMLNodeFromXMLTag(current, tag);
-      destroyXMLTag(tag);
+   destroyXMLTag(tag);
+
+   return !p->error;
+}
+
+
+/**
+ * \brief Read a parsed element's next node value and tag.
+ * Parsing is over once endOfParsing or error is set.
+ */
+static void stepXMLParser(XML_Parser* p)
+{
+   XML_Node* child;
+   XML_Tag* tag;
+   long start;
+
+   /* element skipped by previous steps goes on */
+   if(p->skipping != NULL) {
+      skipXMLParserElement(p);
+      return;
    }
 
-   /* read following node's value or tags, if any */
-   while(endOfParsing == 0) {
-      //reachNextXMLTag(file);  // prevent parsing to read a node's value.
-      readXMLNodeValue(current, file);
-      tag = readXMLTag(file);
+   /* enough records were kept, tree ends here */
+   if((p->limits != NULL) && (p->limits->maxRecords > 0) && (p->current == p->root) &&
+      (p->limits->kept >= p->limits->maxRecords)) {
+      p->limits->stopped = 1;
+      p->endOfParsing = 1;
+      setXMLNodeLength(p->root, -1);
+      shareXMLParserNode(p, p->root);
+      return;
+   }
 
-      if(tag == NULL) {
-         logError("No tag remaining, and tree isn't finished",
-                  __FILE__, __LINE__);
-         destroyXMLNode(root);
-         return NULL;
+   //reachNextXMLTag(file);  // prevent parsing to read a node's value.
+   p->offset += readXMLNodeValue(p->current, p->file);
+   tag = readXMLTagFiltered(p->file, p->filter);
+   if(tag != NULL) {
+      start = p->offset + tag->start;
+      p->offset += tag->end;
+   }
+
+   if(tag == NULL) {
+      logXMLError("No tag remaining, and tree isn't finished", p->file);
+      p->error = 1;
+      return;
+   }
+   /* Tag opens a record left out by sampling, or a too deep node */
+   else if(((tag->type == OPENING) || (tag->type == UNIQUE)) && (p->limits != NULL) &&
+           !isXMLNodeWithinLimits(p->limits, p->current == p->root, p->level)) {
+      if(tag->type == OPENING) {
+         if(((p->skipper == NULL) && ((p->skipper = createXMLProjection(NULL, 0)) == NULL)) ||
+            !startXMLSkip(tag, p->skipper)) {
+            p->error = 1;
+         }
+         else {
+            p->skipping = p->skipper;
+            skipXMLParserElement(p);
+         }
+      }
+   }
+   /* Tag opens a child node that isn't kept, skipped up to its end */
+   else if(((tag->type == OPENING) || (tag->type == UNIQUE)) &&
+           (p->kept == NULL) &&
+           ((p->match = matchXMLProjection(p->projection, p->current,
+                                           findXMLName(tag->name, tag->nameLength))) ==
+            XML_PROJECTION_SKIP)) {
+      if(tag->type == OPENING) {
+         if(!startXMLSkip(tag, p->projection)) {
+            p->error = 1;
+         }
+         else {
+            p->skipping = p->projection;
+            skipXMLParserElement(p);
+         }
+      }
+   }
+   /* Tag opens a child node for current node, or a node of its own */
+   else if((tag->type == OPENING) || (tag->type == UNIQUE)) {
+      child = createXMLNode();
+      initXMLNodeFromXMLTag(child, tag);
+      addXMLNodeToParent(p->current, child);
+      countXMLKeptRecord(p, p->current);
+      if(p->offsets) {
+         setXMLNodeOffset(child, (p->last < 0) ? -1 : (start - p->last));
+         setXMLNodeLength(child, (tag->type == OPENING) ? start : (p->offset - start));
+      }
+      if(tag->type == OPENING) {
+         p->last = start;
+      }
+      else {
+         p->last = p->offset;
+         if(p->current == p->root) {
+            p->recordEnd = p->offset;
+         }
+      }
+      if(!openXMLNamespaceScope(p->namespaces) ||
+         !resolveXMLNodeNamespaces(child, p->namespaces)) {
+         p->error = 1;
       }
-      /* Tag opens a child node for current node */
       else if(tag->type == OPENING) {
-         child = createXMLNode();
-         initXMLNodeFromXMLTag(child, tag);
-         addXMLNodeToParent(current, child);
-         current = child;
-      }
-      else if(tag->type == UNIQUE) {
-         child = createXMLNode();
-         initXMLNodeFromXMLTag(child, tag);
-         addXMLNodeToParent(current, child);
-      }
-      /* Tag close current node */
-      else if(tag->type == CLOSING) {
-         if(current->parent != NULL) {
-            current = current->parent;
+         p->current = child;
+         p->level++;
+         if((p->kept == NULL) && (p->match == XML_PROJECTION_KEEP)) {
+            p->kept = child;
+         }
+      }
+      else {
+         closeXMLNamespaceScope(p->namespaces);
+         shareXMLParserNode(p, child);
+      }
+   }
+   /* Tag close current node, only if names match */
+   else if(tag->type == CLOSING) {
+      if(XML_CHECK_CLOSING_TAGS && (strcmp(tag->name, p->current->name) != 0)) {
+         logXMLError("Closing tag doesn't match current node", p->file);
+         p->unmatched = internXMLName(tag->name, tag->nameLength);
+         p->error = 1;
+      }
+      else {
+         closeXMLNamespaceScope(p->namespaces);
+         if((start = getXMLNodeLength(p->current)) >= 0) {
+            setXMLNodeLength(p->current, p->offset - start);
+         }
+         p->last = p->offset;
+         if(p->current == p->kept) {
+            p->kept = NULL;
+         }
+         /* closed node is shared once parser left it */
+         child = p->current;
+         if(child->parent != NULL) {
+            p->current = child->parent;
+            p->level--;
+            if(p->current == p->root) {
+               p->recordEnd = p->offset;
+            }
          }
          else {
-            endOfParsing = 1;
+            p->endOfParsing = 1;
          }
+         shareXMLParserNode(p, child);
       }
+   }
 
-      destroyXMLTag(tag);
+   destroyXMLTag(tag);
+}
+
+
+/**
+ * \brief End a parsed element, leaving namespaces as they were.
+ *
+ * \return  Element's node, NULL if an error happened.
+ */
+static XML_Node* endXMLParser(XML_Parser* p)
+{
+   XML_Node *root, *current;
+
+   /* leave namespaces as they were */
+   while(p->namespaces->depth > p->depth) {
+      closeXMLNamespaceScope(p->namespaces);
+   }
+   if(p->skipper != NULL) {
+      destroyXMLProjection(p->skipper);
+      p->skipper = NULL;
    }
 
-   if(root != current) {
+   root = p->root;
+   current = p->current;
+   p->root = p->current = p->kept = NULL;
+   if(root == NULL) {
+      return NULL;
+   }
+   else if(p->error) {
+      destroyXMLNode(root);
+      return NULL;
+   }
+   else if(!p->endOfParsing) {
+      logError("Parsing ended before root node was closed", __FILE__, __LINE__);
+      destroyXMLNode(root);
+      return NULL;
+   }
+   else if(root != current) {
       logError("Last closed node isn't root node", __FILE__, __LINE__);
       destroyXMLNode(root);
       return NULL;
@@ -251,20 +594,720 @@ XML_Node* parseXMLFile(FILE* file)
 }
 
 
+/**
+ * \brief Parse an element and its descendants.
+ * File is read from its current position, until the element is closed.
+ * Nodes get their offsets and lengths, as with XML_PARSE_OFFSETS.
+ *
+ * \param file        Read file.
+ * \param namespaces  Namespaces bound by element's ancestors, if any.
+ * \param pool        Pool sharing nodes' contents, NULL to not share them.
+ * \param projection  Kept elements, NULL to keep them all.
+ * \param filter      Attributes decoded while parsing, NULL to decode them all.
+ * \param limits      Parsing's limits, NULL for none. Parsing stopped after
+ *                    maxRecords records still gives a well formed tree.
+ * \return            Element's node, NULL if an error happened.
+ */
+XML_Node* parseXMLElement(FILE* file, XML_NamespaceStack* namespaces,
+                          XML_Pool* pool, XML_Projection* projection,
+                          XML_AttributeFilter* filter, XML_ParseLimits* limits)
+{
+   XML_Parser p;
+
+   memset(&p, 0, sizeof(p));
+   p.file = file;
+   p.namespaces = namespaces;
+   p.pool = pool;
+   p.projection = projection;
+   p.filter = filter;
+   p.limits = limits;
+   p.offsets = 1;
+
+   if(beginXMLParser(&p)) {
+      while((p.endOfParsing == 0) && (p.error == 0)) {
+         stepXMLParser(&p);
+      }
+   }
+
+   return endXMLParser(&p);
+}
+
+
 XML_File* loadXMLFile(const char* path){
+   return loadXMLFileWithOptions(path, NULL);
+}
+
+
+/**
+ * \brief Load a XML file with parsing options.
+ *
+ * \param[in] path     Path of the XML file.
+ * \param[in] options  Parsing options, NULL for default ones.
+ * \return             Loaded file, whose root is NULL if it can't be parsed.
+ */
+XML_File* loadXMLFileWithOptions(const char* path, const XML_ParseOptions* options)
+{
+   XML_Parser* p;
+
+   if((p = startXMLParsing(path, options)) == NULL) {
+      return NULL;
+   }
+   while(continueXMLParsing(p, 0, 0) == XML_PARSE_AGAIN);
+
+   return finishXMLParsing(p);
+}
+
+
+/**
+ * \brief Create a parser for a whole file, with the options the file keeps.
+ * File is opened and its first line checked.
+ *
+ * \return  Created parser, NULL if memory can't be allocated.
+ */
+static XML_Parser* createXMLFileParser(XML_File* xml)
+{
+   XML_Parser* p;
+
+   if((p = calloc(1, sizeof(XML_Parser))) == NULL) {
+      logError("Can't allocate memory for XML_Parser", __FILE__, __LINE__);
+      return NULL;
+   }
+   logMem(LOG_ALLOC, p, "XML_Parser", "parser", __FILE__, __LINE__);
+   p->xml = xml;
+   p->projection = xml->projection;
+   p->filter = xml->filter;
+   p->fileLimits.maxRecords = xml->limits.maxRecords;
+   p->fileLimits.sampleEvery = xml->limits.sampleEvery;
+   p->fileLimits.maxDepth = xml->limits.maxDepth;
+   p->limits = &p->fileLimits;
+   p->recover = (xml->flags & XML_PARSE_RECOVER) != 0;
+   p->offsets = (xml->flags & XML_PARSE_OFFSETS) != 0;
+   p->error = 1;
+
+   openXMLFile(xml);
+   checkFirstLineXMLFile(xml);
+   clearXMLError();
+
+   return p;
+}
+
+
+/**
+ * \brief Read a whole file's root tag, once its parser is set up.
+ */
+static void beginXMLFileParser(XML_Parser* p)
+{
+   if((p->xml->file != NULL) &&
+      ((p->namespaces = createXMLNamespaceStack()) != NULL)) {
+      p->file = p->xml->file;
+      p->pool = p->xml->pool;
+      p->error = 0;
+      beginXMLParser(p);
+      p->xml->root = p->root;
+   }
+}
+
+
+/**
+ * \brief Start a resumable parsing of a XML file.
+ * Only the root's tag is read, continueXMLParsing() reading the rest.
+ * Options building the tree are kept in the file, for parseXMLFileAgain().
+ *
+ * \param[in] path     Path of the XML file.
+ * \param[in] options  Parsing options, NULL for default ones.
+ * \return             Created parser, NULL if an error happened.
+ */
+XML_Parser* startXMLParsing(const char* path, const XML_ParseOptions* options)
+{
+   XML_Parser* p;
    XML_File* xml;
+   long offset;
+   int ready;
 
-   if((xml = createXMLFile()) != NULL){
-      setXMLFilePath(path, xml);
-      openXMLFile(xml);
-      checkFirstLineXMLFile(xml);
-      xml->root = parseXMLFile(xml->file);
+   if((xml = createXMLFile()) == NULL) {
+      return NULL;
+   }
+   setXMLFilePath(path, xml);
+   ready = 1;
+   if(options != NULL) {
+      xml->flags = options->flags;
+      xml->limits.maxRecords = options->maxRecords;
+      xml->limits.sampleEvery = options->sampleEvery;
+      xml->limits.maxDepth = options->maxDepth;
+      if(options->flags & XML_PARSE_SHARED) {
+         xml->pool = createXMLPool();
+      }
+      if((options->keepCount > 0) &&
+         ((xml->projection = createXMLProjection(options->keep,
+                                                 options->keepCount)) == NULL)) {
+         ready = 0;
+      }
+      else if(((options->flags & XML_PARSE_LAZY_ATTRIBUTES) || (options->attributeCount > 0)) &&
+              ((xml->filter = createXMLAttributeFilter(options->attributes,
+                                                       options->attributeCount,
+                                                       (options->flags & XML_PARSE_LAZY_ATTRIBUTES) != 0)) ==
+               NULL)) {
+         ready = 0;
+      }
+   }
+   if((p = createXMLFileParser(xml)) == NULL) {
+      destroyXMLFile(xml);
+      return NULL;
+   }
+   if(!ready) {
+      return p;
    }
+   if(options != NULL) {
+      p->progress = options->progress;
+      p->progressData = options->progressData;
+      p->cancel = options->cancel;
+      p->progressEvery = (options->progressEvery > 0) ? options->progressEvery :
+                         XML_PROGRESS_EVERY;
+      p->untilProgress = p->progressEvery;
+   }
+   /* file's size, as progress' total */
+   if((p->progress != NULL) && (xml->file != NULL)) {
+      offset = ftell(xml->file);
+      if((offset < 0) || (fseek(xml->file, 0, SEEK_END) != 0) ||
+         ((p->total = ftell(xml->file)) < 0) ||
+         (fseek(xml->file, offset, SEEK_SET) != 0)) {
+         logError("Can't get size of parsed file", __FILE__, __LINE__);
+         return p;
+      }
+   }
+   beginXMLFileParser(p);
+
+   return p;
+}
+
+
+/**
+ * \brief Close open elements with a closing tag, while resyncing.
+ * Tag closes the innermost open element with its name and those it holds,
+ * or only the innermost one if none has its name.
+ *
+ * \return  Number of elements left open, -1 if tag closes the root.
+ */
+static int closeXMLResyncElement(const int* open, int count, int id, int root)
+{
+   int i;
+
+   for(i = count - 1; (i >= 0) && (open[i] != id); i--);
+   if(i >= 0) {
+      return i;
+   }
+
+   return (id == root) ? -1 : (count > 0) ? count - 1 : 0;
+}
+
+
+/**
+ * \brief Read up to the start tag of a record, or the root's closing tag.
+ * Records are found by structure: elements left open at the error point are
+ * followed, and the next start tag at records' depth is a record whatever
+ * its name. A closing tag closes the innermost open element of its name, and
+ * those it holds, a closing tag matching none being ignored. File is read
+ * again from the tag's '<'.
+ *
+ * \param      root      Root's name identifier.
+ * \param      open      Names of the elements open under the root, outermost
+ *                       first, grown as elements are opened.
+ * \param      count     Number of open elements.
+ * \param[out] capacity  Allocated names in open.
+ * \return               1 before a record, 2 before root's closing tag, 0 at
+ *                       EOF or if an error happened.
+ */
+static int resyncXMLParser(FILE* file, int root, int** open, int count, int* capacity)
+{
+   char name[XML_BUFFER_LENGTH];
+   size_t length;
+   int c, closing, previous, quote, id, *grown;
+
+   while((c = getc(file)) != EOF) {
+      if(c != '<') {
+         continue;
+      }
+      c = getc(file);
+      closing = (c == '/');
+      if(closing) {
+         c = getc(file);
+      }
+      for(length = 0; (c != EOF) && (c != '<') && (c != '>') && (c != '/') && (c != ' ') &&
+                      (c != '\t') && (c != '\n') && (c != '\r'); length++) {
+         if(length + 1 < XML_BUFFER_LENGTH) {
+            name[length] = c;
+         }
+         c = getc(file);
+      }
+      if((c == EOF) || (length + 1 >= XML_BUFFER_LENGTH)) {
+         continue;
+      }
+      name[length] = '\0';
+
+      /* '<' ending a name starts the next tag */
+      if(c == '<') {
+         ungetc(c, file);
+         continue;
+      }
+      /* declarations, comments and processing instructions */
+      if((length > 0) && ((name[0] == '!') || (name[0] == '?'))) {
+         while((c != EOF) && (c != '>')) {
+            c = getc(file);
+         }
+         continue;
+      }
+
+      /* root's closing tag, elements left open being closed with it */
+      if(closing) {
+         id = findXMLName(name, length);
+         if((count = closeXMLResyncElement(*open, count, id, root)) < 0) {
+            fseek(file, -(long)(length + 3), SEEK_CUR);
+            return 2;
+         }
+         continue;
+      }
+      /* record's start tag, at root's children depth */
+      if(count == 0) {
+         fseek(file, -(long)(length + 2), SEEK_CUR);
+         return 1;
+      }
+
+      /* reads up to tag's '>', an empty element tag ending with "/>" */
+      previous = quote = 0;
+      while((c != EOF) && ((c != '>') || quote)) {
+         if(quote) {
+            if(c == quote) {
+               quote = 0;
+            }
+         }
+         else if((c == '"') || (c == '\'')) {
+            quote = c;
+         }
+         previous = c;
+         c = getc(file);
+      }
+      if(previous == '/') {
+         continue;
+      }
+
+      if(count == *capacity) {
+         if((grown = realloc(*open, 2 * *capacity * sizeof(int))) == NULL) {
+            logError("Can't reallocate memory for resync's elements", __FILE__, __LINE__);
+            return 0;
+         }
+         *open = grown;
+         *capacity *= 2;
+      }
+      if(((*open)[count++] = internXMLName(name, length)) == XML_NO_NAME) {
+         return 0;
+      }
+   }
+
+   return 0;
+}
+
+
+/**
+ * \brief Recover from a parsing error, dropping the record where it was found.
+ * Error's offset is recorded in parsed file. When no other record follows,
+ * the tree ends with the previous one.
+ *
+ * \return  1 if parsing goes on, 0 if error can't be recovered from.
+ */
+static int recoverXMLParser(XML_Parser* p)
+{
+   const XML_Error* last;
+   XML_Error* errors;
+   XML_Node* record;
+   const char* name;
+   int *open, capacity, count, found, i;
+
+   if(p->root == NULL) {
+      return 0;
+   }
+
+   /* error is recorded where it was found */
+   if(p->xml->errorCount >= p->errorCapacity) {
+      capacity = (p->errorCapacity > 0) ? 2 * p->errorCapacity : 16;
+      if((errors = realloc(p->xml->errors, capacity * sizeof(XML_Error))) == NULL) {
+         logError("Can't reallocate memory for recovered errors", __FILE__, __LINE__);
+         return 0;
+      }
+      p->xml->errors = errors;
+      p->errorCapacity = capacity;
+   }
+   last = getXMLError();
+   if(last->offset >= 0) {
+      p->xml->errors[p->xml->errorCount] = *last;
+   }
+   else {
+      p->xml->errors[p->xml->errorCount].message = "Parsing error";
+      p->xml->errors[p->xml->errorCount].offset = p->offset;
+      p->xml->errors[p->xml->errorCount].line = 0;
+      p->xml->errors[p->xml->errorCount].column = 0;
+   }
+   p->xml->errorCount++;
+   clearXMLError();
+
+   /* elements open under the root: current node's ancestors, then elements
+      being skipped */
+   count = p->level - 1 + ((p->skipping != NULL) ? p->skipping->depth : 0);
+   capacity = (count > 16) ? count : 16;
+   if((open = malloc(capacity * sizeof(int))) == NULL) {
+      logError("Can't allocate memory for resync's elements", __FILE__, __LINE__);
+      return 0;
+   }
+   for(i = p->level - 2, record = p->current; i >= 0; i--, record = record->parent) {
+      open[i] = record->id;
+   }
+   for(i = p->level - 1; i < count; i++) {
+      name = getXMLProjectionPending(p->skipping, i - (p->level - 1));
+      open[i] = internXMLName(name, strlen(name));
+   }
+   /* closing tag in error is taken as closing open elements, as while
+      resyncing, the root's one ending the tree */
+   if(p->unmatched != XML_NO_NAME) {
+      count = closeXMLResyncElement(open, count, p->unmatched, p->root->id);
+   }
+   found = (count >= 0) && resyncXMLParser(p->file, p->root->id, &open, count, &capacity);
+   free(open);
+
+   /* innermost root's child holding current node */
+   for(record = p->current; (record != p->root) && (record->parent != p->root);
+       record = record->parent);
+
+   /* bad record is dropped, parsing goes on from the root */
+   while(p->namespaces->depth > p->depth + 1) {
+      closeXMLNamespaceScope(p->namespaces);
+   }
+   if(record != p->root) {
+      destroyXMLNode(record);
+      if(p->limits != NULL) {
+         p->limits->kept--;
+      }
+   }
+   if(p->kept != p->root) {
+      p->kept = NULL;
+   }
+   p->current = p->root;
+   p->skipping = NULL;
+   p->unmatched = XML_NO_NAME;
+   p->level = 1;
+   p->error = 0;
+   p->offset = ftell(p->file);
+   p->last = p->recordEnd;
+   if(!found) {
+      p->endOfParsing = 1;
+      setXMLNodeLength(p->root, -1);
+      shareXMLParserNode(p, p->root);
+   }
+
+   return 1;
+}
+
+
+/**
+ * \brief Report parsing's progress, and check if it was canceled.
+ * Called every progressEvery tags only, so reading tags isn't slowed down.
+ *
+ * \return  1 if parsing goes on, 0 if it was canceled.
+ */
+static int checkXMLParserProgress(XML_Parser* p)
+{
+   p->untilProgress = p->progressEvery;
+   if(((p->cancel != NULL) && atomic_load(p->cancel)) ||
+      ((p->progress != NULL) &&
+       p->progress(p->endOfParsing ? p->total : p->offset, p->total,
+                   p->progressData))) {
+      p->canceled = p->error = 1;
+      return 0;
+   }
+
+   return 1;
+}
+
+
+/**
+ * \brief Continue a resumable parsing, within a budget.
+ * The budget is checked between tags, so a call may go past it by one node's
+ * value or tag. Nodes read so far can be looked up from the file's root.
+ *
+ * \param p             Parser.
+ * \param bytes         Bytes read before returning, 0 for no limit.
+ * \param microseconds  Time spent before returning, 0 for no limit.
+ * \return              XML_PARSE_AGAIN if the budget ran out, XML_PARSE_DONE
+ *                      once the root is closed, XML_PARSE_CANCELED if it was
+ *                      canceled, XML_PARSE_ERROR otherwise.
+ */
+XML_ParseResult continueXMLParsing(XML_Parser* p, long bytes, long microseconds)
+{
+   struct timespec start, now;
+   long offset;
+
+   if(p == NULL) {
+      logError("Trying to continue a NULL XML_Parser", __FILE__, __LINE__);
+      return XML_PARSE_ERROR;
+   }
+
+   if(p->canceled) {
+      return XML_PARSE_CANCELED;
+   }
+   else if(p->error || p->endOfParsing) {
+      return p->error ? XML_PARSE_ERROR : XML_PARSE_DONE;
+   }
+
+   offset = p->offset;
+   p->until = (bytes > 0) ? offset + bytes : 0;
+   if(microseconds > 0) {
+      clock_gettime(CLOCK_MONOTONIC, &start);
+   }
+   while((p->endOfParsing == 0) && (p->error == 0)) {
+      stepXMLParser(p);
+      if(p->error && p->recover) {
+         recoverXMLParser(p);
+      }
+      if(((p->progress != NULL) || (p->cancel != NULL)) && (p->error == 0) &&
+         ((--p->untilProgress <= 0) || p->endOfParsing) && !checkXMLParserProgress(p)) {
+         break;
+      }
+      if((bytes > 0) && (p->offset - offset >= bytes)) {
+         break;
+      }
+      if(microseconds > 0) {
+         clock_gettime(CLOCK_MONOTONIC, &now);
+         if((now.tv_sec - start.tv_sec) * 1000000L +
+            (now.tv_nsec - start.tv_nsec) / 1000 >= microseconds) {
+            break;
+         }
+      }
+   }
+
+   if(p->canceled) {
+      return XML_PARSE_CANCELED;
+   }
+   else if(p->error) {
+      return XML_PARSE_ERROR;
+   }
+   return p->endOfParsing ? XML_PARSE_DONE : XML_PARSE_AGAIN;
+}
+
+
+/**
+ * \brief Finish a resumable parsing, and destroy its parser.
+ * An unfinished parsing is abandoned, its partial tree being destroyed.
+ *
+ * \param p  Destroyed parser.
+ * \return   Loaded file, whose root is NULL if it can't be parsed.
+ */
+XML_File* finishXMLParsing(XML_Parser* p)
+{
+   XML_File* xml;
+
+   if(p == NULL) {
+      logError("Trying to finish a NULL XML_Parser", __FILE__, __LINE__);
+      return NULL;
+   }
+
+   xml = p->xml;
+   if(p->namespaces != NULL) {
+      xml->root = endXMLParser(p);
+      destroyXMLNamespaceStack(p->namespaces);
+   }
+   /* rest of the file won't be read */
+   if(p->fileLimits.stopped) {
+      closeXMLFile(xml);
+   }
+   xml->status = p->canceled ? XML_STATUS_CANCELED :
+                 (xml->root == NULL) ? XML_STATUS_FAILED :
+                 p->fileLimits.stopped ? XML_STATUS_LIMITED :
+                 (xml->errorCount > 0) ? XML_STATUS_RECOVERED : XML_STATUS_COMPLETE;
+   logMem(LOG_FREE, p, "XML_Parser", "parser", __FILE__, __LINE__);
+   free(p);
 
    return xml;
 }
 
 
+/**
+ * \brief Parse a whole file again, with the options it was loaded with.
+ * Projection, attributes filter, limits and recovery apply as they did when
+ * loading. The new tree, errors and status replace the current ones only if
+ * parsing succeeds, the current tree being kept otherwise. A flattened file
+ * is flattened again.
+ *
+ * \param xml  Parsed file, loaded from a path.
+ * \return     1 on success, 0 if the file can't be parsed.
+ */
+int parseXMLFileAgain(XML_File* xml)
+{
+   XML_File* again;
+   XML_Parser* p;
+   XML_Node* root;
+   XML_Error* errors;
+   int errorCount, success;
+
+   if((xml == NULL) || (xml->path == NULL)) {
+      logError("Trying to parse again a XML_File without path", __FILE__, __LINE__);
+      return 0;
+   }
+   if(xml->file != NULL) {
+      closeXMLFile(xml);
+   }
+
+   /* parsed into a file borrowing path, pool and options */
+   if((again = createXMLFile()) == NULL) {
+      return 0;
+   }
+   setXMLFilePath(xml->path, again);
+   again->pool = xml->pool;
+   again->projection = xml->projection;
+   again->filter = xml->filter;
+   again->limits = xml->limits;
+   again->flags = xml->flags;
+   if((p = createXMLFileParser(again)) != NULL) {
+      beginXMLFileParser(p);
+      while(continueXMLParsing(p, 0, 0) == XML_PARSE_AGAIN);
+      finishXMLParsing(p);
+   }
+
+   /* new tree replaces current one, which is destroyed with the other file */
+   success = (again->root != NULL);
+   if(success) {
+      root = xml->root;
+      xml->root = again->root;
+      again->root = root;
+      errors = xml->errors;
+      xml->errors = again->errors;
+      again->errors = errors;
+      errorCount = xml->errorCount;
+      xml->errorCount = again->errorCount;
+      again->errorCount = errorCount;
+      xml->status = again->status;
+      if(xml->flat != NULL) {
+         flattenXMLFile(xml, xml->flat->flags);
+      }
+   }
+   again->pool = NULL;
+   again->projection = NULL;
+   again->filter = NULL;
+   destroyXMLFile(again);
+
+   return success;
+}
+
+
+/**
+ * \brief Compute line and column of a file's recovered errors.
+ * File is read again from its path, up to the last error.
+ *
+ * \param xml  Parsed XML_File.
+ * \return     1 on success, 0 if an error happened.
+ */
+int locateXMLParseErrors(XML_File* xml)
+{
+   FILE* file;
+   int located;
+
+   if((xml == NULL) || (xml->path == NULL)) {
+      logError("Trying to locate errors of a NULL XML_File or path", __FILE__, __LINE__);
+      return 0;
+   }
+   if(xml->errorCount == 0) {
+      return 1;
+   }
+   if((file = fopen(xml->path, "r")) == NULL) {
+      logError("Can't open XML file to locate errors", __FILE__, __LINE__);
+      return 0;
+   }
+   located = locateXMLErrors(file, xml->errors, xml->errorCount);
+   fclose(file);
+
+   return located;
+}
+
+
+/**
+ * \brief Build children arrays or sorted children of a node and its
+ * descendants, or decode their attributes.
+ */
+static void indexXMLTreeChildren(XML_Node* n, int flags)
+{
+   XML_Node* child;
+   int i;
+
+   if(flags & XML_FLAT_CHILDREN) {
+      indexXMLNodeChildren(n);
+   }
+   if(flags & XML_FLAT_SORTED) {
+      sortXMLNodeChildren(n);
+   }
+   if(flags & XML_FLAT_ATTRIBUTES) {
+      decodeXMLNodeAttributes(n);
+   }
+   for(i = 0, child = n->first; child != NULL; child = getXMLNextChild(n, child, i++)) {
+      indexXMLTreeChildren(child, flags);
+   }
+}
+
+
+/**
+ * \brief Flatten a XML file's tree for faster reading.
+ * Every value gets indexed by its full path, so getXMLValue() and the typed
+ * getters only do one hash probe. The tree mustn't be modified afterwards,
+ * unless it is flattened again.
+ *
+ * \param xml    Flattened XML file.
+ * \param flags  XML_FLAT_TYPED to also convert values to int, double and
+ *               boolean, XML_FLAT_PERFECT to use a minimal perfect hash,
+ *               XML_FLAT_CHILDREN to also index every node's children,
+ *               XML_FLAT_SORTED to also sort them by name,
+ *               XML_FLAT_ATTRIBUTES to also decode every node's attributes.
+ */
+void flattenXMLFile(XML_File* xml, int flags)
+{
+   if(xml == NULL) {
+      logError("Trying to flatten a NULL XML_File", __FILE__, __LINE__);
+   }
+   else if(xml->root == NULL) {
+      logError("Trying to flatten a XML_File without tree", __FILE__, __LINE__);
+   }
+   else {
+      unflattenXMLFile(xml);
+      xml->flat = createXMLFlat(xml->root, flags);
+      if(flags & (XML_FLAT_CHILDREN | XML_FLAT_SORTED | XML_FLAT_ATTRIBUTES)) {
+         indexXMLTreeChildren(xml->root, flags);
+      }
+   }
+}
+
+
+/**
+ * \brief Remove a XML file's flattened tree.
+ * Values are read by walking the tree again.
+ *
+ * \param xml  Modified XML file.
+ */
+void unflattenXMLFile(XML_File* xml)
+{
+   if(xml == NULL) {
+      logError("Trying to unflatten a NULL XML_File", __FILE__, __LINE__);
+   }
+   else if(xml->flat != NULL) {
+      destroyXMLFlat(xml->flat);
+      xml->flat = NULL;
+   }
+}
+
+
+/**
+ * \brief Check if a XML file is flattened with pre-converted values.
+ */
+static int isXMLFileTyped(XML_File* xml)
+{
+   return (xml != NULL) && (xml->flat != NULL) && (xml->flat->flags & XML_FLAT_TYPED);
+}
+
+
 /**
  * \brief Reads a value in a XML file.
  *
@@ -274,19 +1317,53 @@ XML_File* loadXMLFile(const char* path){
  * \param[in] xml   Searched XML file.
  */
 char* getXMLValue(char* path, XML_File* xml){
+   XML_FlatEntry* entry;
+   char* value;
+
+   if((path == NULL) || (xml == NULL)){
+      return NULL;
+   }
+
+   /* flattened tree, one probe with the whole path */
+   if(xml->flat != NULL){
+      entry = findXMLFlatEntry(path, xml->flat);
+      value = (entry == NULL) ? NULL : entry->value;
+   }
+   else{
+      value = findXMLValue(path, xml->root);
+   }
+
+   if(value == NULL){
+      logError("Didn't find a value with this path", __FILE__, __LINE__);
+   }
+
+   return value;
+}
+
+/**
+ * \brief Reads a value in a XML tree.
+ * Same as getXMLValue(), but a missing value isn't an error, for callers
+ * expecting some values to be missing.
+ *
+ * \param[in] path  Values path in the tree, see getXMLValue().
+ * \param[in] root  Tree's root.
+ * \return          Found value, NULL if there is no such value.
+ */
+char* findXMLValue(char* path, XML_Node* root){
    char strBuffer[XML_BUFFER_LENGTH];
    char charBuffer;
    char* value;
-   XML_Node* n;
+   XML_Node *n, *parent, **named;
    XML_Attribute* attr;
-   int iPath, iBuf;
+   int iPath, iBuf, count, i;
 
-   if((path == NULL) || (xml == NULL)){
+   if((path == NULL) || (root == NULL)){
       return NULL;
    }
 
    value = NULL;
-   n = xml->root;
+   n = root;
+   parent = NULL;
    attr = NULL;
    iPath = 0;
 
@@ -312,22 +1389,27 @@ char* getXMLValue(char* path, XML_File* xml){
          return NULL;
       }
 
-      /* find child with this name */
+      /* find child with this name, by binary search if children are sorted */
+      if((parent != NULL) && (getXMLSortedChildren(parent) != NULL)){
+         named = getXMLChildrenByName(parent, strBuffer, &count);
+         n = (count > 0) ? named[0] : NULL;
+      }
+      i = 0;
       while((n != NULL) && (strcmp(strBuffer, n->name) != 0)){
-         n = n->next;
+         n = (parent == NULL) ? n->next : getXMLNextChild(parent, n, i++);
       }
       if(n == NULL){
-         logError("Didn't find a child with this name", __FILE__, __LINE__);
          return NULL;
       }
 
       /* found node character '/', checks child */
       if(charBuffer == '/'){
+         parent = n;
          n = n->first;
       }
-      /* found value character '$', reads value */
+      /* found value character '$', reads value, that may be NULL */
       else if(charBuffer == '$'){
-         value = n->value;
+         return n->value;
       }
       /* found attribute character ':', reads attribute */
       else if(charBuffer == ':'){
@@ -342,12 +1424,7 @@ char* getXMLValue(char* path, XML_File* xml){
          strBuffer[iBuf] = '\0';
 
          /* searches attribute */
-         attr = n->attr;
-         while((attr != NULL) && (strcmp(strBuffer, attr->name) != 0)){
-            attr = attr->next;
-         }
-         if(attr == NULL){
-            logError("Didn't find an attribute with this name", __FILE__, __LINE__);
+         if((attr = getXMLNodeAttribute(n, strBuffer)) == NULL){
             return NULL;
          }
          else{
@@ -360,22 +1437,22 @@ char* getXMLValue(char* path, XML_File* xml){
 }
 
 /**
- * \brief Finds a particular node in a XML tree.
+ * \brief Finds a node among siblings, then its descendants along path.
  *
- * \param[in] path  Node path in the tree.
- *                  eg. "foo/bar", "foo/bar?attr=value/lel"
- * \param[in] root  Tree's root.
- * \return          A pointer to found node, NULL if such a node wasn't found.
+ * \param[in] path    Node path from siblings.
+ * \param[in] root    First sibling.
+ * \param[in] parent  Siblings' parent, to use its sorted children, or NULL.
+ * \return            A pointer to found node, NULL if such a node wasn't found.
  */
-XML_Node* getXMLNode(char* path, XML_Node* root){
+static XML_Node* findXMLNode(char* path, XML_Node* root, XML_Node* parent){
    char nameBuffer[XML_BUFFER_LENGTH];
    char attrBuffer[XML_BUFFER_LENGTH];
    char valueBuffer[XML_BUFFER_LENGTH];
    int iPath, iNaBuf, iAtBuf, iVaBuf;
    char charBuffer;
-   XML_Node* n;
+   XML_Node *n, **named;
    XML_Attribute* attr;
-   int nodeFound;
+   int nodeFound, count, iNamed;
 
    /* checks parameters */
    if((path == NULL) || (root == NULL)){
@@ -401,10 +1478,10 @@ XML_Node* getXMLNode(char* path, XML_Node* root){
    iPath++;
 
    /* reads attribute's name and value if necessary */
+   iAtBuf = iVaBuf = 0;
    if(charBuffer == '?'){
 
       /* reads attribute's name in path */
-      iAtBuf = iVaBuf = 0;
       do{
          charBuffer = path[iPath];
          attrBuffer[iAtBuf] = charBuffer;
@@ -413,9 +1490,9 @@ XML_Node* getXMLNode(char* path, XML_Node* root){
       }
       while((charBuffer != '=') &&
             (charBuffer != '\0') &&
-            (iNaBuf < XML_BUFFER_LENGTH));
-      attrBuffer[iAtBuf] = '\0';
-      iPath++;
+            (iAtBuf < XML_BUFFER_LENGTH));
+      /* replace read '=' */
+      attrBuffer[iAtBuf - 1] = '\0';
 
       /* checks if attribute's name is followed by a value */
       if(charBuffer != '='){
@@ -434,39 +1511,45 @@ XML_Node* getXMLNode(char* path, XML_Node* root){
          while((charBuffer != '/') &&
                (charBuffer != '\0') &&
                (iVaBuf < XML_BUFFER_LENGTH));
-         valueBuffer[iVaBuf] = '\0';
-         iPath++;
+         /* replace read '/' or '\0' */
+         valueBuffer[iVaBuf - 1] = '\0';
       }
    }
 
+   /* candidates are children with this name if they are sorted, else all */
+   named = NULL;
+   count = iNamed = 0;
+   if((parent != NULL) && (getXMLSortedChildren(parent) != NULL)){
+      named = getXMLChildrenByName(parent, nameBuffer, &count);
+      n = (count > 0) ? named[0] : NULL;
+   }
+
    /* finds a matching node */
    nodeFound = 0;
-   do{
+   while((!nodeFound) && (n != NULL)){
       /* checks node's name */
-      if(strcmp(nameBuffer, n->name) != 0){
-         n = n->next;
-      }
-      /* found a node with this name, and no need to check attribute */
-      else if(!iAtBuf){
-         nodeFound = 1;
+      if(strcmp(nameBuffer, n->name) == 0){
+         /* found a node with this name, and no need to check attribute */
+         if(!iAtBuf){
+            nodeFound = 1;
+         }
+         /* also checks attribute's name and value */
+         else if(((attr = getXMLNodeAttribute(n, attrBuffer)) != NULL) &&
+                 (strcmp(attr->value, valueBuffer) == 0)){
+            nodeFound = 1;
+         }
       }
-      /* also checks attribute's name and value */
-      else{
-         attr = n->attr;
-         while((attr != NULL) && (nodeFound == 0)){
-            if((strcmp(attr->name, attrBuffer) == 0) &&
-               (strcmp(attr->value, valueBuffer) == 0)){
-               nodeFound = 1;
-            }
-            attr = attr->next;
+      /* Didn't found a matching node, select next candidate */
+      if(!nodeFound){
+         if(named == NULL){
+            n = (parent == NULL) ? n->next : getXMLNextChild(parent, n, iNamed++);
          }
-         /* Didn't found a matching attribute, select next node */
-         if(attr == NULL){
-            n = n->next;
+         else{
+            iNamed++;
+            n = (iNamed < count) ? named[iNamed] : NULL;
          }
       }
    }
-   while((!nodeFound) && (n != NULL));
 
    /* Didn't found a matching node, return NULL */
    if(!nodeFound){
@@ -474,7 +1557,7 @@ XML_Node* getXMLNode(char* path, XML_Node* root){
    }
    /* found node character '/', checks children */
    else if(charBuffer == '/'){
-      n = getXMLNode(path + iPath, n->first);
+      n = findXMLNode(path + iPath, n->first, n);
    }
    /* Didn't find end of string character '/0', return NULL  */
    else if(charBuffer != '\0'){
@@ -484,6 +1567,19 @@ XML_Node* getXMLNode(char* path, XML_Node* root){
    return n;
 }
 
+
+/**
+ * \brief Finds a particular node in a XML tree.
+ *
+ * \param[in] path  Node path in the tree.
+ *                  eg. "foo/bar", "foo/bar?attr=value/lel"
+ * \param[in] root  Tree's root.
+ * \return          A pointer to found node, NULL if such a node wasn't found.
+ */
+XML_Node* getXMLNode(char* path, XML_Node* root){
+   return findXMLNode(path, root, NULL);
+}
+
 char* getXMLString(char* path, XML_File* xml, char* defaultValue){
    char* value;
 
@@ -495,10 +1591,15 @@ char* getXMLString(char* path, XML_File* xml, char* defaultValue){
 }
 
 int getXMLInt(char* path, XML_File* xml, int defaultValue){
+   XML_FlatEntry* entry;
    char* temp;
    int value;
 
-   if((temp = getXMLValue(path, xml)) == NULL){
+   if(isXMLFileTyped(xml)){
+      entry = findXMLFlatEntry(path, xml->flat);
+      value = (entry == NULL) ? defaultValue : entry->intValue;
+   }
+   else if((temp = getXMLValue(path, xml)) == NULL){
       value = defaultValue;
    }
    else{
@@ -509,10 +1610,16 @@ int getXMLInt(char* path, XML_File* xml, int defaultValue){
 }
 
 int getXMLBool(char* path, XML_File* xml, int defaultValue){
+   XML_FlatEntry* entry;
    char* temp;
    int value;
 
-   if((temp = getXMLValue(path, xml)) == NULL){
+   if(isXMLFileTyped(xml)){
+      entry = findXMLFlatEntry(path, xml->flat);
+      value = ((entry == NULL) || (entry->boolValue < 0)) ?
+              defaultValue : entry->boolValue;
+   }
+   else if((temp = getXMLValue(path, xml)) == NULL){
       value = defaultValue;
    }
    else{
@@ -531,10 +1638,15 @@ int getXMLBool(char* path, XML_File* xml, int defaultValue){
 }
 
 double getXMLDouble(char* path, XML_File* xml, double defaultValue){
+   XML_FlatEntry* entry;
    char* temp;
    double value;
 
-   if((temp = getXMLValue(path, xml)) == NULL){
+   if(isXMLFileTyped(xml)){
+      entry = findXMLFlatEntry(path, xml->flat);
+      value = (entry == NULL) ? defaultValue : entry->doubleValue;
+   }
+   else if((temp = getXMLValue(path, xml)) == NULL){
       value = defaultValue;
    }
    else{
@@ -543,3 +1655,195 @@ double getXMLDouble(char* path, XML_File* xml, double defaultValue){
 
    return value;
 }
+
+
+/**
+ * \brief Clone a subtree in a pool.
+ * Clone borrows source's contents, then exchanges them for pooled copies.
+ *
+ * \return  Clone, NULL if an error happened.
+ */
+static XML_Node* cloneXMLNodeInPool(XML_Node* n, XML_Pool* pool)
+{
+   XML_Node *clone, *child, *childClone;
+   XML_NodeData* data;
+   int i;
+
+   decodeXMLNodeAttributes(n);
+   clone = createXMLNode();
+   clone->name = n->name;
+   clone->id = n->id;
+   clone->value = n->value;
+   clone->attr = n->attr;
+   setXMLNodeShared(clone, 1);
+   if(!shareXMLNode(clone, pool)) {
+      clone->name = clone->value = NULL;
+      clone->attr = NULL;
+      destroyXMLNode(clone);
+      return NULL;
+   }
+   setXMLNodeNamespace(clone, getXMLNodeNamespace(n), getXMLNodeLocalName(n));
+
+   for(i = 0, child = n->first; child != NULL; child = getXMLNextChild(n, child, i++)) {
+      if((childClone = cloneXMLNodeInPool(child, pool)) == NULL) {
+         destroyXMLNode(clone);
+         return NULL;
+      }
+      addXMLNodeToParent(clone, childClone);
+   }
+   if((n->data != NULL) && (n->data->hash != 0) && ((data = getXMLNodeData(clone)) != NULL)) {
+      data->hash = n->data->hash;
+   }
+
+   return clone;
+}
+
+
+/**
+ * \brief Clone a subtree for a file.
+ * Clone's names, values and attributes are stored in destination's pool,
+ * which is created if needed, so cloning allocates nodes only, and identical
+ * contents are stored once however many times a fragment is cloned. Clone
+ * must be added to \p dst's tree, or destroyed before \p dst.
+ *
+ * \param n    Cloned subtree, from any file.
+ * \param dst  File the clone is made for.
+ * \return     Clone, without parent, NULL if an error happened.
+ */
+XML_Node* cloneXMLNode(XML_Node* n, XML_File* dst)
+{
+   if((n == NULL) || (dst == NULL)) {
+      logError("Trying to clone a NULL node, or for a NULL XML_File",
+               __FILE__, __LINE__);
+      return NULL;
+   }
+   if((dst->pool == NULL) && ((dst->pool = createXMLPool()) == NULL)) {
+      return NULL;
+   }
+
+   return cloneXMLNodeInPool(n, dst->pool);
+}
+
+
+/**
+ * \brief Prepare a moved subtree for its destination file.
+ * Contents of source's pool are pooled in destination's one, or copied if it
+ * has none, and byte ranges of source file are forgotten. Pooled subtrees are
+ * cloned the same way, as other parents share them.
+ *
+ * \return  1 on success, 0 if an error happened.
+ */
+static int rehomeXMLNode(XML_Node* n, XML_Pool* src, XML_Pool* dst)
+{
+   XML_Node *child, *copy;
+   int i;
+
+   if(isXMLNodeShared(n) && (src != dst)) {
+      if((dst == NULL) || !shareXMLNode(n, dst)) {
+         unshareXMLNode(n);
+      }
+   }
+   setXMLNodeOffset(n, -1);
+   setXMLNodeLength(n, -1);
+   for(i = 0, child = n->first; child != NULL; child = getXMLNextChild(n, child, i++)) {
+      if(isXMLNodePooled(child)) {
+         copy = (dst != NULL) ? cloneXMLNodeInPool(child, dst) : copyXMLNode(child);
+         if(copy == NULL) {
+            return 0;
+         }
+         replaceXMLNodeChild(n, i, copy);
+         child = copy;
+      }
+      else if(!rehomeXMLNode(child, src, dst)) {
+         return 0;
+      }
+   }
+
+   return 1;
+}
+
+
+/**
+ * \brief Flatten a modified file again, with its previous flags.
+ * Flat entries point into the tree, so they're dropped when the tree is.
+ */
+static void reflattenXMLFile(XML_File* xml)
+{
+   int flags;
+
+   if(xml->flat != NULL) {
+      flags = xml->flat->flags;
+      unflattenXMLFile(xml);
+      if(xml->root != NULL) {
+         flattenXMLFile(xml, flags);
+      }
+   }
+}
+
+
+/**
+ * \brief Move a subtree, within a file or to another one.
+ * Nodes are relinked rather than copied. Only contents shared in source's
+ * pool are pooled again, since that pool is destroyed with its file.
+ * A node can't be moved under itself or one of its descendants, and a pooled
+ * node, which other parents share, can't be moved nor get children. Flattened
+ * files are flattened again.
+ *
+ * \param n       Moved subtree.
+ * \param src     File containing \p n.
+ * \param parent  New parent in \p dst, NULL to make \p n the root of \p dst.
+ * \param dst     Destination file, which can be \p src.
+ * \return        1 on success, 0 if an error happened.
+ */
+int moveXMLNode(XML_Node* n, XML_File* src, XML_Node* parent, XML_File* dst)
+{
+   XML_Node* ancestor;
+
+   if((n == NULL) || (src == NULL) || (dst == NULL)) {
+      logError("Trying to move a NULL node, or between NULL files",
+               __FILE__, __LINE__);
+      return 0;
+   }
+   if((parent == NULL) && (dst->root != NULL) && (dst->root != n)) {
+      logError("Destination file already has a root", __FILE__, __LINE__);
+      return 0;
+   }
+   if(isXMLNodePooled(n) || ((parent != NULL) && isXMLNodePooled(parent))) {
+      logError("Trying to move a pooled node, or under one", __FILE__, __LINE__);
+      return 0;
+   }
+   for(ancestor = parent; ancestor != NULL; ancestor = ancestor->parent) {
+      if(ancestor == n) {
+         logError("Trying to move a node under itself", __FILE__, __LINE__);
+         return 0;
+      }
+   }
+
+   /* source's pool is destroyed with its file */
+   if((src != dst) && !rehomeXMLNode(n, src->pool, dst->pool)) {
+      return 0;
+   }
+
+   /* detach from source */
+   if(n->parent != NULL) {
+      deleteXMLNodeFromParent(n);
+   }
+   else if(src->root == n) {
+      src->root = NULL;
+   }
+
+   /* attach to destination */
+   if(parent != NULL) {
+      addXMLNodeToParent(parent, n);
+   }
+   else {
+      dst->root = n;
+   }
+
+   reflattenXMLFile(src);
+   if(dst != src) {
+      reflattenXMLFile(dst);
+   }
+
+   return 1;
+}
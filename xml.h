@@ -14,6 +14,13 @@
 
 
 #include "node.h"    /* XML_Node member in XML_File structure */
+#include "flat.h"    /* XML_Flat member in XML_File structure */
+#include "namespace.h"  /* XML_NamespaceStack */
+#include "pool.h"    /* XML_Pool member in XML_File structure */
+#include "projection.h" /* XML_Projection */
+#include "error.h"   /* XML_Error member in XML_File structure */
+
+#include <stdatomic.h>  /* atomic_int */
 
 
 /**
@@ -45,6 +52,34 @@
 #define XML_FIRST_LINE  "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
 
 
+/**
+ * \brief Outcome of a XML file's parsing.
+ */
+typedef enum XML_ParseStatus {
+   XML_STATUS_UNPARSED,  /**< File wasn't parsed yet. */
+   XML_STATUS_COMPLETE,  /**< Whole file was parsed. */
+   XML_STATUS_RECOVERED, /**< Whole file was parsed, dropping bad records. */
+   XML_STATUS_LIMITED,   /**< Parsing stopped at a limit, tree is partial. */
+   XML_STATUS_FAILED,    /**< File couldn't be parsed, root is NULL. */
+   XML_STATUS_CANCELED   /**< Parsing was canceled, root is NULL. */
+} XML_ParseStatus;
+
+
+/**
+ * \brief Limits of a parsing, and how far it went.
+ * Records are the root's children. Records left out by sampling and nodes
+ * deeper than maxDepth are skipped as projected out nodes are.
+ */
+typedef struct XML_ParseLimits {
+   long maxRecords;  /**< Records kept before parsing stops, 0 for no limit. */
+   int sampleEvery;  /**< Keep one record out of this many, 0 to keep all. */
+   int maxDepth;     /**< Deepest kept level, root's being 1, 0 for no limit. */
+   long records;     /**< Records read so far. */
+   long kept;        /**< Records kept so far. */
+   int stopped;      /**< 1 if parsing stopped after maxRecords records. */
+} XML_ParseLimits;
+
+
 /**
  * \brief XML file structure
  * Contains informations about a XML file.
@@ -53,14 +88,185 @@ typedef struct XML_File {
    char* path;      /**< Path of the XML file */
    FILE* file;      /**< Pointer to the file */
    XML_Node* root;  /**< Root of the generated tree after parsing */
+   XML_Flat* flat;  /**< Values by full path, NULL if not flattened */
+   unsigned long long* blocks;  /**< Hashes of file's blocks, for reparsing */
+   size_t* blockLengths;        /**< Lengths of file's blocks */
+   size_t blockCount;           /**< Number of hashed blocks */
+   long size;                   /**< File's size when blocks were hashed */
+   XML_Pool* pool;  /**< Contents shared by nodes, NULL if not shared */
+   XML_ParseStatus status;      /**< Outcome of file's loading */
+   XML_Error* errors;           /**< Errors parsing recovered from, located
+                                     by locateXMLParseErrors() */
+   int errorCount;              /**< Number of recovered errors */
+   XML_Projection* projection;  /**< Kept elements given when loading, used
+                                     again when reparsing, NULL for all */
+   XML_AttributeFilter* filter; /**< Attributes decoded when loading, NULL
+                                     for all */
+   XML_ParseLimits limits;      /**< Limits given when loading */
+   int flags;                   /**< XML_PARSE_* flags given when loading */
 } XML_File;
 
 
+/**
+ * \brief Share identical strings, attributes lists and subtrees between nodes.
+ * Each distinct subtree is stored once in file's pool, and parents point to
+ * it from their children arrays, so memory drops severalfold on repetitive
+ * files. Pooled nodes are read-only and have no parent nor siblings: children
+ * are iterated with getXMLNextChild(), and a pooled node is copied by
+ * copyXMLNode() or cloneXMLNode() to be modified. Other nodes can still be
+ * modified, getting their own contents back. Has no effect on subtrees with
+ * XML_PARSE_OFFSETS, as their offsets differ.
+ */
+#define XML_PARSE_SHARED  1
+
+/**
+ * \brief Keep attributes' bytes undecoded until they are looked up.
+ * Attributes listed in XML_ParseOptions are still decoded while parsing.
+ * Has no effect with XML_PARSE_SHARED, as pooling needs decoded attributes.
+ * Looking an attribute up then modifies its node, including through
+ * getXMLValue() and getXMLNode(): such a tree is read by a single thread,
+ * unless it is flattened with XML_FLAT_ATTRIBUTES first.
+ */
+#define XML_PARSE_LAZY_ATTRIBUTES  2
+
+/**
+ * \brief Recover from errors in records, the root's children.
+ * A bad record is dropped, and parsing goes on at the next start tag at
+ * records' depth, whatever its name, elements left open by the error being
+ * followed up to their closing tags. Errors are kept in XML_File, one for
+ * each dropped record.
+ */
+#define XML_PARSE_RECOVER  4
+
+/**
+ * \brief Record each node's offset and length in the file.
+ * reparseXMLFile() then parses only the edited element again, instead of
+ * the whole file. It costs an allocation per node, see XML_NodeData.
+ */
+#define XML_PARSE_OFFSETS  8
+
+
+/**
+ * \brief Default number of tags read between two progress checks.
+ */
+#ifndef XML_PROGRESS_EVERY
+#define XML_PROGRESS_EVERY  4096
+#endif /* XML_PROGRESS_EVERY */
+
+
+/**
+ * \brief Check that closing tags match the node they close, 0 to skip it.
+ * Costs a strcmp() per closing tag, see
+ * bench/closetag.c.
+ */
+#ifndef XML_CHECK_CLOSING_TAGS
+#define XML_CHECK_CLOSING_TAGS  1
+#endif /* XML_CHECK_CLOSING_TAGS */
+
+
+/**
+ * \brief Parsing's progress callback.
+ *
+ * \param bytes  Bytes read so far.
+ * \param total  File's size, as an estimate of the bytes to read.
+ * \param data   Callback's data, given in XML_ParseOptions.
+ * \return       0 to go on, anything else to cancel parsing.
+ */
+typedef int (*XML_ProgressCallback)(long bytes, long total, void* data);
+
+
+/**
+ * \brief Options of a XML file's parsing.
+ */
+typedef struct XML_ParseOptions {
+   int flags;       /**< XML_PARSE_* flags */
+   const char** keep;  /**< Kept paths or names, see XML_Projection. */
+   int keepCount;      /**< Number of kept elements, 0 to keep them all. */
+   const char** attributes;  /**< Attributes decoded while parsing, others being
+                                  dropped unless XML_PARSE_LAZY_ATTRIBUTES. */
+   int attributeCount;       /**< Number of attributes, 0 to decode them all. */
+   long maxRecords;  /**< Records kept before parsing stops, 0 for no limit. */
+   int sampleEvery;  /**< Keep one record out of this many, 0 to keep all. */
+   int maxDepth;     /**< Deepest kept level, root's being 1, 0 for no limit. */
+   XML_ProgressCallback progress;  /**< Called while parsing, NULL for none. */
+   void* progressData;  /**< Given to progress callback. */
+   long progressEvery;  /**< Tags read between two progress checks, 0 for
+                             XML_PROGRESS_EVERY. */
+   atomic_int* cancel;  /**< Parsing is canceled once set, NULL for none.
+                             Checked along with progress. */
+} XML_ParseOptions;
+
+
+/**
+ * \brief Result of a resumable parsing's call.
+ */
+typedef enum XML_ParseResult {
+   XML_PARSE_ERROR,  /**< An error happened, tree is dropped when finished. */
+   XML_PARSE_DONE,   /**< Root is closed, or a limit was reached. */
+   XML_PARSE_AGAIN,  /**< Budget ran out, parsing goes on at next call. */
+   XML_PARSE_CANCELED  /**< Parsing was canceled, tree is dropped. */
+} XML_ParseResult;
+
+
+/**
+ * \brief State of an element's parsing, kept between calls when resumable.
+ * Namespaces belong to the parser when it parses a whole file, from
+ * startXMLParsing() to finishXMLParsing(). Projection and filter belong to
+ * the parsed file, which keeps them to be parsed again.
+ */
+typedef struct XML_Parser {
+   XML_File* xml;       /**< Parsed file, NULL when parsing an element. */
+   FILE* file;          /**< Read file. */
+   XML_NamespaceStack* namespaces;  /**< Namespaces in scope. */
+   XML_Pool* pool;      /**< Pool sharing nodes' contents, NULL if none. */
+   XML_Projection* projection;  /**< Kept elements, NULL to keep them all. */
+   XML_AttributeFilter* filter; /**< Decoded attributes, NULL for all. */
+   XML_ParseLimits* limits;     /**< Parsing's limits, NULL for none. */
+   XML_ParseLimits fileLimits;  /**< Limits of a whole file's parsing. */
+   XML_Projection* skipper;     /**< Empty projection skipping elements. */
+   XML_Projection* skipping;    /**< Projection holding the element being
+                                     skipped, NULL if none. */
+   XML_Node* root;      /**< Parsed element's node. */
+   XML_Node* current;   /**< Innermost open node. */
+   XML_Node* kept;      /**< Outermost open node kept with its subtree. */
+   XML_ProjectionMatch match;  /**< Last projection's match. */
+   XML_ProgressCallback progress;  /**< Progress callback, NULL for none. */
+   void* progressData;  /**< Given to progress callback. */
+   atomic_int* cancel;  /**< Cancel flag, NULL for none. */
+   long progressEvery;  /**< Tags read between two progress checks. */
+   long untilProgress;  /**< Tags left before next progress check. */
+   long total;          /**< File's size, when reporting progress. */
+   long offset;         /**< Offset reached in file, counted from read bytes. */
+   long last;           /**< Offset of current node's last child's end, or of
+                             its opening tag, -1 if unknown. */
+   long recordEnd;      /**< Offset of root's last child's end, or of its
+                             opening tag. */
+   long until;          /**< Offset where the call's bytes budget runs out,
+                             0 for no limit. */
+   int unmatched;       /**< Name of a closing tag in error, not matching
+                             current node, XML_NO_NAME if none. */
+   int canceled;        /**< 1 if parsing was canceled. */
+   int recover;         /**< 1 to recover from errors in records. */
+   int offsets;         /**< 1 to record nodes' offsets and lengths. */
+   int errorCapacity;   /**< Allocated errors in parsed file. */
+   int depth;           /**< Namespaces' depth before parsing. */
+   int level;           /**< Level of current node, root's being 1. */
+   int endOfParsing;    /**< 1 once parsing is over. */
+   int error;           /**< 1 if an error happened. */
+} XML_Parser;
+
+
 XML_File* loadXMLFile(const char* path);
+XML_File* loadXMLFileWithOptions(const char* path, const XML_ParseOptions* options);
 char* getXMLString(char* path, XML_File* xml, char* defaultValue);
 int getXMLInt(char* path, XML_File* xml, int defaultValue);
 int getXMLBool(char* path, XML_File* xml, int defaultValue);
 double getXMLDouble(char* path, XML_File* xml, double defaultValue);
+XML_Parser* startXMLParsing(const char* path, const XML_ParseOptions* options);
+XML_ParseResult continueXMLParsing(XML_Parser* p, long bytes, long microseconds);
+XML_File* finishXMLParsing(XML_Parser* p);
+int locateXMLParseErrors(XML_File* xml);
+int parseXMLFileAgain(XML_File* xml);
 
 
 XML_File* createXMLFile(void);
@@ -71,7 +277,15 @@ void openXMLFile(XML_File* xml);
 void closeXMLFile(XML_File* xml);
 int checkFirstLineXMLFile(XML_File* xml);
 XML_Node* parseXMLFile(FILE* file);
+XML_Node* parseXMLElement(FILE* file, XML_NamespaceStack* namespaces,
+                          XML_Pool* pool, XML_Projection* projection,
+                          XML_AttributeFilter* filter, XML_ParseLimits* limits);
 char* getXMLValue(char* path, XML_File* xml);
+char* findXMLValue(char* path, XML_Node* root);
 XML_Node* getXMLNode(char* path, XML_Node* root);
+void flattenXMLFile(XML_File* xml, int flags);
+void unflattenXMLFile(XML_File* xml);
+XML_Node* cloneXMLNode(XML_Node* n, XML_File* dst);
+int moveXMLNode(XML_Node* n, XML_File* src, XML_Node* parent, XML_File* dst);
 
 #endif /* XML_H_INCLUDED */